@@ -27,11 +27,24 @@
 #include <AudioFilter.hpp>
 #include <ScreenSaver.hpp>
 #include <QMPlay2Extensions.hpp>
+#include <Tracer.hpp>
 
 #include <QCoreApplication>
 
 #include <cmath>
 
+static int findFullScaleFrame(const QByteArray &chunk, int chn)
+{
+    const float *data = (const float *)chunk.constData();
+    const int size = chunk.size() / sizeof(float);
+    for (int i = 0; i < size; ++i)
+    {
+        if (data[i] >= 1.0f)
+            return i / chn;
+    }
+    return -1;
+}
+
 AudioThr::AudioThr(PlayClass &playC, const QStringList &pluginsName) :
     AVThread(playC)
 {
@@ -85,6 +98,9 @@ bool AudioThr::setParams(uchar realChn, uint realSRate, uchar chn, uint sRate, b
     writer->modParam("chn",  (channels = chn ? chn : realChannels));
     writer->modParam("rate", (sample_rate = sRate ? sRate : realSRate));
 
+    Tracer::Span traceSpan("Writer::processParams", "audio");
+    traceSpan.setDetail(writer->name());
+
     bool paramsCorrected = false;
     if (writer->processParams((sRate && chn) ? nullptr : &paramsCorrected)) //nie pozwala na korektę jeżeli są wymuszone parametry
     {
@@ -121,10 +137,16 @@ bool AudioThr::setParams(uchar realChn, uint realSRate, uchar chn, uint sRate, b
 
     return false;
 }
+void AudioThr::resetParams()
+{
+    // Parameters are unknown until the first frame is decoded, it emits "audioParamsUpdate()"
+    realChannels = channels = 0;
+    realSample_rate = sample_rate = 0;
+}
 
 void AudioThr::silence(bool invert, bool fromPause)
 {
-    if (QMPlay2Core.getSettings().getBool("Silence") && (!fromPause || playC.frame_last_pts <= 0.0) && doSilence == -1.0 && isRunning() && (invert || !playC.paused))
+    if (QMPlay2Core.getSettings().getBool("Silence") && (!fromPause || playC.frame_last_pts <= 0.0) && doSilence == -1.0 && sample_rate > 0 && isRunning() && (invert || !playC.paused))
     {
         playC.doSilenceBreak = false;
         allowAudioDrain |= !invert;
@@ -375,6 +397,12 @@ void AudioThr::run()
                         createResampler(false);
                     }
 
+                    // Allows matching the "ToneGenerator impulse" events for latency measurements
+                    const int impulseFrame = Tracer::isEnabled()
+                        ? findFullScaleFrame(decodedChunk, currentChannels())
+                        : -1
+                    ;
+
                     if (!isMuted && (!qFuzzyCompare(vol[0], 1.0f) || !qFuzzyCompare(vol[1], 1.0f)))
                     {
                         const int size = decodedChunk.size() / sizeof(float);
@@ -426,6 +454,13 @@ void AudioThr::run()
                         if (ret >= 0 || !writer->readyWrite())
                             break;
                     } while (!br && !br2);
+
+                    if (Tracer::isEnabled())
+                    {
+                        playC.traceFirstOutput(false);
+                        if (impulseFrame > -1)
+                            Tracer::instant("AudioThr impulse written", QString::number(audio_pts + impulseFrame / static_cast<double>(currentSampleRate()), 'f', 6), "audio");
+                    }
                 }
                 else
                 {
@@ -39,6 +39,7 @@ public:
     void clearVisualizations();
 
     bool setParams(uchar realChn, uint realSRate, uchar chn, uint sRate, bool resamplerFirst);
+    void resetParams();
 
     void silence(bool invert, bool fromPause);
 
@@ -232,7 +232,10 @@ void DemuxerThr::seek(bool doDemuxerSeek)
         }
 
         if (doDemuxerSeek)
+        {
             stopRecording();
+            m_prefetchedPackets.clear();
+        }
 
         // Workaround: subtract 1 second for stepping backwards - sometimes FFmpeg doesn't seek to
         // key frame (why?) or PTS is higher than DTS. This also doesn't resolve all rare issues.
@@ -300,6 +303,9 @@ void DemuxerThr::stop()
 {
     ioCtrl.abort();
     demuxer.abort();
+    QMutexLocker locker(&m_prefetchMutex);
+    if (m_prefetchThr)
+        m_prefetchThr->stop();
 }
 void DemuxerThr::end()
 {
@@ -365,13 +371,28 @@ void DemuxerThr::run()
     emit playC.chText(tr("Opening"));
     emit playC.setCurrentPlaying();
 
-    emit QMPlay2Core.busyCursor();
-    Functions::getDataIfHasPluginPrefix(url, &url, &name, nullptr, &ioCtrl);
-    emit QMPlay2Core.restoreCursor();
+    bool prefetched = false;
+    if (m_prefetchThr)
+    {
+        // The next entry was opened while the previous one was playing
+        m_prefetchThr->wait();
+        prefetched = m_prefetchThr->takeDemuxer(url, name, demuxer, m_prefetchedPackets);
+        QMutexLocker locker(&m_prefetchMutex);
+        m_prefetchThr.reset(); // Already finished, so it doesn't block
+        if (prefetched && ioCtrl.isAborted())
+            demuxer.abort(); // Stopped before the demuxer was taken
+    }
+
+    if (!prefetched)
+    {
+        emit QMPlay2Core.busyCursor();
+        Functions::getDataIfHasPluginPrefix(url, &url, &name, nullptr, &ioCtrl);
+        emit QMPlay2Core.restoreCursor();
+    }
     if (ioCtrl.isAborted())
         return end();
 
-    if (Functions::isResourcePlaylist(url))
+    if (!prefetched && Functions::isResourcePlaylist(url))
     {
         end();
         emit QMPlay2Core.processParam("remove", origUrl);
@@ -379,7 +400,7 @@ void DemuxerThr::run()
         return;
     }
 
-    if (!Demuxer::create(url, demuxer) || demuxer.isAborted())
+    if ((!prefetched && !Demuxer::create(url, demuxer)) || demuxer.isAborted())
     {
         if (!demuxer.isAborted() && !demuxer)
         {
@@ -481,6 +502,8 @@ void DemuxerThr::run()
     int vS, aS;
     double vT, aT;
 
+    bool nextEntryRequested = false;
+
     demuxerReady = true;
 
     updateCoverAndPlaying(false);
@@ -702,7 +725,18 @@ void DemuxerThr::run()
         int streamIdx = -1;
         if (!localStream)
             demuxerTimer.start(); //Start the timer which will update buffer and pause information while demuxer is busy for long time (demuxer must call "processEvents()" from time to time)
-        const bool demuxerOk = demuxer->read(packet, streamIdx);
+        bool demuxerOk;
+        if (!m_prefetchedPackets.isEmpty())
+        {
+            const auto prefetchedPacket = m_prefetchedPackets.takeFirst();
+            streamIdx = prefetchedPacket.first;
+            packet = prefetchedPacket.second;
+            demuxerOk = true;
+        }
+        else
+        {
+            demuxerOk = demuxer->read(packet, streamIdx);
+        }
         if (!localStream)
             demuxerTimer.stop(); //Stop the timer, because the demuxer loop updates the data automatically
         if (demuxerOk)
@@ -732,6 +766,12 @@ void DemuxerThr::run()
         else if (!skipBufferSeek)
         {
             getAVBuffersSize(vS, aS, vT, aT);
+            if (!nextEntryRequested && !stillImage && !playC.doRepeat && QMPlay2Core.getSettings().getBool("PrefetchNextEntry"))
+            {
+                // Everything is buffered, open the next entry while the rest is playing
+                emit playC.nextEntryNeeded();
+                nextEntryRequested = true;
+            }
             playC.endOfStream = true;
             if (vS || aS || !canBreak(aThr, vThr))
             {
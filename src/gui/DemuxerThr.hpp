@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <PrefetchThr.hpp>
 #include <IOController.hpp>
 #include <StreamInfo.hpp>
 
@@ -111,6 +112,9 @@ private:
     double playIfBuffered, time, updateBufferedTime;
     std::unique_ptr<StreamMuxer> m_recMuxer;
     bool m_recording = false;
+    QMutex m_prefetchMutex; // "stop()" can be called while "run()" takes the prefetched demuxer
+    std::unique_ptr<PrefetchThr> m_prefetchThr;
+    PrefetchedPackets m_prefetchedPackets;
 private slots:
     void stopVADec();
     void updateCover(const QString &title, const QString &artist, const QString &album, const QByteArray &cover);
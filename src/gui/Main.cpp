@@ -28,6 +28,7 @@
 #include <Demuxer.hpp>
 #include <Version.hpp>
 #include <Module.hpp>
+#include <Tracer.hpp>
 #include <IPC.hpp>
 
 #include <QCommandLineParser>
@@ -41,6 +42,7 @@
 #include <QWindow>
 #include <QScreen>
 #include <QBuffer>
+#include <QDebug>
 #include <QFile>
 #include <QDir>
 #ifdef CHECK_FOR_EGL
@@ -276,6 +278,8 @@ static QCommandLineParser *createCmdParser(bool descriptions)
         QT_TRANSLATE_NOOP("Help", "Display this help."),
         QT_TRANSLATE_NOOP("Help", "Remove specified <url> from playlist."),
         QT_TRANSLATE_NOOP("Help", "Start in tray."),
+        QT_TRANSLATE_NOOP("Help", "Write startup and playback trace (Chrome trace JSON) to <file>."),
+        QT_TRANSLATE_NOOP("Help", "Terminate the application when the first video frame and audio are played (use with \"trace\")."),
     };
 
     const auto maybeGetTranslatedText = [&](const char *text) {
@@ -307,6 +311,8 @@ static QCommandLineParser *createCmdParser(bool descriptions)
 #if !(defined Q_OS_MACOS || defined Q_OS_ANDROID)
         {"tray", maybeGetTranslatedText(translations[18])},
 #endif
+        {"trace", maybeGetTranslatedText(translations[19]), "file"},
+        {"trace-quit", maybeGetTranslatedText(translations[20])},
         {{"h", "help"}, maybeGetTranslatedText(translations[16])},
     });
 
@@ -362,7 +368,7 @@ static bool writeToSocket(IPCSocket &socket, QList<QPair<QString, QString>> &arg
 
     for (auto &&argument : arguments)
     {
-        if (argument.first == "noplay" || argument.first == "profile")
+        if (argument.first == "noplay" || argument.first == "profile" || argument.first.startsWith("trace"))
             continue;
 
         if (argument.first == "open" || argument.first == "enqueue")
@@ -714,8 +720,13 @@ int main(int argc, char *argv[])
     QList<QPair<QString, QString>> arguments = parseArguments(*parser);
     const bool help = parser->isSet("help");
     QString cmdLineProfile = parser->value("profile");
+    QString traceFile = parser->value("trace");
+    qmplay2Gui.traceQuit = parser->isSet("trace-quit");
     delete parser;
 
+    if (traceFile.isEmpty())
+        traceFile = qEnvironmentVariable("QMPLAY2_TRACE");
+
     bool createPpipeInvoked = false;
 
     auto createPipe = [&] {
@@ -779,6 +790,9 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (!help)
+        Tracer::start(traceFile);
+
 #ifdef CHECK_FOR_EGL
     if (!help)
         checkForEGL();
@@ -963,7 +977,10 @@ int main(int argc, char *argv[])
         qmplay2Gui.restartApp = qmplay2Gui.removeSettings = qmplay2Gui.noAutoPlay = false;
         qmplay2Gui.startInvisible = startInvisible;
         qmplay2Gui.newProfileName.clear();
-        new MainWidget(arguments);
+        {
+            Tracer::Span traceSpan("MainWidget");
+            new MainWidget(arguments);
+        }
         do
         {
             QCoreApplication::exec();
@@ -1002,6 +1019,9 @@ int main(int argc, char *argv[])
         createPpipeInvoked = false;
     } while (qmplay2Gui.restartApp);
 
+    if (Tracer::isEnabled() && !Tracer::finish())
+        qCritical() << "Unable to write the trace file:" << traceFile;
+
     qmplay2Gui.deleteIcons();
 
 #ifdef Q_OS_WIN
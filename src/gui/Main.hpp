@@ -82,6 +82,7 @@ public:
     ShortcutHandler *shortcutHandler;
 
     bool restartApp, removeSettings, noAutoPlay, startInvisible;
+    bool traceQuit = false;
     QString newProfileName, cmdLineProfile;
 private:
     QMPlay2GUIClass();
@@ -34,6 +34,7 @@
 #include <QScreen>
 #include <QActionGroup>
 #include <QProxyStyle>
+#include <QCursor>
 #ifdef Q_OS_MACOS
     #include <QProcess>
 #endif
@@ -53,6 +54,7 @@
 #include <Main.hpp>
 #include <Notifies.hpp>
 #include <Functions.hpp>
+#include <ThumbnailEngine.hpp>
 #include <Appearance.hpp>
 #include <MainWidget.hpp>
 #include <SettingsWidget.hpp>
@@ -296,6 +298,11 @@ MainWidget::MainWidget(QList<QPair<QString, QString>> &arguments)
     seekS->setMaximum(0);
     seekS->setWheelStep(settings.getInt("ShortSeek"));
     mainTB->addWidget(seekS);
+
+    m_thumbnailEngine = new ThumbnailEngine(this);
+    m_thumbnailL = new QLabel(this, Qt::ToolTip);
+    m_thumbnailL->setFrameShape(QFrame::Box);
+
     updatePos(0.0);
 
     vLine = new QFrame;
@@ -352,6 +359,12 @@ MainWidget::MainWidget(QList<QPair<QString, QString>> &arguments)
 
     connect(seekS, SIGNAL(valueChanged(int)), this, SLOT(seek(int)));
     connect(seekS, SIGNAL(mousePosition(int)), this, SLOT(mousePositionOnSlider(int)));
+    connect(seekS, &Slider::mouseLeft, m_thumbnailL, &QLabel::hide);
+    connect(m_thumbnailEngine, &ThumbnailEngine::thumbnailReady, this, [this] {
+        // Show newly generated thumbnail under the cursor without moving the mouse
+        if (m_thumbnailPos > -1 && seekS->underMouse())
+            showThumbnail();
+    });
 
     connect(volW, SIGNAL(volumeChanged(int, int)), &playC, SLOT(volume(int, int)));
 
@@ -374,6 +387,8 @@ MainWidget::MainWidget(QList<QPair<QString, QString>> &arguments)
     connect(&playC, &PlayClass::setStreamsMenu, this, &MainWidget::setStreamsMenu);
     connect(&playC, SIGNAL(updateCurrentEntry(const QString &, double)), playlistDock, SLOT(updateCurrentEntry(const QString &, double)));
     connect(&playC, SIGNAL(playNext(bool)), playlistDock, SLOT(next(bool)));
+    connect(&playC, &PlayClass::nextEntryNeeded, playlistDock, &PlaylistDock::prefetchNext);
+    connect(playlistDock, &PlaylistDock::prefetch, &playC, &PlayClass::prefetch);
     connect(&playC, SIGNAL(clearCurrentPlaying()), playlistDock, SLOT(clearCurrentPlaying()));
     connect(&playC, &PlayClass::clearInfo, this, [this] {
         infoDock->clear();
@@ -1528,6 +1543,15 @@ void MainWidget::setSeekSMaximum(int max)
         m_taskBarProgress->setVisible(m_taskBarProgress->maximum() > 0);
     }
 #endif
+    if (max > 0 && playC.getUrl().startsWith("file://") && QMPlay2Core.getSettings().getBool("SeekThumbnails"))
+    {
+        m_thumbnailEngine->generate(playC.getUrl());
+    }
+    else
+    {
+        m_thumbnailEngine->cancel();
+        m_thumbnailL->hide();
+    }
     if (max >= 0)
     {
         seekS->setEnabled(true);
@@ -1567,6 +1591,22 @@ void MainWidget::updatePos(double pos)
 void MainWidget::mousePositionOnSlider(int pos)
 {
     statusBar->showMessage(tr("Pointed position") + ": " + timeToStr(pos / 10.0, true), 750);
+
+    m_thumbnailPos = pos;
+    showThumbnail();
+}
+void MainWidget::showThumbnail()
+{
+    const QImage thumbnail = m_thumbnailEngine->thumbnail(m_thumbnailPos / 10.0);
+    if (thumbnail.isNull() || !seekS->underMouse())
+    {
+        m_thumbnailL->hide();
+        return;
+    }
+    m_thumbnailL->setPixmap(QPixmap::fromImage(thumbnail));
+    m_thumbnailL->adjustSize();
+    m_thumbnailL->move(QCursor::pos().x() - m_thumbnailL->width() / 2, seekS->mapToGlobal(QPoint()).y() - m_thumbnailL->height() - 4);
+    m_thumbnailL->show();
 }
 
 void MainWidget::newConnection(IPCSocket *socket)
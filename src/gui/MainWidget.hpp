@@ -38,6 +38,7 @@ class AboutWidget;
 class PlaylistDock;
 class SettingsWidget;
 class QMPlay2Extensions;
+class ThumbnailEngine;
 
 #if defined(Q_OS_WIN)
     class QWinTaskbarProgress;
@@ -126,6 +127,8 @@ private:
 
     void savePlistHelper(const QString &, const QString &, bool);
 
+    void showThumbnail();
+
     QMenu *createPopupMenu() override;
 
     void hideDockWidgetsAndDisableFeatures();
@@ -187,6 +190,9 @@ private:
     PlaylistDock *playlistDock;
 
     Slider *seekS;
+    ThumbnailEngine *m_thumbnailEngine;
+    QLabel *m_thumbnailL;
+    int m_thumbnailPos = -1;
     VolWidget *volW;
 
     PlayClass playC;
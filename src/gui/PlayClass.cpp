@@ -33,6 +33,7 @@
 #include <Demuxer.hpp>
 #include <Decoder.hpp>
 #include <Reader.hpp>
+#include <Tracer.hpp>
 
 #include <QGuiApplication>
 #include <QVarLengthArray>
@@ -114,7 +115,15 @@ void PlayClass::play(const QString &_url)
 
 
             url = _url;
+
+            Tracer::instant("Play", url, "playback");
+            m_firstVideoTraced = m_firstAudioTraced = false;
+
             demuxThr = new DemuxerThr(*this);
+            if (m_prefetchThr && m_prefetchThr->origUrl() == url)
+                demuxThr->m_prefetchThr = std::move(m_prefetchThr);
+            else
+                PrefetchThr::discard(std::move(m_prefetchThr));
             demuxThr->minBuffSizeLocal = QMPlay2Core.getSettings().getInt("AVBufferLocal");
             demuxThr->m_minBuffTimeNetwork = QMPlay2Core.getSettings().getDouble("AVBufferTimeNetwork");
             demuxThr->m_minBuffTimeNetworkLive = QMPlay2Core.getSettings().getDouble("AVBufferTimeNetworkLive");
@@ -201,6 +210,8 @@ void PlayClass::stop(bool _quitApp)
 {
     emit continuePos(0.0, false);
     quitApp = _quitApp;
+    if (newUrl.isEmpty())
+        PrefetchThr::discard(std::move(m_prefetchThr));
     if (stopPauseMutex.tryLock())
     {
         if (isPlaying())
@@ -226,6 +237,19 @@ void PlayClass::stop(bool _quitApp)
         stopPauseMutex.unlock();
     }
 }
+void PlayClass::prefetch(const QString &url)
+{
+    if (url.isEmpty() || !demuxThr || (m_prefetchThr && m_prefetchThr->origUrl() == url))
+        return;
+
+    const double bufferTime = url.startsWith("file://")
+        ? 2.0
+        : QMPlay2Core.getSettings().getDouble("AVBufferTimeNetwork")
+    ;
+    PrefetchThr::discard(std::move(m_prefetchThr));
+    m_prefetchThr = std::make_unique<PrefetchThr>(url, bufferTime);
+    m_prefetchThr->start(QThread::LowPriority);
+}
 void PlayClass::restart()
 {
     if (!url.isEmpty())
@@ -258,6 +282,8 @@ void PlayClass::togglePause()
         fillBufferB = true;
         if (aThr && !paused)
             aThr->silence(true, true);
+        if (!paused && vThr && vThr->isShowingHistoryFrame())
+            seek(frame_last_pts); // Decoder is ahead of the displayed history frame
         stopPauseMutex.unlock();
     }
 }
@@ -781,6 +807,24 @@ inline void PlayClass::emitSetVideoCheckState()
     emit setVideoCheckState(rotate90, flip & Qt::Horizontal, flip & Qt::Vertical, spherical);
 }
 
+void PlayClass::traceFirstOutput(bool video)
+{
+    // Called from the video and audio threads only when tracing is enabled
+    auto &traced = video ? m_firstVideoTraced : m_firstAudioTraced;
+    if (traced.exchange(true))
+        return;
+
+    Tracer::instant(video ? "FirstVideoFrame" : "FirstAudio", QString(), "playback");
+
+    if (QMPlay2GUI.traceQuit)
+    {
+        QMetaObject::invokeMethod(this, [this] {
+            if ((m_firstVideoTraced || !vThr) && (m_firstAudioTraced || !aThr))
+                emit QMPlay2Core.processParam("quit", QString());
+        }, Qt::QueuedConnection);
+    }
+}
+
 void PlayClass::suspendWhenFinished(bool b)
 {
     doSuspend = b;
@@ -1333,8 +1377,11 @@ void PlayClass::prevFrame()
 {
     if (videoStream > -1 && videoSeekPos <= 0.0 && stopPauseMutex.tryLock())
     {
-        nextFrameB = true;
-        seek(frame_last_pts - frame_last_delay * 1.5);
+        if (!paused || nextFrameB || !vThr || !vThr->showHistoryFrame(true))
+        {
+            nextFrameB = true;
+            seek(frame_last_pts - frame_last_delay * 1.5);
+        }
         stopPauseMutex.unlock();
     }
 }
@@ -1342,8 +1389,11 @@ void PlayClass::nextFrame()
 {
     if (stopPauseMutex.tryLock())
     {
-        paused = false;
-        nextFrameB = fillBufferB = true;
+        if (!paused || nextFrameB || !vThr || !vThr->showHistoryFrame(false))
+        {
+            paused = false;
+            nextFrameB = fillBufferB = true;
+        }
         stopPauseMutex.unlock();
     }
 }
@@ -1825,10 +1875,18 @@ void PlayClass::load(Demuxer *demuxer)
             {
                 aThr->setDec(dec);
 
-                if (!setAudioParams(streams[audioStream]->params->CODECPAR_NB_CHANNELS, streams[audioStream]->params->sample_rate))
+                const AVCodecParameters *params = streams[audioStream]->params;
+                if (params->CODECPAR_NB_CHANNELS <= 0 || params->sample_rate <= 0)
+                {
+                    // Not found by the fast start of a network stream, the first decoded frame sets them
+                    aThr->resetParams();
+                }
+                else if (!setAudioParams(params->CODECPAR_NB_CHANNELS, params->sample_rate))
+                {
                     dec = nullptr;
+                }
 
-                else if (reload)
+                if (dec && reload)
                 {
                     seekTo = SEEK_STREAM_RELOAD;
                     allowAccurateSeek = true;
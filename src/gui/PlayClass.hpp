@@ -30,7 +30,9 @@
 #include <QWaitCondition>
 
 #include <memory>
+#include <atomic>
 
+class PrefetchThr;
 class StreamInfo;
 class QMPlay2OSD;
 class DemuxerThr;
@@ -60,6 +62,7 @@ public:
 
     Q_SLOT void play(const QString &);
     Q_SLOT void stop(bool quitApp = false);
+    Q_SLOT void prefetch(const QString &url);
     void restart();
 
     inline bool canUpdatePosition() const
@@ -145,6 +148,8 @@ private:
 
     inline void emitSetVideoCheckState();
 
+    void traceFirstOutput(bool video);
+
     DemuxerThr *demuxThr;
     VideoThr *vThr;
     AudioThr *aThr;
@@ -189,6 +194,11 @@ private:
     bool m_integerScaling = false;
     bool m_preciseZoom = false;
 
+    std::atomic_bool m_firstVideoTraced {false};
+    std::atomic_bool m_firstAudioTraced {false};
+
+    std::unique_ptr<PrefetchThr> m_prefetchThr;
+
 private slots:
     void suspendWhenFinished(bool b);
     void repeatEntry(bool b);
@@ -259,6 +269,7 @@ signals:
     void setStreamsMenu(const QStringList &videoStreams, const QStringList &audioStreams, const QStringList &subsStreams, const QStringList &chapters, const QStringList &programs);
     void updateCurrentEntry(const QString &, double);
     void playNext(bool playingError);
+    void nextEntryNeeded();
     void clearCurrentPlaying();
     void clearInfo();
     void quit();
@@ -516,6 +516,57 @@ void PlaylistDock::next(bool playingError)
     else
         itemDoubleClicked(tWI);
 }
+void PlaylistDock::prefetchNext()
+{
+    // Predicts the result of "next()" for sequential playback without changing anything
+    if (isRandomPlayback() || repeatMode == RepeatStopAfter || repeatMode == RepeatEntry)
+        return;
+
+    QTreeWidgetItem *currItem = list->currentPlaying;
+    if (!currItem || (PlaylistWidget::getFlags(currItem) & Playlist::Entry::StopAfter))
+        return;
+
+    QTreeWidgetItem *tWI = nullptr;
+    if (!list->queue.isEmpty())
+    {
+        tWI = list->queue.first();
+    }
+    else
+    {
+        const QList<QTreeWidgetItem *> l = list->getChildren(PlaylistWidget::ONLY_NON_GROUPS);
+        const int idx = l.indexOf(currItem);
+        if (idx < 0)
+            return;
+
+        QTreeWidgetItem *P = currItem->parent();
+        for (int i = idx + 1; i < l.count(); ++i)
+        {
+            if (repeatMode == RepeatGroup && P && l.at(i)->parent() != P)
+                break;
+            if (!(PlaylistWidget::getFlags(l.at(i)) & Playlist::Entry::Skip))
+            {
+                tWI = l.at(i);
+                break;
+            }
+        }
+        if (!tWI)
+        {
+            if (repeatMode == RepeatGroup && P)
+            {
+                const QList<QTreeWidgetItem *> l2 = list->getChildren(PlaylistWidget::ONLY_NON_GROUPS, P);
+                if (!l2.isEmpty())
+                    tWI = l2.at(0);
+            }
+            else if (repeatMode == RepeatList || repeatMode == RepeatGroup)
+            {
+                tWI = l.at(0);
+            }
+        }
+    }
+
+    if (tWI)
+        emit prefetch(getUrl(tWI));
+}
 void PlaylistDock::prev()
 {
     QTreeWidgetItem *tWI = nullptr;
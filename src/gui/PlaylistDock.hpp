@@ -91,6 +91,7 @@ private slots:
 public slots:
     void stopLoading();
     void next(bool playingError = false);
+    void prefetchNext();
     void prev();
     void skip();
     void stopAfter();
@@ -126,6 +127,7 @@ public slots:
     void updateCurrentEntry(const QString &, double);
 signals:
     void play(const QString &);
+    void prefetch(const QString &);
     void repeatEntry(bool b);
     void stop();
     void addAndPlayRestoreWindow();
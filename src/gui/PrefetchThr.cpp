@@ -0,0 +1,118 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <PrefetchThr.hpp>
+
+#include <Functions.hpp>
+#include <Demuxer.hpp>
+#include <Tracer.hpp>
+
+#include <QHash>
+
+constexpr qint64 g_maxPrefetchBytes = 32 * 1024 * 1024;
+
+void PrefetchThr::discard(std::unique_ptr<PrefetchThr> &&prefetchThr)
+{
+    if (!prefetchThr)
+        return;
+
+    PrefetchThr *thr = prefetchThr.release();
+    thr->stop();
+    connect(thr, &QThread::finished, thr, &QObject::deleteLater);
+    if (!thr->isRunning())
+        thr->deleteLater(); // Already finished, it's safe to call "deleteLater()" twice
+}
+
+PrefetchThr::PrefetchThr(const QString &url, double bufferTime)
+    : m_origUrl(url)
+    , m_bufferTime(bufferTime)
+{}
+PrefetchThr::~PrefetchThr()
+{
+    stop();
+    wait();
+}
+
+void PrefetchThr::stop()
+{
+    m_ioCtrl.abort();
+    m_demuxer.abort();
+}
+
+bool PrefetchThr::takeDemuxer(QString &url, QString &name, IOController<Demuxer> &demuxer, PrefetchedPackets &packets)
+{
+    Q_ASSERT(isFinished());
+    if (!m_demuxer || m_demuxer.isAborted())
+        return false;
+
+    url = m_url;
+    name = m_name;
+    demuxer.swap(m_demuxer);
+    packets.swap(m_packets);
+
+    m_demuxer.reset();
+    m_packets.clear();
+
+    return true;
+}
+
+void PrefetchThr::run()
+{
+    Tracer::Span traceSpan("PrefetchNextEntry", "playback");
+    traceSpan.setDetail(m_origUrl);
+
+    m_url = m_origUrl;
+    Functions::getDataIfHasPluginPrefix(m_url, &m_url, &m_name, nullptr, &m_ioCtrl);
+    if (m_ioCtrl.isAborted() || Functions::isResourcePlaylist(m_url))
+        return;
+
+    if (!Demuxer::create(m_url, m_demuxer) || m_demuxer.isAborted())
+    {
+        m_demuxer.reset();
+        return;
+    }
+
+    // Live streams and still images are only opened, buffered packets would be outdated
+    if (m_demuxer->length() < 0.0 || m_demuxer->isStillImage())
+        return;
+
+    QHash<int, double> firstTs;
+    qint64 bytes = 0;
+    while (!m_demuxer.isAborted() && bytes < g_maxPrefetchBytes)
+    {
+        Packet packet;
+        int streamIdx = -1;
+        if (!m_demuxer->read(packet, streamIdx))
+            break;
+        if (streamIdx < 0)
+            continue;
+
+        bytes += packet.size();
+
+        const double ts = packet.ts();
+        const auto it = firstTs.constFind(streamIdx);
+        const bool buffered = (it != firstTs.constEnd() && ts - it.value() >= m_bufferTime);
+        if (it == firstTs.constEnd())
+            firstTs.insert(streamIdx, ts);
+
+        m_packets.append({streamIdx, packet});
+
+        if (buffered)
+            break;
+    }
+}
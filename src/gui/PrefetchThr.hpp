@@ -0,0 +1,65 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <IOController.hpp>
+#include <Packet.hpp>
+
+#include <QThread>
+#include <QList>
+#include <QPair>
+
+#include <memory>
+
+class Demuxer;
+
+using PrefetchedPackets = QList<QPair<int, Packet>>;
+
+/* Opens the next playlist entry and buffers its first packets while the current entry is still playing */
+
+class PrefetchThr final : public QThread
+{
+public:
+    // Aborts the thread and deletes it when it finishes, without waiting for it
+    static void discard(std::unique_ptr<PrefetchThr> &&prefetchThr);
+
+    PrefetchThr(const QString &url, double bufferTime);
+    ~PrefetchThr();
+
+    inline QString origUrl() const
+    {
+        return m_origUrl;
+    }
+
+    void stop();
+
+    // Must be called after the thread has finished
+    bool takeDemuxer(QString &url, QString &name, IOController<Demuxer> &demuxer, PrefetchedPackets &packets);
+
+private:
+    void run() override;
+
+    const QString m_origUrl;
+    const double m_bufferTime;
+
+    QString m_url, m_name;
+    IOController<> m_ioCtrl;
+    IOController<Demuxer> m_demuxer;
+    PrefetchedPackets m_packets;
+};
@@ -208,6 +208,7 @@ void SettingsWidget::InitSettings()
 # endif
     QMPSettings.init("YtDl/DefaultQualityEnabled", false);
     QMPSettings.init("YtDl/DefaultQuality", QString());
+    QMPSettings.init("YtDl/PersistentWorker", false);
 #endif
 
     QMPSettings.init("OpenGL/OnWindow", false);
@@ -258,6 +259,8 @@ void SettingsWidget::InitSettings()
     QMPSettings.init("RestoreAVSState", false);
     QMPSettings.init("DisableSubtitlesAtStartup", false);
     QMPSettings.init("StoreUrlPos", true);
+    QMPSettings.init("PrefetchNextEntry", true);
+    QMPSettings.init("SeekThumbnails", true);
     QMPSettings.init("StoreARatioAndZoom", false);
     QMPSettings.init("SavePos", false);
     QMPSettings.init("KeepZoom", false);
@@ -501,6 +504,7 @@ SettingsWidget::SettingsWidget(int page, const QString &moduleName, QWidget *vid
         generalSettingsPage->dfltYtDlQualE->setText(QMPSettings.getString("YtDl/DefaultQuality"));
 
         generalSettingsPage->dontUpdateYtDlCB->setChecked(QMPSettings.getBool("YtDl/DontAutoUpdate"));
+        generalSettingsPage->persistentYtDlCB->setChecked(QMPSettings.getBool("YtDl/PersistentWorker"));
 
         connect(generalSettingsPage->cookiesFromBrowserCB, &QCheckBox::toggled, this, [this](bool checked) {
             generalSettingsPage->cookiesFromBrowserE->setEnabled(checked);
@@ -680,6 +684,8 @@ SettingsWidget::SettingsWidget(int page, const QString &moduleName, QWidget *vid
         playbackSettingsPage->disableSubtitlesAtStartup->setChecked(QMPSettings.getBool("DisableSubtitlesAtStartup"));
 
         playbackSettingsPage->storeUrlPosB->setChecked(QMPSettings.getBool("StoreUrlPos"));
+        playbackSettingsPage->prefetchNextEntryB->setChecked(QMPSettings.getBool("PrefetchNextEntry"));
+        playbackSettingsPage->seekThumbnailsB->setChecked(QMPSettings.getBool("SeekThumbnails"));
 
         for (int m = 1; m < 3; ++m)
             playbackSettingsPage->modulesListLayout->addWidget(m_modulesListGroupBox[m]);
@@ -1350,6 +1356,7 @@ void SettingsWidget::apply()
             QMPSettings.set("YtDl/DefaultQualityEnabled", generalSettingsPage->dfltYtDlQualCB->isChecked() && !generalSettingsPage->dfltYtDlQualE->text().simplified().isEmpty());
             QMPSettings.set("YtDl/DefaultQuality", generalSettingsPage->dfltYtDlQualE->text());
             QMPSettings.set("YtDl/DontAutoUpdate", generalSettingsPage->dontUpdateYtDlCB->isChecked());
+            QMPSettings.set("YtDl/PersistentWorker", generalSettingsPage->persistentYtDlCB->isChecked());
 #endif
 
             if (generalSettingsPage->trayNotifiesDefault)
@@ -1436,6 +1443,8 @@ void SettingsWidget::apply()
             QMPSettings.set("RestoreAVSState", playbackSettingsPage->restoreAVSStateB->isChecked());
             QMPSettings.set("DisableSubtitlesAtStartup", playbackSettingsPage->disableSubtitlesAtStartup->isChecked());
             QMPSettings.set("StoreUrlPos", playbackSettingsPage->storeUrlPosB->isChecked());
+            QMPSettings.set("PrefetchNextEntry", playbackSettingsPage->prefetchNextEntryB->isChecked());
+            QMPSettings.set("SeekThumbnails", playbackSettingsPage->seekThumbnailsB->isChecked());
             QMPSettings.set("StoreARatioAndZoom", playbackSettingsPage->storeARatioAndZoomB->isChecked());
 
             QStringList audioWriters, decoders;
@@ -32,6 +32,7 @@
 #include <LibASS.hpp>
 #include <ImgScaler.hpp>
 #include <Functions.hpp>
+#include <Tracer.hpp>
 
 #ifdef USE_OPENGL
 #   include <opengl/OpenGLHWInterop.hpp>
@@ -60,6 +61,24 @@ using namespace std;
 
 #include <cmath>
 
+// The history is kept only while paused or stepping, during playback it's empty.
+// Budget for frames kept in system memory:
+constexpr qint64 g_historyMaxBytes = 128ll * 1024ll * 1024ll;
+// HW frames are only references, but they come from the decoder's fixed-size surface pool,
+// so holding too many of them would starve the decoder.
+constexpr int g_historyMaxHWFrames = 3;
+
+static qint64 historyFrameBytes(const Frame &frame)
+{
+    if (!frame.hasCPUAccess())
+        return 0;
+
+    qint64 bytes = 0;
+    for (int p = 0; p < frame.numPlanes(); ++p)
+        bytes += static_cast<qint64>(qAbs(frame.linesize(p))) * frame.height(p);
+    return bytes;
+}
+
 VideoThr::VideoThr(PlayClass &playC, const QStringList &pluginsName) :
     AVThread(playC),
     syncVtoA(QMPlay2Core.getSettings().getBool("SyncVtoA")),
@@ -97,6 +116,7 @@ void VideoThr::setDec(Decoder *dec)
     if (!dec->hasHWDecContext() && videoWriter()->hwDecContext())
         videoWriter()->setHWDecContext(nullptr);
     decoderError = false;
+    clearHistory();
 }
 
 shared_ptr<HWDecContext> VideoThr::getHWDecContext() const
@@ -233,6 +253,62 @@ void VideoThr::otherReset()
         writer->modParam("ResetOther", true);
 }
 
+bool VideoThr::showHistoryFrame(bool backward)
+{
+    Frame frame;
+    {
+        lock_guard<mutex> locker(m_historyMutex);
+
+        if (!canWrite || m_history.empty())
+            return false;
+
+        const int size = static_cast<int>(m_history.size());
+        int pos = m_historyPos;
+        if (pos < 0)
+        {
+            // The newest frame must be the displayed one
+            if (qAbs(m_history.back().ts() - playC.frame_last_pts) > 0.001)
+                return false;
+            pos = size - 1;
+        }
+
+        pos += backward ? -1 : 1;
+        if (pos < 0 || pos >= size)
+            return false;
+
+        // Decoder continues after the newest frame, so playback can go on from there
+        m_historyPos = (pos == size - 1) ? -1 : pos;
+        frame = m_history[pos];
+    }
+
+    const double ts = frame.ts();
+    playC.frame_last_pts = ts;
+    playC.chPos(ts);
+
+    QMPlay2OSDList osdList;
+    if (m_subsDisplayMutex.try_lock())
+    {
+        playC.subsMutex.lock();
+        if (m_subtitles)
+        {
+            const double subsPts = ts - playC.subtitlesSync;
+            const bool hasDuration = m_subtitles->duration() >= 0.0;
+            if (subsPts >= m_subtitles->pts() && (!hasDuration || subsPts <= m_subtitles->pts() + m_subtitles->duration()))
+                osdList += m_subtitles;
+        }
+        playC.subsMutex.unlock();
+        m_subsDisplayMutex.unlock();
+    }
+
+    write(frame, move(osdList), seq);
+    return true;
+}
+bool VideoThr::isShowingHistoryFrame() const
+{
+    lock_guard<mutex> locker(m_historyMutex);
+    return (m_historyPos > -1);
+}
+
 void VideoThr::initFilters()
 {
     Settings &QMPSettings = QMPlay2Core.getSettings();
@@ -356,6 +432,8 @@ void VideoThr::initFilters()
 
 bool VideoThr::processParams()
 {
+    Tracer::Span traceSpan("Writer::processParams", "video");
+    traceSpan.setDetail(writer->name());
     return writer->processParams();
 }
 
@@ -417,6 +495,7 @@ void VideoThr::run()
     {
         if (deleteFrame)
         {
+            clearHistory();
             videoFrame.clear();
             frame_timer = -1.0;
             deleteFrame = false;
@@ -440,6 +519,8 @@ void VideoThr::run()
         {
             if (playC.paused && !paused)
             {
+                // Start the history with the frame displayed when pausing
+                addToHistory(videoFrame);
                 QTimer::singleShot(0, this, [this] {
                     pause();
                 });
@@ -500,6 +581,7 @@ void VideoThr::run()
             filters.clearBuffers();
             if (flushVideo)
                 frame_timer = -1.0;
+            clearHistory();
         }
 
         if ((!packet.isEmpty() || maybeFlush) && (!skipNonKey || packet.hasKeyFrame()))
@@ -668,6 +750,10 @@ void VideoThr::run()
                 }
                 if (cont)
                 {
+                    // Stepping backwards decodes from the key frame, keep the frames before the
+                    // target, so next backward steps don't have to decode the whole GOP again.
+                    if (playC.nextFrameB && ptsIsValid)
+                        addToHistory(videoFrame);
                     mutex.unlock();
                     continue;
                 }
@@ -809,6 +895,10 @@ void VideoThr::run()
                 if (!skip && canWrite)
                 {
                     oneFrame = canWrite = false;
+                    if (!playC.paused && !playC.nextFrameB)
+                        clearHistory(); // Don't hold decoder surfaces and memory during playback
+                    else if (ptsIsValid)
+                        addToHistory(videoFrame);
                     if (!osdList.isEmpty())
                         m_subsDisplayLocker = unique_lock<std::mutex>(m_subsDisplayMutex);
                     QTimer::singleShot(0, this, [=, osdList = move(osdList)]() mutable {
@@ -878,9 +968,58 @@ void VideoThr::write(const Frame &videoFrame, QMPlay2OSDList &&osdList, quint32
 
     videoWriter()->writeVideo(videoFrame, move(osdList));
 
+    if (Tracer::isEnabled())
+        playC.traceFirstOutput(true);
+
     if (m_subsDisplayLocker.owns_lock())
         swap(m_subtitles, m_subtitlesBusy);
 }
+void VideoThr::addToHistory(const Frame &frame)
+{
+    if (frame.isEmpty() || !frame.isTsValid())
+        return;
+
+    lock_guard<mutex> locker(m_historyMutex);
+
+    // Already added, e.g. when pausing after a frame step
+    if (m_historyPos < 0 && !m_history.empty() && frame.ts() == m_history.back().ts())
+        return;
+
+    // Playback continued from the history frame or timestamps went backwards
+    if (m_historyPos > -1 || (!m_history.empty() && frame.ts() <= m_history.back().ts()))
+    {
+        m_history.clear();
+        m_historyBytes = 0;
+        m_historyHWFrames = 0;
+        m_historyPos = -1;
+    }
+
+    const qint64 bytes = historyFrameBytes(frame);
+    m_history.push_back(frame);
+    m_historyBytes += bytes;
+    if (bytes == 0)
+        ++m_historyHWFrames;
+
+    while (m_history.size() > 1 && (m_historyBytes > g_historyMaxBytes || m_historyHWFrames > g_historyMaxHWFrames))
+    {
+        const qint64 frontBytes = historyFrameBytes(m_history.front());
+        m_historyBytes -= frontBytes;
+        if (frontBytes == 0)
+            --m_historyHWFrames;
+        m_history.pop_front();
+    }
+}
+void VideoThr::clearHistory()
+{
+    lock_guard<mutex> locker(m_historyMutex);
+    if (m_history.empty())
+        return;
+    m_history.clear();
+    m_historyBytes = 0;
+    m_historyHWFrames = 0;
+    m_historyPos = -1;
+}
+
 void VideoThr::screenshot(Frame videoFrame)
 {
     ImgScaler imgScaler;
@@ -21,6 +21,9 @@
 #include <AVThread.hpp>
 #include <VideoFilters.hpp>
 #include <QMPlay2OSD.hpp>
+#include <Frame.hpp>
+
+#include <deque>
 
 extern "C" {
     #include <libavutil/rational.h>
@@ -83,6 +86,9 @@ public:
 
     void updateSubs();
 
+    bool showHistoryFrame(bool backward);
+    bool isShowingHistoryFrame() const;
+
 private:
     inline VideoWriter *videoWriter() const;
 
@@ -97,6 +103,9 @@ private:
     void screenshot(Frame videoFrame);
     void pause();
 
+    void addToHistory(const Frame &frame);
+    void clearHistory();
+
 private:
     bool deleteSubs, syncVtoA, doScreenshot, canWrite, deleteOSD, deleteFrame, gotFrameOrError, decoderError, m_error = false;
     bool m_tsDisontPossible = false;
@@ -113,6 +122,13 @@ private:
     QMutex filtersMutex;
     double m_subtitlesScale = 1.0;
 
+    // Recently presented frames for instant backward frame stepping
+    mutable std::mutex m_historyMutex;
+    std::deque<Frame> m_history;
+    qint64 m_historyBytes = 0;
+    int m_historyHWFrames = 0;
+    int m_historyPos = -1; // Index of the displayed history frame, "-1" when displaying the newest one
+
 #ifdef Q_OS_WIN
     bool m_timerPrecision = false;
 #endif
@@ -39,6 +39,7 @@ AudioCD::AudioCD() :
 
     init("AudioCD/CDDB", true);
     init("AudioCD/CDTEXT", true);
+    init("AudioCD/ReadSpeed", 1);
 }
 AudioCD::~AudioCD()
 {
@@ -77,6 +78,11 @@ AudioCD::SettingsWidget *AudioCD::getSettingsWidget()
     return new ModuleSettingsWidget(*this);
 }
 
+bool AudioCD::canLoadOnDemand() const
+{
+    return false; // Has add actions
+}
+
 void AudioCD::add()
 {
     QWidget *parent = QMPlay2Core.getMainWindow();
@@ -138,6 +144,7 @@ QMPLAY2_EXPORT_MODULE(AudioCD)
 #include <QRadioButton>
 #include <QGroupBox>
 #include <QCheckBox>
+#include <QSpinBox>
 
 ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
     Module::SettingsWidget(module)
@@ -150,9 +157,17 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
     useCDTEXT = new QCheckBox(tr("Use CD-TEXT"));
     useCDTEXT->setChecked(sets().getBool("AudioCD/CDTEXT"));
 
+    readSpeedB = new QSpinBox;
+    readSpeedB->setRange(1, 52);
+    readSpeedB->setPrefix(tr("Drive read speed") + ": ");
+    readSpeedB->setSuffix("x");
+    readSpeedB->setToolTip(tr("Higher speed fills the read-ahead buffer faster, but the drive can be louder"));
+    readSpeedB->setValue(sets().getInt("AudioCD/ReadSpeed"));
+
     QVBoxLayout *audioCDBLayout = new QVBoxLayout(audioCDB);
     audioCDBLayout->addWidget(useCDDB);
     audioCDBLayout->addWidget(useCDTEXT);
+    audioCDBLayout->addWidget(readSpeedB);
 
     QGridLayout *layout = new QGridLayout(this);
     layout->addWidget(audioCDB);
@@ -162,4 +177,5 @@ void ModuleSettingsWidget::saveSettings()
 {
     sets().set("AudioCD/CDDB", useCDDB->isChecked());
     sets().set("AudioCD/CDTEXT", useCDTEXT->isChecked());
+    sets().set("AudioCD/ReadSpeed", readSpeedB->value());
 }
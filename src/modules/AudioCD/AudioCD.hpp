@@ -38,6 +38,8 @@ private:
 
     SettingsWidget *getSettingsWidget() override;
 
+    bool canLoadOnDemand() const override;
+
     QIcon CD;
 
     CDIODestroyTimer *cdioDestroyTimer;
@@ -51,6 +53,7 @@ private slots:
 class QGridLayout;
 class QGroupBox;
 class QCheckBox;
+class QSpinBox;
 
 class ModuleSettingsWidget final : public Module::SettingsWidget
 {
@@ -62,4 +65,5 @@ private:
 
     QGroupBox *audioCDB;
     QCheckBox *useCDDB, *useCDTEXT;
+    QSpinBox *readSpeedB;
 };
@@ -17,6 +17,7 @@
 */
 
 #include <AudioCDDemux.hpp>
+#include <AudioCDReader.hpp>
 
 #include <Functions.hpp>
 #include <Packet.hpp>
@@ -108,6 +109,7 @@ AudioCDDemux::AudioCDDemux(Module &module, CDIODestroyTimer &destroyTimer) :
 
 AudioCDDemux::~AudioCDDemux()
 {
+    reader.reset();
     if (cdio)
         emit destroyTimer.setInstance(cdio, device, discID);
 }
@@ -116,6 +118,7 @@ bool AudioCDDemux::set()
 {
     useCDDB   = sets().getBool("AudioCD/CDDB");
     useCDTEXT = sets().getBool("AudioCD/CDTEXT");
+    readSpeed = sets().getInt("AudioCD/ReadSpeed");
     return true;
 }
 
@@ -168,15 +171,19 @@ int AudioCDDemux::bitrate() const
 
 bool AudioCDDemux::seek(double s, bool)
 {
-    return (sector = (s / duration)) < numSectors;
+    if ((sector = (s / duration)) >= numSectors)
+        return false;
+    if (reader)
+        reader->seek(sector);
+    return true;
 }
 bool AudioCDDemux::read(Packet &decoded, int &idx)
 {
-    if (aborted || numSectors <= sector || isData)
+    if (aborted || numSectors <= sector || isData || !reader)
         return false;
 
     short cd_samples[CD_BLOCKSIZE];
-    if (cdio_read_audio_sector(cdio, cd_samples, startSector + sector) == DRIVER_OP_SUCCESS)
+    if (reader->read(cd_samples, sector))
     {
         decoded.resize(CD_BLOCKSIZE * sizeof(float));
         float *decoded_data = (float *)decoded.data();
@@ -196,6 +203,8 @@ bool AudioCDDemux::read(Packet &decoded, int &idx)
 void AudioCDDemux::abort()
 {
     aborted = true;
+    if (reader)
+        reader->abort();
 }
 
 bool AudioCDDemux::open(const QString &_url)
@@ -228,7 +237,7 @@ bool AudioCDDemux::open(const QString &_url)
         cdio = destroyTimer.getInstance(device, discID);
         if (cdio || (cdio = cdio_open(device.toLocal8Bit(), DRIVER_UNKNOWN)))
         {
-            cdio_set_speed(cdio, 1);
+            cdio_set_speed(cdio, readSpeed);
             numTracks = cdio_get_num_tracks(cdio);
             if (cdio_get_discmode(cdio) != CDIO_DISC_MODE_ERROR && numTracks > 0 && numTracks != CDIO_INVALID_TRACK)
             {
@@ -259,6 +268,9 @@ bool AudioCDDemux::open(const QString &_url)
                         }
                     }
 
+                    if (!isData)
+                        reader = std::make_unique<AudioCDReader>(cdio, startSector, numSectors);
+
                     streams_info += new StreamInfo(srate, chn);
                     return true;
                 }
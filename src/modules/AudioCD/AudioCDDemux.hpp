@@ -23,6 +23,8 @@
 
 #include <QAtomicInt>
 
+#include <memory>
+
 #include <cdio/cdio.h>
 #include <cddb/cddb.h>
 
@@ -48,6 +50,8 @@ private:
 
 /**/
 
+class AudioCDReader;
+
 class AudioCDDemux final : public Demuxer
 {
     Q_DECLARE_TR_FUNCTIONS(AudioCDDemux)
@@ -88,10 +92,12 @@ private:
 
     QString Title, Artist, Genre, cdTitle, cdArtist, device;
     CdIo_t *cdio;
+    std::unique_ptr<AudioCDReader> reader;
     track_t trackNo, numTracks;
     lsn_t startSector, numSectors, sector;
     double duration;
     bool isData, aborted, useCDDB, useCDTEXT;
+    int readSpeed;
     unsigned char chn;
     unsigned discID;
 };
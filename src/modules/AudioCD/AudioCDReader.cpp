@@ -0,0 +1,132 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <AudioCDReader.hpp>
+
+#include <QMPlay2Core.hpp>
+
+#include <cstring>
+
+constexpr lsn_t g_burstSectors = 24; // ~55 KiB per request
+constexpr lsn_t g_ringSectors = 75 * 10; // 10 seconds
+constexpr int g_maxRetries = 3;
+
+AudioCDReader::AudioCDReader(CdIo_t *cdio, lsn_t startSector, lsn_t numSectors)
+    : m_cdio(cdio)
+    , m_startSector(startSector)
+    , m_numSectors(numSectors)
+    , m_ring(g_ringSectors * SectorSamples)
+    , m_burst(g_burstSectors * SectorSamples)
+{
+    start();
+}
+AudioCDReader::~AudioCDReader()
+{
+    abort();
+    wait();
+}
+
+void AudioCDReader::seek(lsn_t sector)
+{
+    QMutexLocker locker(&m_mutex);
+    m_readSector = m_fillSector = qBound<lsn_t>(0, sector, m_numSectors);
+    ++m_seekCounter;
+    m_cond.wakeAll();
+}
+
+bool AudioCDReader::read(qint16 *samples, lsn_t &sector)
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_aborted && m_readSector < m_numSectors && m_readSector >= m_fillSector)
+        m_cond.wait(&m_mutex);
+    if (m_aborted || m_readSector >= m_numSectors)
+        return false;
+
+    memcpy(samples, m_ring.data() + (m_readSector % g_ringSectors) * SectorSamples, CDIO_CD_FRAMESIZE_RAW);
+    sector = m_readSector++;
+
+    // Wake the reader when there is enough space for the next burst
+    if (m_fillSector - m_readSector <= g_ringSectors - g_burstSectors)
+        m_cond.wakeAll();
+
+    return true;
+}
+
+void AudioCDReader::abort()
+{
+    QMutexLocker locker(&m_mutex);
+    m_aborted = true;
+    m_cond.wakeAll();
+}
+
+void AudioCDReader::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_aborted)
+    {
+        const lsn_t freeSectors = g_ringSectors - (m_fillSector - m_readSector);
+        const lsn_t remainingSectors = m_numSectors - m_fillSector;
+        const lsn_t count = qMin(qMin(freeSectors, remainingSectors), g_burstSectors);
+
+        // Wait for space for a whole burst (or for a seek when the whole track is read)
+        if (count <= 0 || (count < g_burstSectors && count < remainingSectors))
+        {
+            m_cond.wait(&m_mutex);
+            continue;
+        }
+
+        const lsn_t sector = m_fillSector;
+        const quint32 seekCounter = m_seekCounter;
+
+        locker.unlock();
+        readSectors(m_burst.data(), sector, count);
+        locker.relock();
+
+        if (seekCounter != m_seekCounter)
+            continue; // Seek while reading - drop the data
+
+        for (lsn_t i = 0; i < count; ++i)
+            memcpy(m_ring.data() + ((sector + i) % g_ringSectors) * SectorSamples, m_burst.data() + i * SectorSamples, CDIO_CD_FRAMESIZE_RAW);
+        m_fillSector += count;
+        m_cond.wakeAll();
+    }
+}
+
+bool AudioCDReader::readSectors(qint16 *samples, lsn_t sector, lsn_t count)
+{
+    for (int i = 0; i < g_maxRetries; ++i)
+    {
+        if (m_aborted)
+            return false;
+        if (cdio_read_audio_sectors(m_cdio, samples, m_startSector + sector, count) == DRIVER_OP_SUCCESS)
+            return true;
+    }
+
+    if (count > 1)
+    {
+        // Re-read the burst sector by sector, so only the damaged sectors are lost
+        bool ok = true;
+        for (lsn_t i = 0; i < count; ++i)
+            ok &= readSectors(samples + i * SectorSamples, sector + i, 1);
+        return ok;
+    }
+
+    QMPlay2Core.logError(QString("AudioCD :: Unable to read sector %1").arg(m_startSector + sector), false);
+    memset(samples, 0, CDIO_CD_FRAMESIZE_RAW);
+    return false;
+}
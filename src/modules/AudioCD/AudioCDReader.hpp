@@ -0,0 +1,65 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QWaitCondition>
+#include <QThread>
+#include <QMutex>
+
+#include <vector>
+#include <atomic>
+
+#include <cdio/cdio.h>
+
+// Reads audio sectors ahead in bursts into a ring buffer, so the drive can be read in larger
+// chunks and short drive stalls (spin up, re-reads) don't interrupt the playback.
+class AudioCDReader final : public QThread
+{
+public:
+    static constexpr int SectorSamples = CDIO_CD_FRAMESIZE_RAW / sizeof(qint16);
+
+    AudioCDReader(CdIo_t *cdio, lsn_t startSector, lsn_t numSectors);
+    ~AudioCDReader();
+
+    void seek(lsn_t sector);
+
+    // Waits for the next sector, "sector" is relative to the track start
+    bool read(qint16 *samples, lsn_t &sector);
+
+    void abort();
+
+private:
+    void run() override;
+
+    bool readSectors(qint16 *samples, lsn_t sector, lsn_t count);
+
+    CdIo_t *const m_cdio;
+    const lsn_t m_startSector, m_numSectors;
+
+    std::vector<qint16> m_ring;
+    std::vector<qint16> m_burst;
+
+    QWaitCondition m_cond;
+    QMutex m_mutex;
+
+    lsn_t m_readSector = 0; // next sector to return
+    lsn_t m_fillSector = 0; // next sector to read from the disc
+    quint32 m_seekCounter = 0;
+    std::atomic_bool m_aborted {false};
+};
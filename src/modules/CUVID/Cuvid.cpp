@@ -69,6 +69,11 @@ Module::SettingsWidget *Cuvid::getSettingsWidget()
     return new ModuleSettingsWidget(*this);
 }
 
+bool Cuvid::canLoadOnDemand() const
+{
+    return false; // Deinterlacing method widget is registered in constructor
+}
+
 void Cuvid::videoDeintSave()
 {
     set("DeintMethod", m_deintMethodB->currentIndex() + 1);
@@ -40,6 +40,8 @@ private:
 
     void videoDeintSave() override;
 
+    bool canLoadOnDemand() const override;
+
     /**/
 
     QComboBox *m_deintMethodB = nullptr;
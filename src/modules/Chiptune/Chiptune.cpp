@@ -44,11 +44,34 @@ QList<Chiptune::Info> Chiptune::getModulesInfo(const bool showDisabled) const
     QList<Info> modulesInfo;
 #ifdef USE_GME
     if (showDisabled || getBool("GME"))
-        modulesInfo += Info(GMEName, DEMUXER, {"ay", "gbs", "gym", "hes", "kss", "nsf", "nsfe", "sap", "spc", "vgm", "vgz"}, GMEIcon);
+    {
+        Info gmeInfo(GMEName, DEMUXER, {"ay", "gbs", "gym", "hes", "kss", "nsf", "nsfe", "sap", "spc", "vgm", "vgz"}, GMEIcon);
+        gmeInfo.magic = {
+            {"ay", 0, "ZXAYEMUL"},
+            {"gbs", 0, "GBS"},
+            {"hes", 0, "HESM"},
+            {"kss", 0, "KSCC"},
+            {"kss", 0, "KSSX"},
+            {"nsf", 0, "NESM\x1A"},
+            {"nsfe", 0, "NSFE"},
+            {"sap", 0, "SAP"},
+            {"spc", 0, "SNES-SPC700 Sound File Data"},
+            {"vgm", 0, "Vgm "},
+            {"vgz", 0, "\x1F\x8B"},
+        };
+        modulesInfo += gmeInfo;
+    }
 #endif
 #ifdef USE_SIDPLAY
     if (showDisabled || getBool("SIDPlay"))
-        modulesInfo += Info(SIDPlayName, DEMUXER, {"sid", "c64", "prg"}, SIDIcon);
+    {
+        Info sidInfo(SIDPlayName, DEMUXER, {"sid", "c64", "prg"}, SIDIcon);
+        sidInfo.magic = {
+            {"sid", 0, "PSID"},
+            {"sid", 0, "RSID"},
+        };
+        modulesInfo += sidInfo;
+    }
 #endif
     return modulesInfo;
 }
@@ -261,10 +261,11 @@ void Drawable::draw(const Frame &videoFrame)
         {
             if (osdImg.size() != QSize(ddsd.dwWidth, ddsd.dwHeight))
             {
-                osdImg = QImage(ddsd.dwWidth, ddsd.dwHeight, QImage::Format_ARGB32);
+                osdImg = QImage(ddsd.dwWidth, ddsd.dwHeight, QImage::Format_ARGB32_Premultiplied);
                 osdImg.fill(0);
+                osdBounds = QRect();
             }
-            Functions::paintOSDtoYV12(dest, osdImg, W, H, ddsd.lPitch, ddsd.lPitch >> 1, osd_list, osd_ids);
+            Functions::paintOSDtoYV12(dest, osdImg, osdBounds, W, H, ddsd.lPitch, ddsd.lPitch >> 1, osd_list, osd_ids);
         }
 
         if (surface != dest)
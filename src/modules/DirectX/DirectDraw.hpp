@@ -70,6 +70,7 @@ private:
 
     QImage osdImg;
     QVector<quint64> osd_ids;
+    QRect osdBounds;
 
     QTimer visibleTim;
 
@@ -18,6 +18,7 @@
 
 #include <Downloader.hpp>
 
+#include <Downloader/SegmentedDownload.hpp>
 #include <Functions.hpp>
 #include <StreamMuxer.hpp>
 #include <Demuxer.hpp>
@@ -65,6 +66,9 @@ constexpr const char *g_downloadError = QT_TRANSLATE_NOOP("DownloadItemW", "Down
 constexpr const char *g_conversionAborted = QT_TRANSLATE_NOOP("DownloadItemW", "Conversion aborted");
 constexpr const char *g_conversionError = QT_TRANSLATE_NOOP("DownloadItemW", "Conversion error");
 
+constexpr int g_progressInterval = 250;
+constexpr int g_saveStateInterval = 2000;
+
 /**/
 
 static QStringView getCommandOutput(const QString &command)
@@ -474,8 +478,8 @@ void DownloadItemW::deleteConvertProcess()
 
 /**/
 
-DownloaderThread::DownloaderThread(QDataStream *stream, const QString &url, DownloadListW *downloadLW, const QMenu *convertsMenu, const QString &name, const QString &prefix, const QString &param, const QString &preset) :
-    url(url), name(name), prefix(prefix), param(param), preset(preset), downloadItemW(nullptr), downloadLW(downloadLW), item(nullptr), m_convertsMenu(convertsMenu)
+DownloaderThread::DownloaderThread(QDataStream *stream, const QString &url, DownloadListW *downloadLW, const QMenu *convertsMenu, Settings &sets, const QString &name, const QString &prefix, const QString &param, const QString &preset) :
+    url(url), name(name), prefix(prefix), param(param), preset(preset), downloadItemW(nullptr), downloadLW(downloadLW), item(nullptr), m_convertsMenu(convertsMenu), m_sets(sets)
 {
     connect(this, SIGNAL(listSig(int, qint64, const QString &)), this, SLOT(listSlot(int, qint64, const QString &)));
     connect(this, SIGNAL(finished()), this, SLOT(finished()));
@@ -602,14 +606,17 @@ void DownloaderThread::run()
                 break;
             }
 
-    const auto getFilePath = [&]()->QString {
+    const auto getFilePath = [&](const QString &resumeUrl = QString())->QString {
         const auto downloadsDirPath = Functions::cleanPath(QMPlay2Core.getSettings().getString("OutputFilePath"));
         QString filePath;
         quint16 num = 0;
         Q_ASSERT(downloadsDirPath.endsWith("/"));
         do
+        {
             filePath = downloadsDirPath + (num ? (QString::number(num) + "_") : QString()) + Functions::cleanFileName(name);
-        while (QFile::exists(filePath) && ++num < 0xFFFF);
+            if (!resumeUrl.isEmpty() && SegmentedDownload::canResume(filePath, resumeUrl))
+                break;
+        } while ((QFile::exists(filePath) || QFile::exists(SegmentedDownload::stateFilePath(filePath))) && ++num < 0xFFFF);
         if (num == 0xFFFF)
             filePath.clear();
         return filePath;
@@ -625,6 +632,17 @@ void DownloaderThread::run()
         }
     };
 
+    QElapsedTimer progressT;
+    int lastPos = -1;
+    const auto setPos = [&](const int pos) {
+        if (pos != lastPos && (lastPos < 0 || progressT.elapsed() >= g_progressInterval))
+        {
+            emit listSig(SET_POS, pos);
+            progressT.start();
+            lastPos = pos;
+        }
+    };
+
     bool err = true;
 
     const bool isFFmpeg = newUrl.startsWith("FFmpeg://");
@@ -742,7 +760,7 @@ void DownloaderThread::run()
                         if (length > 0.0)
                         {
                             pos = qMax<double>(pos, packet.ts());
-                            emit listSig(SET_POS, pos * 100 / length);
+                            setPos(pos * 100 / length);
                         }
                     }
                 }
@@ -782,8 +800,55 @@ void DownloaderThread::run()
 
     QMPlay2Core.setWorking(true);
 
+    bool segmented = false;
+
+    const int segments = m_sets.getWithBounds("Downloader/Segments", 1, 16, 4);
+    if (segments > 1 && newUrl.startsWith("http"))
+    {
+        IOController<SegmentedDownload> &segmentedDownload = ioCtrl.toRef<SegmentedDownload>();
+        if (segmentedDownload.assign(new SegmentedDownload(newUrl)) && segmentedDownload->open())
+        {
+            const QString filePath = getFilePath(newUrl);
+            if (!filePath.isEmpty() && segmentedDownload->start(filePath, segments))
+            {
+                const qint64 size = segmentedDownload->size();
+                qint64 lastBytesPos = segmentedDownload->bytesDone();
+                bool finished = false;
+
+                emit listSig(SET, size, filePath);
+                speedT.start();
+
+                QElapsedTimer saveStateT;
+                saveStateT.start();
+                while (!finished)
+                {
+                    finished = segmentedDownload->waitForFinished(g_progressInterval);
+
+                    const qint64 bytesPos = segmentedDownload->bytesDone();
+                    setByteRate([&] {
+                        const qint64 tmp = bytesPos - lastBytesPos;
+                        lastBytesPos = bytesPos;
+                        return tmp;
+                    });
+                    setPos(bytesPos * 100 / size);
+
+                    if (!finished && saveStateT.elapsed() >= g_saveStateInterval)
+                    {
+                        segmentedDownload->saveState();
+                        saveStateT.restart();
+                    }
+                }
+                segmentedDownload->saveState();
+
+                err = !segmentedDownload->isOk();
+                segmented = true;
+            }
+        }
+        segmentedDownload.reset();
+    }
+
     IOController<Reader> &reader = ioCtrl.toRef<Reader>();
-    if (!newUrl.isEmpty())
+    if (!segmented && !newUrl.isEmpty())
         Reader::create(newUrl, reader);
     if (reader && reader->readyRead() && !reader->atEnd())
     {
@@ -791,7 +856,6 @@ void DownloaderThread::run()
         if (!file.fileName().isEmpty() && file.open(QFile::WriteOnly))
         {
             qint64 lastBytesPos = 0;
-            int lastPos = -1;
 
             emit listSig(SET, qMax<qint64>(-1, reader->size()), file.fileName());
             err = false;
@@ -821,14 +885,7 @@ void DownloaderThread::run()
                     return tmp;
                 });
                 if (reader->size() > 0)
-                {
-                    const int pos = bytesPos * 100 / reader->size();
-                    if (pos != lastPos)
-                    {
-                        emit listSig(SET_POS, pos);
-                        lastPos = pos;
-                    }
-                }
+                    setPos(bytesPos * 100 / reader->size());
             }
         }
         reader.reset();
@@ -965,7 +1022,7 @@ void Downloader::init()
         {
             QDataStream stream(QByteArray::fromBase64(m_sets.getByteArray("Items/Data")));
             for (int i = 0; i < count; ++i)
-                new DownloaderThread(&stream, QString(), downloadLW, m_convertsMenu);
+                new DownloaderThread(&stream, QString(), downloadLW, m_convertsMenu, sets());
             downloadLW->setCurrentItem(downloadLW->invisibleRootItem()->child(0));
         }
     }
@@ -1170,7 +1227,7 @@ void Downloader::addUrl()
     }
     QString url = QInputDialog::getText(this, DownloaderName, tr("Enter address"), QLineEdit::Normal, clipboardUrl);
     if (!url.isEmpty())
-        new DownloaderThread(nullptr, url, downloadLW, m_convertsMenu);
+        new DownloaderThread(nullptr, url, downloadLW, m_convertsMenu, sets());
 }
 void Downloader::download()
 {
@@ -1182,6 +1239,7 @@ void Downloader::download()
         action->property("url").toString(),
         downloadLW,
         m_convertsMenu,
+        sets(),
         action->property("name").toString(),
         action->property("prefix").toString(),
         action->property("param").toString(),
@@ -110,7 +110,7 @@ class DownloaderThread final : public QThread
     Q_OBJECT
     enum {ADD_ENTRY, NAME, SET, SET_POS, SET_SPEED, DOWNLOAD_ERROR, FINISH};
 public:
-    DownloaderThread(QDataStream *stream, const QString &url, DownloadListW *downloadLW, const QMenu *convertsMenu, const QString &name = QString(), const QString &prefix = QString(), const QString &param = QString(), const QString &preset = QString());
+    DownloaderThread(QDataStream *stream, const QString &url, DownloadListW *downloadLW, const QMenu *convertsMenu, Settings &sets, const QString &name = QString(), const QString &prefix = QString(), const QString &param = QString(), const QString &preset = QString());
     ~DownloaderThread();
 
     void serialize(QDataStream &stream);
@@ -132,6 +132,7 @@ private:
     DownloadListW *downloadLW;
     QTreeWidgetItem *item;
     const QMenu *m_convertsMenu;
+    Settings &m_sets;
     IOController<> ioCtrl;
 };
 
@@ -0,0 +1,363 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Downloader/SegmentedDownload.hpp>
+
+#include <Functions.hpp>
+
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QFile>
+
+extern "C"
+{
+    #include <libavformat/avio.h>
+    #include <libavutil/opt.h>
+}
+
+constexpr quint32 g_magic = 0x51444C31; // "QDL1"
+constexpr qint64 g_minSegmentSize = 1024 * 1024;
+constexpr int g_bufferSize = 64 * 1024;
+constexpr int g_maxRetries = 5;
+
+SegmentedDownload::SegmentedDownload(const QString &url)
+    : m_url(url)
+{}
+SegmentedDownload::~SegmentedDownload()
+{
+    abort();
+    for (auto &&thread : m_threads)
+        thread.join();
+}
+
+QString SegmentedDownload::stateFilePath(const QString &filePath)
+{
+    return filePath + ".qmpdl";
+}
+bool SegmentedDownload::canResume(const QString &filePath, const QString &url)
+{
+    QFile f(stateFilePath(filePath));
+    if (!QFile::exists(filePath) || !f.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream stream(&f);
+    quint32 magic = 0;
+    QString storedUrl;
+    stream >> magic >> storedUrl;
+    return (stream.status() == QDataStream::Ok && magic == g_magic && storedUrl == url);
+}
+
+bool SegmentedDownload::open()
+{
+    AVDictionary *options = nullptr;
+    const QByteArray url = Functions::prepareFFmpegUrl(m_url, options, false, true, true, false).toUtf8();
+    if (!url.startsWith("http"))
+    {
+        av_dict_free(&options);
+        return false;
+    }
+
+    AVIOContext *ctx = nullptr;
+    const AVIOInterruptCB interruptCB = {(int(*)(void *))SegmentedDownload::interruptCB, this};
+    avio_open2(&ctx, url.constData(), AVIO_FLAG_READ, &interruptCB, &options);
+    av_dict_free(&options);
+    if (!ctx)
+        return false;
+
+    // FFmpeg marks HTTP streams as seekable only if the server accepts byte ranges
+    if (ctx->seekable & AVIO_SEEKABLE_NORMAL)
+        m_size = avio_size(ctx);
+
+    // Don't follow the redirections again for every segment
+    uint8_t *location = nullptr;
+    if (av_opt_get(ctx, "location", AV_OPT_SEARCH_CHILDREN, &location) >= 0 && location)
+    {
+        m_effectiveUrl = reinterpret_cast<const char *>(location);
+        av_free(location);
+    }
+    if (m_effectiveUrl.isEmpty())
+        m_effectiveUrl = url;
+
+    avio_closep(&ctx);
+    return (m_size > 0);
+}
+
+bool SegmentedDownload::start(const QString &filePath, int maxSegments)
+{
+    m_filePath = filePath;
+
+    if (!loadState())
+    {
+        QFile file(m_filePath);
+        if (!file.open(QFile::WriteOnly) || !file.resize(m_size)) // Sparse file on most file systems
+            return false;
+
+        const qint64 count = qBound<qint64>(1, m_size / g_minSegmentSize, maxSegments);
+        const qint64 segmentSize = m_size / count;
+        m_segments.reserve(count);
+        for (qint64 i = 0; i < count; ++i)
+        {
+            const qint64 begin = i * segmentSize;
+            const qint64 end = (i == count - 1) ? m_size : begin + segmentSize;
+            m_segments.push_back({begin, end, 0, false});
+        }
+        saveState();
+    }
+
+    const int threads = qBound<qint64>(1, m_size / g_minSegmentSize, maxSegments);
+    m_running = threads;
+    m_threads.reserve(threads);
+    for (int i = 0; i < threads; ++i)
+        m_threads.emplace_back(&SegmentedDownload::downloadSegments, this);
+
+    return true;
+}
+bool SegmentedDownload::waitForFinished(int ms)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    return m_cond.wait_for(locker, std::chrono::milliseconds(ms), [this] {
+        return (m_running == 0);
+    });
+}
+
+qint64 SegmentedDownload::bytesDone() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    qint64 done = 0;
+    for (auto &&segment : m_segments)
+        done += segment.done;
+    return done;
+}
+bool SegmentedDownload::isOk() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (m_error || m_aborted || m_segments.empty())
+        return false;
+    for (auto &&segment : m_segments)
+    {
+        if (segment.begin + segment.done < segment.end)
+            return false;
+    }
+    return true;
+}
+
+void SegmentedDownload::saveState()
+{
+    if (m_filePath.isEmpty())
+        return;
+
+    if (isOk())
+    {
+        QFile::remove(stateFilePath(m_filePath));
+        return;
+    }
+
+    std::vector<Segment> segments;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        segments = m_segments;
+    }
+
+    QSaveFile f(stateFilePath(m_filePath));
+    if (!f.open(QFile::WriteOnly))
+        return;
+
+    QDataStream stream(&f);
+    stream << g_magic << m_url << m_size << static_cast<quint32>(segments.size());
+    for (auto &&segment : segments)
+        stream << segment.begin << segment.end << segment.done;
+    if (stream.status() == QDataStream::Ok)
+        f.commit();
+}
+
+void SegmentedDownload::abort()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_aborted = true;
+    m_cond.notify_all();
+}
+
+bool SegmentedDownload::loadState()
+{
+    if (QFileInfo(m_filePath).size() != m_size)
+        return false;
+
+    QFile f(stateFilePath(m_filePath));
+    if (!f.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream stream(&f);
+    quint32 magic = 0;
+    QString url;
+    qint64 size = 0;
+    quint32 count = 0;
+    stream >> magic >> url >> size >> count;
+    if (stream.status() != QDataStream::Ok || magic != g_magic || url != m_url || size != m_size || count == 0 || count > 0xFFFF)
+        return false;
+
+    std::vector<Segment> segments(count);
+    for (auto &&segment : segments)
+    {
+        stream >> segment.begin >> segment.end >> segment.done;
+        segment.claimed = false;
+        if (segment.begin < 0 || segment.end > m_size || segment.begin > segment.end || segment.done < 0 || segment.done > segment.end - segment.begin)
+            return false;
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    m_segments = std::move(segments);
+    return true;
+}
+
+bool SegmentedDownload::claimSegment(int &idx)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+
+    if (m_error || m_aborted)
+        return false;
+
+    int largestIdx = -1;
+    qint64 largestRemaining = 0;
+    for (int i = 0; i < static_cast<int>(m_segments.size()); ++i)
+    {
+        Segment &segment = m_segments[i];
+        const qint64 remaining = segment.end - segment.begin - segment.done;
+        if (remaining <= 0)
+            continue;
+        if (!segment.claimed)
+        {
+            segment.claimed = true;
+            idx = i;
+            return true;
+        }
+        if (remaining > largestRemaining)
+        {
+            largestRemaining = remaining;
+            largestIdx = i;
+        }
+    }
+
+    // Nothing left to claim - take over the second half of the largest segment in progress
+    if (largestIdx < 0 || largestRemaining < 2 * g_minSegmentSize)
+        return false;
+
+    const qint64 end = m_segments[largestIdx].end;
+    const qint64 middle = end - largestRemaining / 2;
+    m_segments[largestIdx].end = middle;
+    m_segments.push_back({middle, end, 0, true});
+    idx = m_segments.size() - 1;
+    return true;
+}
+void SegmentedDownload::downloadSegments()
+{
+    QFile file(m_filePath);
+    bool ok = file.open(QFile::ReadWrite | QFile::Unbuffered);
+
+    QByteArray buffer(g_bufferSize, Qt::Uninitialized);
+    int idx = -1;
+
+    while (ok && claimSegment(idx))
+    {
+        int retries = 0;
+        for (;;)
+        {
+            qint64 pos, end;
+            {
+                std::unique_lock<std::mutex> locker(m_mutex);
+                if (retries > 0)
+                {
+                    m_cond.wait_for(locker, std::chrono::seconds(retries), [this] {
+                        return m_aborted.load();
+                    });
+                }
+                const Segment &segment = m_segments[idx];
+                pos = segment.begin + segment.done;
+                end = segment.end;
+            }
+            if (pos >= end || m_aborted)
+                break;
+
+            AVDictionary *options = nullptr;
+            Functions::prepareFFmpegUrl(m_url, options, false, true, true, false);
+            av_dict_set_int(&options, "offset", pos, 0);
+            av_dict_set_int(&options, "end_offset", end, 0);
+
+            AVIOContext *ctx = nullptr;
+            const AVIOInterruptCB interruptCB = {(int(*)(void *))SegmentedDownload::interruptCB, this};
+            avio_open2(&ctx, m_effectiveUrl.constData(), AVIO_FLAG_READ, &interruptCB, &options);
+            av_dict_free(&options);
+
+            bool gotData = false;
+            if (ctx && file.seek(pos))
+            {
+                while (!m_aborted)
+                {
+                    {
+                        // The end can move backwards when other thread takes over a part of this segment
+                        std::lock_guard<std::mutex> locker(m_mutex);
+                        end = m_segments[idx].end;
+                    }
+                    if (pos >= end)
+                        break;
+
+                    const int bytes = avio_read_partial(ctx, reinterpret_cast<uint8_t *>(buffer.data()), qMin<qint64>(buffer.size(), end - pos));
+                    if (bytes <= 0)
+                        break;
+                    if (file.write(buffer.constData(), bytes) != bytes)
+                    {
+                        ok = false;
+                        break;
+                    }
+
+                    pos += bytes;
+                    gotData = true;
+
+                    std::lock_guard<std::mutex> locker(m_mutex);
+                    Segment &segment = m_segments[idx];
+                    segment.done = qMin(pos, segment.end) - segment.begin;
+                }
+            }
+            avio_closep(&ctx);
+
+            if (!ok)
+                break;
+            if (gotData)
+            {
+                retries = 0;
+            }
+            else if (++retries > g_maxRetries)
+            {
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (!ok && !m_aborted)
+        m_error = true;
+    --m_running;
+    m_cond.notify_all();
+}
+
+int SegmentedDownload::interruptCB(SegmentedDownload *segmentedDownload)
+{
+    return segmentedDownload->m_aborted;
+}
@@ -0,0 +1,85 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <IOController.hpp>
+
+#include <QString>
+
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+class SegmentedDownload final : public BasicIO
+{
+    struct Segment
+    {
+        qint64 begin;
+        qint64 end;
+        qint64 done;
+        bool claimed;
+    };
+
+public:
+    SegmentedDownload(const QString &url);
+    ~SegmentedDownload();
+
+    static QString stateFilePath(const QString &filePath);
+    static bool canResume(const QString &filePath, const QString &url);
+
+    bool open();
+
+    inline qint64 size() const
+    {
+        return m_size;
+    }
+
+    bool start(const QString &filePath, int maxSegments);
+    bool waitForFinished(int ms);
+
+    qint64 bytesDone() const;
+    bool isOk() const;
+
+    void saveState();
+
+    void abort() override;
+
+private:
+    bool loadState();
+
+    bool claimSegment(int &idx);
+    void downloadSegments();
+
+    static int interruptCB(SegmentedDownload *segmentedDownload);
+
+    const QString m_url;
+    QByteArray m_effectiveUrl;
+    QString m_filePath;
+    qint64 m_size = -1;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<Segment> m_segments;
+    std::vector<std::thread> m_threads;
+    int m_running = 0;
+    bool m_error = false;
+    std::atomic_bool m_aborted {false};
+};
@@ -63,6 +63,8 @@ Extensions::Extensions() :
     opensubtitles = QIcon(":/opensubtitles.svgz");
 #endif
 
+    init("Downloader/Segments", 4);
+
 #ifdef USE_YOUTUBE
     init("YouTube/ShowUserName", false);
     init("YouTube/Subtitles", true);
@@ -162,6 +164,7 @@ QMPLAY2_EXPORT_MODULE(Extensions)
 #include <QFileDialog>
 #include <QGroupBox>
 #include <QCheckBox>
+#include <QSpinBox>
 #include <QLabel>
 
 ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
@@ -174,6 +177,18 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
     MPRIS2B->setChecked(sets().getBool("MPRIS2/Enabled"));
 #endif
 
+    QGroupBox *downloaderB = new QGroupBox(tr("Downloader"));
+
+    m_downloaderSegments = new QSpinBox;
+    m_downloaderSegments->setRange(1, 16);
+    m_downloaderSegments->setToolTip(tr("Number of simultaneous connections used to download a single file, if the server supports it"));
+    m_downloaderSegments->setValue(sets().getInt("Downloader/Segments"));
+
+    layout = new QGridLayout(downloaderB);
+    layout->addWidget(new QLabel(tr("Connections per download") + ": "), 0, 0, 1, 1);
+    layout->addWidget(m_downloaderSegments, 0, 1, 1, 1);
+    layout->setContentsMargins(2, 2, 2, 2);
+
 #ifdef USE_YOUTUBE
     QGroupBox *youTubeB = new QGroupBox("YouTube");
 
@@ -255,6 +270,7 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
 #ifdef USE_MPRIS2
     mainLayout->addWidget(MPRIS2B);
 #endif
+    mainLayout->addWidget(downloaderB);
 #ifdef USE_YOUTUBE
     mainLayout->addWidget(youTubeB);
 #endif
@@ -281,6 +297,8 @@ void ModuleSettingsWidget::saveSettings()
     sets().set("MPRIS2/Enabled", MPRIS2B->isChecked());
 #endif
 
+    sets().set("Downloader/Segments", m_downloaderSegments->value());
+
 #ifdef USE_YOUTUBE
     sets().set("YouTube/ShowUserName", userNameB->isChecked());
     sets().set("YouTube/Subtitles", subtitlesB->isChecked());
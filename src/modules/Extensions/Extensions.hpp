@@ -52,6 +52,7 @@ class QListWidget;
 class QComboBox;
 class QGroupBox;
 class QCheckBox;
+class QSpinBox;
 class LineEdit;
 
 class ModuleSettingsWidget final : public Module::SettingsWidget
@@ -71,6 +72,8 @@ private:
     QCheckBox *MPRIS2B;
 #endif
 
+    QSpinBox *m_downloaderSegments;
+
 #ifdef USE_YOUTUBE
     QCheckBox *userNameB, *subtitlesB;
     QComboBox *m_preferredCodec, *qualityPreset;
@@ -39,6 +39,7 @@ LastFM::LastFM(Module &module) :
     firstTime(true)
 {
     SetModule(module);
+    coverNet.setUseCache(true); // Only for album info and covers, never for authenticated requests
     updateTim.setSingleShot(true);
     loginTimer.setSingleShot(true);
     connect(&updateTim, SIGNAL(timeout()), this, SLOT(processScrobbleQueue()));
@@ -103,7 +104,7 @@ void LastFM::getAlbumCover(const QString &title, const QString &artist, const QS
             disconnect(coverReply, SIGNAL(finished()), this, SLOT(albumFinished()));
             coverReply->deleteLater();
         }
-        coverReply = net.start(url);
+        coverReply = coverNet.start(url);
         coverReply->setProperty("taa", QStringList {
             titleAsAlbum ? album : title,
             artist,
@@ -301,7 +302,7 @@ void LastFM::albumFinished()
                         if (imgUrl.contains("noimage"))
                             continue;
                         coverReply->deleteLater();
-                        coverReply = net.start(imgUrl);
+                        coverReply = coverNet.start(imgUrl);
                         coverReply->setProperty("taa", taa);
                         coverReply->setProperty("origTitle", origTitle);
                         connect(coverReply, SIGNAL(finished()), this, SLOT(albumFinished()));
@@ -74,7 +74,7 @@ private:
     QString user, md5pass, session_key;
     QQueue<Scrobble> scrobbleQueue;
     QTimer updateTim, loginTimer;
-    NetworkAccess net;
+    NetworkAccess net, coverNet;
     QStringList imageSizes;
 };
 
@@ -54,6 +54,7 @@ Lyrics::Lyrics(Module &module) :
 
     connect(&QMPlay2Core, &QMPlay2CoreClass::updatePlaying,
             this, &Lyrics::updatePlaying);
+    m_net.setUseCache(true);
     connect(&m_net, SIGNAL(finished(NetworkReply *)), this, SLOT(finished(NetworkReply *)));
 
     m_dW = new DockWidget;
@@ -108,6 +108,8 @@ OpenSubtitles::OpenSubtitles(Module &module, const QIcon &icon)
     m_dw->setObjectName(OpenSubtitlesName);
     m_dw->setWidget(this);
 
+    m_net->setUseCache(true);
+
     auto completer = new QCompleter(m_searchEdit);
     completer->setModel(new QStringListModel(completer));
     completer->setCaseSensitivity(Qt::CaseInsensitive);
@@ -19,6 +19,7 @@
 #include <Radio/RadioBrowserModel.hpp>
 
 #include <NetworkAccess.hpp>
+#include <NetworkCache.hpp>
 #include <Functions.hpp>
 
 #include <QJsonDocument>
@@ -53,6 +54,7 @@ RadioBrowserModel::RadioBrowserModel(QWidget *widget) :
     m_sortOrder(Qt::AscendingOrder)
 {
     m_net->setRetries(g_nRetries, g_retryInterval);
+    m_net->setUseCache(true);
     connect(m_net, SIGNAL(finished(NetworkReply *)), this, SLOT(replyFinished(NetworkReply *)));
 }
 RadioBrowserModel::~RadioBrowserModel()
@@ -82,11 +84,23 @@ void RadioBrowserModel::searchRadios(const QString &text, const QString &searchB
 
 void RadioBrowserModel::loadIcons(const int first, const int last)
 {
+    bool iconsChanged = false;
     for (int i = first; i <= last; ++i)
     {
         Column *column = m_rowsToDisplay[i].get();
         if (!column->iconReply && !column->iconUrl.isEmpty())
         {
+            const QImage cachedIcon = NetworkCache::instance().findImage(getIconCacheKey(column->iconUrl));
+            if (!cachedIcon.isNull())
+            {
+                column->icon = QPixmap::fromImage(cachedIcon);
+                column->icon.setDevicePixelRatio(m_widget->devicePixelRatioF());
+                column->hasIcon = true;
+                column->iconUrl.clear();
+                iconsChanged = true;
+                continue;
+            }
+
             column->iconReply = m_net->start(column->iconUrl);
             for (const std::shared_ptr<Column> &c : std::as_const(m_rows))
             {
@@ -101,6 +115,13 @@ void RadioBrowserModel::loadIcons(const int first, const int last)
             column->iconUrl.clear();
         }
     }
+    if (iconsChanged)
+        emit dataChanged(QModelIndex(), QModelIndex());
+}
+
+QString RadioBrowserModel::getIconCacheKey(const QString &url) const
+{
+    return QString("%1@%2").arg(url).arg(qRound(elementHeight() * m_widget->devicePixelRatioF()));
 }
 
 QString RadioBrowserModel::getName(const QModelIndex &index) const
@@ -417,6 +438,9 @@ void RadioBrowserModel::replyFinished(NetworkReply *reply)
 
                         QPainter painter(&column->icon);
                         Functions::drawPixmap(painter, QPixmap::fromImage(image), m_widget, Qt::SmoothTransformation, Qt::KeepAspectRatio, {s, s});
+                        painter.end();
+
+                        NetworkCache::instance().insertImage(getIconCacheKey(reply->url()), column->icon.toImage());
 
                         icon = &column->icon;
                     }
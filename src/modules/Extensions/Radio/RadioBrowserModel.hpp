@@ -74,6 +74,9 @@ signals:
     void searchFinished();
     void connectionError();
 
+private:
+    QString getIconCacheKey(const QString &url) const;
+
 private:
     const QWidget *const m_widget;
 
@@ -20,6 +20,7 @@
 
 #include <YouTubeDL.hpp>
 #include <LineEdit.hpp>
+#include <NetworkCache.hpp>
 
 #include <QLoggingCategory>
 #include <QStringListModel>
@@ -251,6 +252,8 @@ YouTube::YouTube(Module &module) :
 
     completer->setCaseSensitivity(Qt::CaseInsensitive);
 
+    net.setUseCache(true);
+
     searchE = new LineEdit;
 #ifndef Q_OS_ANDROID
     connect(searchE, SIGNAL(textEdited(const QString &)), this, SLOT(searchTextEdited(const QString &)));
@@ -610,9 +613,12 @@ void YouTube::netFinished(NetworkReply *reply)
         }
         else if (imageReplies.contains(reply))
         {
-            QPixmap p;
-            if (p.loadFromData(replyData))
-                tWI->setIcon(0, p);
+            QImage img;
+            if (img.loadFromData(replyData))
+            {
+                NetworkCache::instance().insertImage(reply->url(), img);
+                tWI->setIcon(0, QPixmap::fromImage(img));
+            }
         }
     }
 
@@ -963,7 +969,12 @@ void YouTube::setSearchResults(const QJsonObject &jsonObj, bool isContinuation,
         tWI->setData(1, Qt::UserRole, !isVideo);
         tWI->setData(2, Qt::UserRole, contentId);
 
-        if (!thumbnail.isEmpty())
+        const QImage cachedThumbnail = !thumbnail.isEmpty() ? NetworkCache::instance().findImage(thumbnail) : QImage();
+        if (!cachedThumbnail.isNull())
+        {
+            tWI->setIcon(0, QPixmap::fromImage(cachedThumbnail));
+        }
+        else if (!thumbnail.isEmpty())
         {
             auto imageReply = net.start(thumbnail);
             imageReply->setProperty("tWI", QVariant::fromValue((void *)tWI));
@@ -23,6 +23,7 @@
 #include <Frame.hpp>
 #include <StreamInfo.hpp>
 #include <Functions.hpp>
+#include <Tracer.hpp>
 
 #ifdef USE_VULKAN
 #   include "../qmvk/MemoryPropertyFlags.hpp"
@@ -37,15 +38,30 @@
 #   include <vulkan/VulkanBufferPool.hpp>
 #endif
 
+#include <QThread>
+
 extern "C"
 {
     #include <libavformat/avformat.h>
     #include <libswscale/swscale.h>
     #include <libavutil/pixdesc.h>
+    #include <libavutil/opt.h>
 }
 
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+#   define SWS_SLICE_THREADS
+#endif
+
 using namespace std;
 
+#ifdef SWS_SLICE_THREADS
+constexpr int g_swsMinThreadedArea = 1280 * 720;
+constexpr int g_swsMaxThreads = 8;
+
+static void freeNothing(void *, uint8_t *)
+{}
+#endif
+
 Subtitle::Subtitle()
 {
     memset(av(), 0, sizeof(AVSubtitle));
@@ -335,19 +351,7 @@ int FFDecSW::decodeVideo(const Packet &encodedPacket, Frame &decoded, AVPixelFor
                 {
                     if (frame->width != lastFrameW || frame->height != lastFrameH || newFormat)
                     {
-                        sws_ctx = sws_getCachedContext(
-                            sws_ctx,
-                            frame->width,
-                            frame->height,
-                            codec_ctx->pix_fmt,
-                            frame->width,
-                            frame->height,
-                            static_cast<AVPixelFormat>(m_desiredPixFmt),
-                            SWS_BILINEAR,
-                            nullptr,
-                            nullptr,
-                            nullptr
-                        );
+                        setSwsContext(frame->width, frame->height);
                         lastFrameW = frame->width;
                         lastFrameH = frame->height;
                     }
@@ -365,20 +369,18 @@ int FFDecSW::decodeVideo(const Packet &encodedPacket, Frame &decoded, AVPixelFor
                     if (decoded.isEmpty())
                         decoded = Frame::createEmpty(frame, true, m_desiredPixFmt);
 
-                    quint8 *decodedData[] = {
-                        decoded.data(0),
-                        decoded.data(1),
-                        decoded.data(2),
-                    };
-                    sws_scale(
-                        sws_ctx,
-                        frame->data,
-                        frame->linesize,
-                        0,
-                        frame->height,
-                        decodedData,
-                        decoded.linesize()
-                    );
+                    Tracer::Span traceSpan("sws_scale", "decoder");
+                    if (Tracer::isEnabled())
+                    {
+                        traceSpan.setDetail(QString("%1 -> %2, %3x%4, %5 thread(s)")
+                            .arg(av_get_pix_fmt_name(codec_ctx->pix_fmt), av_get_pix_fmt_name(m_desiredPixFmt))
+                            .arg(frame->width)
+                            .arg(frame->height)
+                            .arg(m_swsThreads)
+                        );
+                    }
+
+                    swsScale(frame, decoded);
                 }
             }
         }
@@ -449,6 +451,9 @@ QList<QByteArray> FFDecSW::decodeSubtitle(const Packet &encodedPacket)
 
 bool FFDecSW::open(StreamInfo &streamInfo)
 {
+    Tracer::Span traceSpan("FFDecSW::open", "decoder");
+    traceSpan.setDetail(streamInfo.codec_name);
+
     AVCodec *codec = FFDec::init(streamInfo);
     if (!codec)
         return false;
@@ -637,6 +642,95 @@ void FFDecSW::setPixelFormat()
     }
 }
 
+void FFDecSW::setSwsContext(int w, int h)
+{
+    int threads = 1;
+#ifdef SWS_SLICE_THREADS
+    if (w * h >= g_swsMinThreadedArea)
+        threads = min(QThread::idealThreadCount(), g_swsMaxThreads);
+#endif
+
+    // "sws_getCachedContext()" doesn't compare the threads option
+    if (threads > 1 || m_swsThreads > 1)
+    {
+        sws_freeContext(sws_ctx);
+        sws_ctx = nullptr;
+    }
+    m_swsThreads = threads;
+
+#ifdef SWS_SLICE_THREADS
+    if (threads > 1)
+    {
+        sws_ctx = sws_alloc_context();
+        av_opt_set_int(sws_ctx, "srcw", w, 0);
+        av_opt_set_int(sws_ctx, "srch", h, 0);
+        av_opt_set_int(sws_ctx, "src_format", codec_ctx->pix_fmt, 0);
+        av_opt_set_int(sws_ctx, "dstw", w, 0);
+        av_opt_set_int(sws_ctx, "dsth", h, 0);
+        av_opt_set_int(sws_ctx, "dst_format", m_desiredPixFmt, 0);
+        av_opt_set_int(sws_ctx, "sws_flags", SWS_BILINEAR, 0);
+        av_opt_set_int(sws_ctx, "threads", threads, 0);
+        if (sws_init_context(sws_ctx, nullptr, nullptr) >= 0)
+            return;
+        sws_freeContext(sws_ctx);
+        sws_ctx = nullptr;
+        m_swsThreads = 1;
+    }
+#endif
+
+    sws_ctx = sws_getCachedContext(
+        sws_ctx,
+        w,
+        h,
+        codec_ctx->pix_fmt,
+        w,
+        h,
+        m_desiredPixFmt,
+        SWS_BILINEAR,
+        nullptr,
+        nullptr,
+        nullptr
+    );
+}
+void FFDecSW::swsScale(const AVFrame *frame, Frame &decoded)
+{
+#ifdef SWS_SLICE_THREADS
+    // "sws_scale()" uses only one thread, "sws_scale_frame()" requires reference counted frames
+    if (m_swsThreads > 1 && frame->buf[0])
+    {
+        AVFrame *dstFrame = av_frame_alloc();
+        dstFrame->width = frame->width;
+        dstFrame->height = frame->height;
+        dstFrame->format = m_desiredPixFmt;
+        for (int p = 0; p < min(decoded.numPlanes(), 3); ++p)
+        {
+            dstFrame->data[p] = decoded.data(p);
+            dstFrame->linesize[p] = decoded.linesize(p);
+        }
+        dstFrame->buf[0] = av_buffer_create(dstFrame->data[0], 1, freeNothing, nullptr, 0);
+        const int ret = sws_scale_frame(sws_ctx, dstFrame, frame);
+        av_frame_free(&dstFrame);
+        if (ret >= 0)
+            return;
+    }
+#endif
+
+    quint8 *decodedData[] = {
+        decoded.data(0),
+        decoded.data(1),
+        decoded.data(2),
+    };
+    sws_scale(
+        sws_ctx,
+        frame->data,
+        frame->linesize,
+        0,
+        frame->height,
+        decodedData,
+        decoded.linesize()
+    );
+}
+
 bool FFDecSW::getFromBitmapSubsBuffer(shared_ptr<QMPlay2OSD> &osd, double pos)
 {
     bool ret = true;
@@ -76,6 +76,9 @@ private:
 
     void setPixelFormat();
 
+    void setSwsContext(int w, int h);
+    void swsScale(const AVFrame *frame, Frame &decoded);
+
     bool getFromBitmapSubsBuffer(std::shared_ptr<QMPlay2OSD> &osd, double pts);
 
 #ifdef USE_VULKAN
@@ -92,6 +95,8 @@ private:
     bool m_teletextTransparent = false;
     SwsContext *sws_ctx;
 
+    int m_swsThreads = 1; // libswscale slice threads for large frames
+
     const AVPixFmtDescriptor *m_origPixDesc = nullptr;
     AVPixelFormat m_desiredPixFmt = AV_PIX_FMT_NONE;
     bool m_dontConvert = false;
@@ -57,6 +57,10 @@ bool FFDemux::set()
         restartPlayback = true;
     }
 
+    m_fastStart = sets().getBool("FastStartNetwork");
+    m_keyframeIndex = sets().getBool("KeyframeIndex");
+    m_keyframeIndexScan = sets().getBool("KeyframeIndexScan");
+
     return sets().getBool("DemuxerEnabled") && !restartPlayback;
 }
 
@@ -525,7 +529,7 @@ Playlist::Entries FFDemux::fetchTracks(const QString &url, bool &ok)
 
 void FFDemux::addFormatContext(QString url, const QString &param)
 {
-    FormatContext *fmtCtx = new FormatContext(m_reconnectNetwork, m_allowExperimental);
+    FormatContext *fmtCtx = new FormatContext(m_reconnectNetwork, m_allowExperimental, m_fastStart, m_keyframeIndex, m_keyframeIndexScan);
     {
         QMutexLocker mL(&mutex);
         formatContexts.append(fmtCtx);
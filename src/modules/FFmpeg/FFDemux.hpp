@@ -72,4 +72,7 @@ private:
     bool abortFetchTracks;
     bool m_reconnectNetwork;
     bool m_allowExperimental = false;
+    bool m_fastStart = true;
+    bool m_keyframeIndex = true;
+    bool m_keyframeIndexScan = false;
 };
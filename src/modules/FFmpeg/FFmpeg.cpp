@@ -78,6 +78,9 @@ FFmpeg::FFmpeg() :
     init("DemuxerEnabled", true);
     init("ReconnectNetwork", true);
     init("AllowExperimental", false);
+    init("FastStartNetwork", true);
+    init("KeyframeIndex", true);
+    init("KeyframeIndexScan", false);
     init("DecoderEnabled", true);
 #ifdef QMPlay2_VKVIDEO
     switch (QOperatingSystemVersion::currentType())
@@ -222,6 +225,11 @@ FFmpeg::SettingsWidget *FFmpeg::getSettingsWidget()
     return new ModuleSettingsWidget(*this, vkVideoSupported, dxva2Supported, d3d11vaSupported);
 }
 
+bool FFmpeg::canLoadOnDemand() const
+{
+    return false; // Hardware decoders availability and deinterlacing widget are set up in constructor
+}
+
 void FFmpeg::videoDeintSave()
 {
 #if defined(QMPlay2_VAAPI)
@@ -260,6 +268,18 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module, bool vkVideo, bool dx
     allowExperimentalB->setToolTip(tr("Useful for turning on HLS subtitles"));
     allowExperimentalB->setChecked(sets().getBool("AllowExperimental"));
 
+    fastStartNetworkB = new QCheckBox(tr("Fast start of network streams"));
+    fastStartNetworkB->setToolTip(tr("Analyze only the beginning of the stream, missing stream parameters are taken from the first decoded frames"));
+    fastStartNetworkB->setChecked(sets().getBool("FastStartNetwork"));
+
+    keyframeIndexB = new QCheckBox(tr("Remember key frame positions of local files without seek index"));
+    keyframeIndexB->setToolTip(tr("Speeds up seeking in e.g. MPEG-TS recordings, the positions are collected during playback"));
+    keyframeIndexB->setChecked(sets().getBool("KeyframeIndex"));
+
+    keyframeIndexScanB = new QCheckBox(tr("Scan the whole file for key frames in the background"));
+    keyframeIndexScanB->setChecked(sets().getBool("KeyframeIndexScan"));
+    keyframeIndexScanB->setEnabled(keyframeIndexB->isChecked());
+
     decoderB = new QGroupBox(tr("Software decoder"));
     decoderB->setCheckable(true);
     decoderB->setChecked(sets().getBool("DecoderEnabled"));
@@ -366,6 +386,9 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module, bool vkVideo, bool dx
     QFormLayout *demuxerLayout = new QFormLayout(demuxerB);
     demuxerLayout->addRow(nullptr, reconnectNetworkB);
     demuxerLayout->addRow(nullptr, allowExperimentalB);
+    demuxerLayout->addRow(nullptr, fastStartNetworkB);
+    demuxerLayout->addRow(nullptr, keyframeIndexB);
+    demuxerLayout->addRow(nullptr, keyframeIndexScanB);
 
     QFormLayout *decoderLayout = new QFormLayout(decoderB);
     decoderLayout->addRow(tr("Number of threads used to decode video") + ": ", threadsB);
@@ -378,6 +401,7 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module, bool vkVideo, bool dx
     decoderLayout->addRow(hurryUpB);
 
     connect(skipFramesB, SIGNAL(clicked(bool)), forceSkipFramesB, SLOT(setEnabled(bool)));
+    connect(keyframeIndexB, SIGNAL(clicked(bool)), keyframeIndexScanB, SLOT(setEnabled(bool)));
     if (hurryUpB->isChecked() || !skipFramesB->isChecked())
         forceSkipFramesB->setEnabled(skipFramesB->isChecked());
 
@@ -409,6 +433,9 @@ void ModuleSettingsWidget::saveSettings()
     sets().set("DemuxerEnabled", demuxerB->isChecked());
     sets().set("ReconnectNetwork", reconnectNetworkB->isChecked());
     sets().set("AllowExperimental", allowExperimentalB->isChecked());
+    sets().set("FastStartNetwork", fastStartNetworkB->isChecked());
+    sets().set("KeyframeIndex", keyframeIndexB->isChecked());
+    sets().set("KeyframeIndexScan", keyframeIndexScanB->isChecked());
     sets().set("DecoderEnabled", decoderB->isChecked());
     sets().set("HurryUP", hurryUpB ->isChecked());
     sets().set("SkipFrames", skipFramesB->isChecked());
@@ -38,6 +38,8 @@ private:
 
     void videoDeintSave() override;
 
+    bool canLoadOnDemand() const override;
+
     /**/
 
     QIcon demuxIcon;
@@ -81,6 +83,8 @@ private:
     QGroupBox *demuxerB;
     QCheckBox *reconnectNetworkB;
     QCheckBox *allowExperimentalB;
+    QCheckBox *fastStartNetworkB;
+    QCheckBox *keyframeIndexB, *keyframeIndexScanB;
     QGroupBox *hurryUpB;
     QCheckBox *skipFramesB, *forceSkipFramesB;
     QGroupBox *decoderB;
@@ -18,12 +18,14 @@
 
 #include <FFCommon.hpp>
 #include <FormatContext.hpp>
+#include <KeyframeIndex.hpp>
 
 #include <QMPlay2Core.hpp>
 #include <Functions.hpp>
 #include <OggHelper.hpp>
 #include <Settings.hpp>
 #include <Packet.hpp>
+#include <Tracer.hpp>
 
 #ifdef Q_OS_ANDROID
 #   include <QFile>
@@ -40,6 +42,10 @@ extern "C"
     #include <libavutil/pixdesc.h>
 }
 
+// Fast start of network streams
+constexpr int64_t g_fastStartProbeSize = 256 * 1024;
+constexpr int64_t g_fastStartAnalyzeDuration = AV_TIME_BASE / 2;
+
 #ifdef Q_OS_ANDROID
 static int readPacketQFile(void *opaque, uint8_t *buf, int bufSize)
 {
@@ -228,6 +234,7 @@ public:
 private:
     void run() override
     {
+        Tracer::Span traceSpan("avformat_open_input", "demuxer");
         avformat_open_input(&m_formatCtx, m_url, m_inputFmt, &m_options);
         if (!wakeIfNotAborted() && m_formatCtx)
             avformat_close_input(&m_formatCtx);
@@ -236,7 +243,7 @@ private:
 
 /**/
 
-FormatContext::FormatContext(bool reconnectNetwork, bool allowExperimental) :
+FormatContext::FormatContext(bool reconnectNetwork, bool allowExperimental, bool fastStart, bool keyframeIndex, bool keyframeIndexScan) :
     isError(false),
     currPos(0.0),
     abortCtx(new AbortContext),
@@ -245,6 +252,9 @@ FormatContext::FormatContext(bool reconnectNetwork, bool allowExperimental) :
     oggHelper(nullptr),
     m_reconnectNetwork(reconnectNetwork),
     m_allowExperimental(allowExperimental),
+    m_fastStart(fastStart),
+    m_useKeyframeIndex(keyframeIndex),
+    m_keyframeIndexScan(keyframeIndexScan),
     isPaused(false), fixMkvAss(false),
     isMetadataChanged(false),
     lastTime(0.0),
@@ -521,7 +531,14 @@ bool FormatContext::seek(double pos, bool backward)
         const double posToSeek = pos + startTime;
         const qint64 timestamp = ((streamsInfo.count() == 1) ? posToSeek : (backward ? floor(posToSeek) : ceil(posToSeek))) * AV_TIME_BASE;
 
-        isOk = av_seek_frame(formatCtx, -1, timestamp, backward ? AVSEEK_FLAG_BACKWARD : 0) >= 0;
+        m_lastKeyFrameTs = qQNaN();
+
+        // Direct byte seek to the known key frame instead of the bisection over the file
+        qint64 keyFramePos = -1;
+        if (m_keyframeIndex && m_keyframeIndex->find(posToSeek, backward, keyFramePos))
+            isOk = av_seek_frame(formatCtx, -1, keyFramePos, AVSEEK_FLAG_BYTE) >= 0;
+        if (!isOk)
+            isOk = av_seek_frame(formatCtx, -1, timestamp, backward ? AVSEEK_FLAG_BACKWARD : 0) >= 0;
         if (!isOk)
         {
             const int ret = av_read_frame(formatCtx, packet);
@@ -589,6 +606,7 @@ bool FormatContext::read(Packet &encoded, int &idx)
 
     if (ret == AVERROR_INVALIDDATA || ret == AVERROR_EXIT)
     {
+        m_lastKeyFrameTs = qQNaN();
         if (m_retErrCount < 1000)
         {
             ++m_retErrCount;
@@ -608,6 +626,8 @@ bool FormatContext::read(Packet &encoded, int &idx)
     }
     else if (ret)
     {
+        if (ret == AVERROR_EOF && m_keyframeIndex)
+            m_keyframeIndex->setEndOfFile(m_lastKeyFrameTs);
         isError = true;
         return false;
     }
@@ -621,6 +641,9 @@ bool FormatContext::read(Packet &encoded, int &idx)
 
     const auto stream = streams.at(ff_idx);
 
+    if (m_keyframeIndex)
+        m_keyframeIndex->addKeyFrame(stream, packet, m_lastKeyFrameTs);
+
     if (stream->event_flags & AVSTREAM_EVENT_FLAG_METADATA_UPDATED)
     {
         stream->event_flags = 0;
@@ -696,6 +719,9 @@ bool FormatContext::open(const QString &_url, const QString &param)
         "vplayer",
     };
 
+    Tracer::Span traceSpan("FormatContext::open", "demuxer");
+    traceSpan.setDetail(_url);
+
     const QByteArray scheme = Functions::getUrlScheme(_url).toUtf8();
     if (scheme.isEmpty() || scheme == "sftp")
         return false;
@@ -840,14 +866,26 @@ bool FormatContext::open(const QString &_url, const QString &param)
         formatCtx->flags |= AVFMT_FLAG_FAST_SEEK; //This should be set before "avformat_open_input", but seems to be working for MP3...
     }
 
+    // Analyze only the beginning of network streams. Parameters which are still missing (e.g. audio sample
+    // rate or video size) are taken from the first decoded frames, like when they change during playback.
+    const bool fastStart = (m_fastStart && !isLocal && !stillImage);
+    if (fastStart)
+    {
+        formatCtx->probesize = qMin<int64_t>(formatCtx->probesize, g_fastStartProbeSize);
+        formatCtx->max_analyze_duration = g_fastStartAnalyzeDuration;
+    }
+
     if (name() == "mpegts")
     {
         // Workaround to detect initial audio parameters for some TS files
         formatCtx->probesize *= 2;
     }
 
-    if (avformat_find_stream_info(formatCtx, nullptr) < 0)
-        return false;
+    {
+        Tracer::Span traceSpan("avformat_find_stream_info", "demuxer");
+        if (avformat_find_stream_info(formatCtx, nullptr) < 0)
+            return false;
+    }
 
     // Determine the duration of WavPack if not known
     if (isLocal && formatCtx->nb_streams == 1 && formatCtx->duration == AV_NOPTS_VALUE)
@@ -1006,6 +1044,22 @@ bool FormatContext::open(const QString &_url, const QString &param)
         }
     }
 
+    // Own key frame index for containers without a seek index (e.g. MPEG-TS, raw streams, Matroska without cues)
+    if (m_useKeyframeIndex && scheme == "file" && !isStreamed && !stillImage && !oggHelper && !(formatCtx->iformat->flags & AVFMT_NO_BYTE_SEEK))
+    {
+        const int streamIdx = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (streamIdx >= 0)
+        {
+            const AVStream *stream = streams.at(streamIdx);
+            if (!(stream->disposition & AV_DISPOSITION_ATTACHED_PIC) && (indexEntriesCount(stream) == 0 || (formatCtx->iformat->flags & AVFMT_GENERIC_INDEX)))
+            {
+                m_keyframeIndex = std::make_unique<KeyframeIndex>(url, streamIdx);
+                if (m_keyframeIndexScan)
+                    m_keyframeIndex->startScan(url.toUtf8());
+            }
+        }
+    }
+
     formatCtx->event_flags = 0;
 
     packet = av_packet_alloc();
@@ -1026,6 +1080,7 @@ void FormatContext::setStreamOffset(double offset)
 void FormatContext::selectStreams(const QSet<int> &selectedStreams)
 {
     m_allDiscarded = true;
+    m_lastKeyFrameTs = qQNaN();
     for (AVStream *stream : std::as_const(streams))
     {
         if (stream->codecpar->codec_type == AVMEDIA_TYPE_DATA || stream->codecpar->codec_type == AVMEDIA_TYPE_ATTACHMENT)
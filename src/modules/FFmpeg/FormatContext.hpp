@@ -25,6 +25,8 @@
 
 #include <QCoreApplication>
 
+#include <memory>
+
 extern "C"
 {
     #include <libavformat/version.h>
@@ -34,6 +36,7 @@ struct AVFormatContext;
 struct AVDictionary;
 struct AVStream;
 struct AVPacket;
+class KeyframeIndex;
 class OggHelper;
 class Packet;
 #ifdef Q_OS_ANDROID
@@ -44,7 +47,7 @@ class FormatContext
 {
     Q_DECLARE_TR_FUNCTIONS(FormatContext)
 public:
-    FormatContext(bool reconnectNetwork = false, bool allowExperimental = false);
+    FormatContext(bool reconnectNetwork = false, bool allowExperimental = false, bool fastStart = false, bool keyframeIndex = false, bool keyframeIndexScan = false);
     ~FormatContext();
 
     bool metadataChanged() const;
@@ -93,8 +96,14 @@ private:
 
     OggHelper *oggHelper;
 
+    std::unique_ptr<KeyframeIndex> m_keyframeIndex;
+    double m_lastKeyFrameTs = qQNaN();
+
     const bool m_reconnectNetwork;
     const bool m_allowExperimental;
+    const bool m_fastStart;
+    const bool m_useKeyframeIndex;
+    const bool m_keyframeIndexScan;
     bool isPaused, fixMkvAss;
     mutable bool isMetadataChanged;
     double lastTime, startTime;
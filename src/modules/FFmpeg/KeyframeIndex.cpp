@@ -0,0 +1,318 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <KeyframeIndex.hpp>
+
+#include <QMPlay2Core.hpp>
+#include <Functions.hpp>
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QThread>
+#include <QDir>
+
+#include <algorithm>
+#include <atomic>
+
+extern "C"
+{
+    #include <libavformat/avformat.h>
+}
+
+constexpr quint32 g_magic = 0x514B4931; // "QKI1"
+constexpr qint64 g_maxCacheSize = 16 * 1024 * 1024;
+constexpr qint64 g_scanMaxBytesPerSecond = 32 * 1024 * 1024;
+
+static inline bool sameTs(double a, double b)
+{
+    return qAbs(a - b) < 1e-6;
+}
+
+static int scanInterruptCB(void *opaque)
+{
+    return static_cast<std::atomic_bool *>(opaque)->load();
+}
+
+/**/
+
+class KeyframeIndex::Scanner final : public QThread
+{
+public:
+    Scanner(KeyframeIndex &index, const QByteArray &url)
+        : m_index(index)
+        , m_url(url)
+    {
+        setObjectName("KeyframeIndex");
+        start(QThread::LowestPriority);
+    }
+    ~Scanner()
+    {
+        m_abort = true;
+        wait();
+    }
+
+private:
+    void run() override
+    {
+        AVFormatContext *formatCtx = avformat_alloc_context();
+        formatCtx->interrupt_callback.callback = scanInterruptCB;
+        formatCtx->interrupt_callback.opaque = &m_abort;
+        if (avformat_open_input(&formatCtx, m_url.constData(), nullptr, nullptr) != 0)
+            return;
+
+        const int streamIdx = m_index.streamIndex();
+        if (avformat_find_stream_info(formatCtx, nullptr) >= 0 && streamIdx < static_cast<int>(formatCtx->nb_streams))
+        {
+            for (unsigned i = 0; i < formatCtx->nb_streams; ++i)
+                formatCtx->streams[i]->discard = (static_cast<int>(i) == streamIdx) ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+
+            const AVStream *stream = formatCtx->streams[streamIdx];
+            AVPacket *packet = av_packet_alloc();
+            double prevTs = qQNaN();
+            bool eof = false;
+
+            QElapsedTimer timer;
+            timer.start();
+            while (!m_abort)
+            {
+                const int ret = av_read_frame(formatCtx, packet);
+                if (ret == AVERROR_EOF)
+                {
+                    eof = true;
+                    break;
+                }
+                if (ret == AVERROR_INVALIDDATA)
+                {
+                    prevTs = qQNaN();
+                    continue;
+                }
+                if (ret < 0)
+                    break;
+
+                m_index.addKeyFrame(stream, packet, prevTs);
+                av_packet_unref(packet);
+
+                // Don't take the whole disk bandwidth from the playback
+                if (formatCtx->pb)
+                {
+                    const qint64 aheadMs = formatCtx->pb->bytes_read * 1000 / g_scanMaxBytesPerSecond - timer.elapsed();
+                    if (aheadMs > 0)
+                        msleep(qMin<qint64>(aheadMs, 100));
+                }
+            }
+            av_packet_free(&packet);
+
+            if (eof)
+            {
+                m_index.setEndOfFile(prevTs);
+                m_index.save();
+            }
+        }
+
+        avformat_close_input(&formatCtx);
+    }
+
+    KeyframeIndex &m_index;
+    const QByteArray m_url;
+    std::atomic_bool m_abort {false};
+};
+
+/**/
+
+KeyframeIndex::KeyframeIndex(const QString &filePath, int streamIdx)
+    : m_streamIdx(streamIdx)
+{
+    const QFileInfo fileInfo(filePath);
+    const QByteArray key = filePath.toUtf8() + '\n' + QByteArray::number(fileInfo.size()) + '\n' + QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()) + '\n' + QByteArray::number(streamIdx);
+    m_cacheFilePath = QMPlay2Core.getSettingsDir() + "KeyframeIndex/" + QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+    load();
+}
+KeyframeIndex::~KeyframeIndex()
+{
+    m_scanner.reset();
+    save();
+}
+
+void KeyframeIndex::startScan(const QByteArray &url)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        const bool complete = !m_entries.empty() && std::all_of(m_entries.begin(), m_entries.end(), [](const Entry &entry) {
+            return entry.linked;
+        });
+        if (complete)
+            return;
+    }
+    m_scanner = std::make_unique<Scanner>(*this, url);
+}
+
+void KeyframeIndex::addKeyFrame(const AVStream *stream, const AVPacket *packet, double &prevTs)
+{
+    if (stream->index != m_streamIdx || !(packet->flags & AV_PKT_FLAG_KEY))
+        return;
+
+    const int64_t pts = (packet->pts != AV_NOPTS_VALUE) ? packet->pts : packet->dts;
+    if (pts == AV_NOPTS_VALUE || packet->pos < 0)
+    {
+        prevTs = qQNaN();
+        return;
+    }
+
+    const double ts = pts * av_q2d(stream->time_base);
+
+    QMutexLocker locker(&m_mutex);
+
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), ts, [](const Entry &entry, double ts) {
+        return entry.ts < ts;
+    });
+    if (it == m_entries.end() || !sameTs(it->ts, ts))
+    {
+        // A new key frame between linked entries means the link was wrong
+        if (it != m_entries.begin())
+            (it - 1)->linked = false;
+        it = m_entries.insert(it, {ts, packet->pos, false});
+        m_modified = true;
+    }
+
+    if (!qIsNaN(prevTs) && it != m_entries.begin())
+    {
+        auto prev = it - 1;
+        if (!prev->linked && sameTs(prev->ts, prevTs))
+        {
+            prev->linked = true;
+            m_modified = true;
+        }
+    }
+
+    prevTs = ts;
+}
+void KeyframeIndex::setEndOfFile(double prevTs)
+{
+    if (qIsNaN(prevTs))
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_entries.empty() && !m_entries.back().linked && sameTs(m_entries.back().ts, prevTs))
+    {
+        m_entries.back().linked = true;
+        m_modified = true;
+    }
+}
+
+bool KeyframeIndex::find(double ts, bool backward, qint64 &pos) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    const auto it = std::upper_bound(m_entries.begin(), m_entries.end(), ts, [](double ts, const Entry &entry) {
+        return ts < entry.ts;
+    });
+    if (it == m_entries.begin())
+        return false;
+
+    // The nearest key frame before "ts" is known only if nothing was skipped after it
+    const auto prev = it - 1;
+    if (!prev->linked)
+        return false;
+
+    if (backward || sameTs(prev->ts, ts))
+    {
+        pos = prev->pos;
+        return true;
+    }
+
+    if (it == m_entries.end())
+        return false;
+
+    pos = it->pos;
+    return true;
+}
+
+void KeyframeIndex::load()
+{
+    QFile f(m_cacheFilePath);
+    if (!f.open(QFile::ReadOnly))
+        return;
+
+    QDataStream stream(&f);
+    quint32 magic = 0;
+    qint32 count = 0;
+    stream >> magic;
+    if (magic != g_magic)
+        return;
+    stream >> count;
+    if (stream.status() != QDataStream::Ok || count <= 0)
+        return;
+
+    std::vector<Entry> entries(count);
+    for (auto &&entry : entries)
+    {
+        stream >> entry.ts >> entry.pos >> entry.linked;
+        if (stream.status() != QDataStream::Ok)
+            return;
+    }
+    const bool sorted = std::is_sorted(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.ts < b.ts;
+    });
+    if (!sorted)
+        return;
+
+    // Modification time is used for LRU eviction
+    f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    QMutexLocker locker(&m_mutex);
+    m_entries = std::move(entries);
+}
+void KeyframeIndex::save()
+{
+    std::vector<Entry> entries;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_modified)
+            return;
+        entries = m_entries;
+        m_modified = false;
+    }
+
+    const QString dir = Functions::filePath(m_cacheFilePath);
+    if (!QDir().mkpath(dir))
+        return;
+
+    QSaveFile f(m_cacheFilePath);
+    if (!f.open(QFile::WriteOnly))
+        return;
+
+    QDataStream stream(&f);
+    stream << g_magic << static_cast<qint32>(entries.size());
+    for (auto &&entry : std::as_const(entries))
+        stream << entry.ts << entry.pos << entry.linked;
+    if (stream.status() != QDataStream::Ok || !f.commit())
+        return;
+
+    // Keep the most recently used files
+    qint64 size = 0;
+    for (const QFileInfo &fileInfo : QDir(dir).entryInfoList(QDir::Files, QDir::Time))
+    {
+        size += fileInfo.size();
+        if (size > g_maxCacheSize)
+            QFile::remove(fileInfo.filePath());
+    }
+}
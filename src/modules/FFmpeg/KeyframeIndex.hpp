@@ -0,0 +1,71 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QString>
+#include <QMutex>
+
+#include <memory>
+#include <vector>
+
+struct AVStream;
+struct AVPacket;
+
+/* Key frame positions (timestamp -> byte offset) for local files without a seek index */
+class KeyframeIndex
+{
+public:
+    KeyframeIndex(const QString &filePath, int streamIdx);
+    ~KeyframeIndex();
+
+    inline int streamIndex() const
+    {
+        return m_streamIdx;
+    }
+
+    void startScan(const QByteArray &url);
+
+    // "prevTs" is the previous key frame timestamp of sequential reading, "NaN" after seek or error
+    void addKeyFrame(const AVStream *stream, const AVPacket *packet, double &prevTs);
+    void setEndOfFile(double prevTs);
+
+    bool find(double ts, bool backward, qint64 &pos) const;
+
+private:
+    class Scanner;
+
+    struct Entry
+    {
+        double ts;
+        qint64 pos;
+        bool linked; // No key frame between this and the next entry (or the end of file)
+    };
+
+    void load();
+    void save();
+
+    const int m_streamIdx;
+    QString m_cacheFilePath;
+
+    mutable QMutex m_mutex;
+    std::vector<Entry> m_entries;
+    bool m_modified = false;
+
+    std::unique_ptr<Scanner> m_scanner;
+};
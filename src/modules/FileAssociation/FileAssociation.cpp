@@ -58,6 +58,11 @@ FileAssociation::SettingsWidget *FileAssociation::getSettingsWidget()
     return new ModuleSettingsWidget(*this);
 }
 
+bool FileAssociation::canLoadOnDemand() const
+{
+    return false; // First run file association is triggered from constructor
+}
+
 void FileAssociation::firsttime()
 {
     if (QMessageBox::question(NULL, tr("File association"), tr("Do you want to associate files with QMPlay2"), QMessageBox::Yes, QMessageBox::No) == QMessageBox::Yes)
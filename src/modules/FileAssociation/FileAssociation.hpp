@@ -31,6 +31,8 @@ private:
 
     SettingsWidget *getSettingsWidget() override;
 
+    bool canLoadOnDemand() const override;
+
     bool reallyFirsttime;
 private slots:
     void firsttime();
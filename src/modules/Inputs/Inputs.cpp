@@ -49,6 +49,8 @@ Inputs::Inputs() :
 
     init("ToneGenerator/srate", 48000);
     init("ToneGenerator/freqs", 440);
+    init("ToneGenerator/mode", static_cast<int>(ToneGenerator::Sine));
+    init("ToneGenerator/period", 1000);
     init("PCM", true);
     if (getStringList("PCM/extensions").isEmpty())
         set("PCM/extensions", QString(g_standartExts).split(';'));
@@ -59,6 +61,7 @@ Inputs::Inputs() :
     init("PCM/offset", static_cast<int>(0));
     init("PCM/BE", false);
     init("Rayman2", true);
+    init("PacketDuration", 50);
 }
 
 QList<Inputs::Info> Inputs::getModulesInfo(const bool showDisabled) const
@@ -68,7 +71,11 @@ QList<Inputs::Info> Inputs::getModulesInfo(const bool showDisabled) const
     if (showDisabled || getBool("PCM"))
         modulesInfo += Info(PCMName, DEMUXER, getStringList("PCM/extensions"), pcmIcon);
     if (showDisabled || getBool("Rayman2"))
-        modulesInfo += Info(Rayman2Name, DEMUXER, QStringList{"apm"}, rayman2Icon);
+    {
+        Info rayman2Info(Rayman2Name, DEMUXER, QStringList{"apm"}, rayman2Icon);
+        rayman2Info.magic = {{"apm", 0x14, "vs12"}};
+        modulesInfo += rayman2Info;
+    }
     return modulesInfo;
 }
 void *Inputs::createInstance(const QString &name)
@@ -96,6 +103,11 @@ Inputs::SettingsWidget *Inputs::getSettingsWidget()
     return new ModuleSettingsWidget(*this);
 }
 
+bool Inputs::canLoadOnDemand() const
+{
+    return false; // Has add actions
+}
+
 void Inputs::add()
 {
     AddD d(*this, QMPlay2Core.getMainWindow());
@@ -161,6 +173,20 @@ AddD::AddD(Settings &sets, QWidget *parent, QObject *moduleSetsW) :
     srateB->setSuffix(" Hz");
     srateB->setValue(sets.getInt("ToneGenerator/srate"));
 
+    QLabel *modeL = new QLabel(tr("Mode") + ": ");
+
+    modeB = new QComboBox;
+    modeB->addItems({tr("Sine"), tr("Sweep"), tr("Impulse")});
+    modeB->setCurrentIndex(qBound(0, sets.getInt("ToneGenerator/mode"), ToneGenerator::MODE_COUNT - 1));
+    modeB->setToolTip(tr("Sweep goes exponentially from 20 Hz to the channel frequency, impulse is a single full-scale sample on all channels"));
+
+    QLabel *periodL = new QLabel(tr("Sweep duration / impulse interval") + ": ");
+
+    periodB = new QSpinBox;
+    periodB->setRange(1, 600000);
+    periodB->setSuffix(" " + tr("ms"));
+    periodB->setValue(sets.getInt("ToneGenerator/period"));
+
     QDialogButtonBox *bb = nullptr;
     QPushButton *addB = nullptr;
     if (parent)
@@ -181,11 +207,15 @@ AddD::AddD(Settings &sets, QWidget *parent, QObject *moduleSetsW) :
     layout->addWidget(channelsB, 0, 1, 1, 1);
     layout->addWidget(srateL, 1, 0, 1, 1);
     layout->addWidget(srateB, 1, 1, 1, 1);
+    layout->addWidget(modeL, 3, 0, 1, 1);
+    layout->addWidget(modeB, 3, 1, 1, 1);
+    layout->addWidget(periodL, 4, 0, 1, 1);
+    layout->addWidget(periodB, 4, 1, 1, 1);
     if (parent)
-        layout->addWidget(bb, 3, 0, 1, 2);
+        layout->addWidget(bb, 5, 0, 1, 2);
     else
     {
-        layout->addWidget(addB, 3, 0, 1, 2);
+        layout->addWidget(addB, 5, 0, 1, 2);
         QGridLayout *layout = new QGridLayout(this);
         layout->setContentsMargins(0, 0, 0, 0);
         layout->addWidget(gB);
@@ -199,12 +229,14 @@ void AddD::save()
 {
     sets.set("ToneGenerator/srate", getSampleRate());
     sets.set("ToneGenerator/freqs", getFreqs());
+    sets.set("ToneGenerator/mode", modeB->currentIndex());
+    sets.set("ToneGenerator/period", periodB->value());
 }
 
 QString AddD::execAndGet()
 {
     if (exec() == QDialog::Accepted)
-        return "{samplerate=" + QString::number(getSampleRate()) + "&freqs=" + getFreqs() + "}";
+        return "{samplerate=" + QString::number(getSampleRate()) + "&freqs=" + getFreqs() + "&mode=" + ToneGenerator::modeName(modeB->currentIndex()) + "&period=" + QString::number(periodB->value()) + "}";
     return QString();
 }
 
@@ -297,10 +329,19 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
     rayman2EB = new QCheckBox(tr("Rayman2 music (*.apm)"));
     rayman2EB->setChecked(sets().getBool("Rayman2"));
 
+    QLabel *packetDurationL = new QLabel(tr("Packet duration") + ": ");
+
+    packetDurationB = new QSpinBox;
+    packetDurationB->setSuffix(" " + tr("ms"));
+    packetDurationB->setRange(5, 1000);
+    packetDurationB->setValue(sets().getInt("PacketDuration"));
+
     QGridLayout *layout = new QGridLayout(this);
-    layout->addWidget(toneGenerator);
-    layout->addWidget(pcmB);
-    layout->addWidget(rayman2EB);
+    layout->addWidget(toneGenerator, 0, 0, 1, 2);
+    layout->addWidget(pcmB, 1, 0, 1, 2);
+    layout->addWidget(rayman2EB, 2, 0, 1, 2);
+    layout->addWidget(packetDurationL, 3, 0, 1, 1);
+    layout->addWidget(packetDurationB, 3, 1, 1, 1);
 }
 
 void ModuleSettingsWidget::applyFreqs()
@@ -327,4 +368,5 @@ void ModuleSettingsWidget::saveSettings()
     sets().set("PCM/offset", offsetB->value());
     sets().set("PCM/BE", (bool)endianB->currentIndex());
     sets().set("Rayman2", rayman2EB->isChecked());
+    sets().set("PacketDuration", packetDurationB->value());
 }
@@ -33,6 +33,8 @@ private:
 
     SettingsWidget *getSettingsWidget() override;
 
+    bool canLoadOnDemand() const override;
+
     QIcon toneIcon, pcmIcon, rayman2Icon;
 private slots:
     void add();
@@ -59,6 +61,7 @@ private:
 };
 
 class QGridLayout;
+class QComboBox;
 
 class AddD final : public QDialog
 {
@@ -85,12 +88,13 @@ private:
     QObject *moduleSetsW;
     QGridLayout *layout;
     QSpinBox *srateB;
+    QComboBox *modeB;
+    QSpinBox *periodB;
     Settings &sets;
     HzW *hzW;
 };
 
 class QRadioButton;
-class QComboBox;
 class QGroupBox;
 class QCheckBox;
 class QLineEdit;
@@ -113,4 +117,6 @@ private:
     QComboBox *endianB;
 
     QCheckBox *rayman2EB;
+
+    QSpinBox *packetDurationB;
 };
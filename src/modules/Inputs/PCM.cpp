@@ -18,10 +18,13 @@
 
 #include <PCM.hpp>
 
-#include <ByteArray.hpp>
 #include <Packet.hpp>
 #include <Reader.hpp>
 
+#include <QtEndian>
+
+#include <cstring>
+
 /**/
 
 constexpr quint8 bytes[PCM::FORMAT_COUNT] =
@@ -29,6 +32,60 @@ constexpr quint8 bytes[PCM::FORMAT_COUNT] =
     1, 1, 2, 3, 4, 4
 };
 
+/*
+ * One plain loop per format over the raw bytes. The packed 24-bit samples
+ * (stride 3) are composed byte by byte and stay scalar.
+ */
+
+template<typename T, bool bigEndian>
+static inline T load(const uchar *src)
+{
+    return bigEndian ? qFromBigEndian<T>(src) : qFromLittleEndian<T>(src);
+}
+
+template<bool bigEndian>
+static void convert(PCM::FORMAT fmt, const uchar *src, float *dst, const int count)
+{
+    switch (fmt)
+    {
+        case PCM::PCM_U8:
+            for (int i = 0; i < count; ++i)
+                dst[i] = (src[i] - 0x7F) * (1.0f / 128.0f);
+            break;
+        case PCM::PCM_S8:
+            for (int i = 0; i < count; ++i)
+                dst[i] = static_cast<qint8>(src[i]) * (1.0f / 128.0f);
+            break;
+        case PCM::PCM_S16:
+            for (int i = 0; i < count; ++i)
+                dst[i] = load<qint16, bigEndian>(src + i * 2) * (1.0f / 32768.0f);
+            break;
+        case PCM::PCM_S24:
+            for (int i = 0; i < count; ++i)
+            {
+                const uchar *sample = src + i * 3;
+                const quint32 value = bigEndian
+                    ? (quint32(sample[0]) << 24 | sample[1] << 16 | sample[2] << 8)
+                    : (quint32(sample[2]) << 24 | sample[1] << 16 | sample[0] << 8);
+                dst[i] = static_cast<qint32>(value) * (1.0f / 2147483648.0f);
+            }
+            break;
+        case PCM::PCM_S32:
+            for (int i = 0; i < count; ++i)
+                dst[i] = load<qint32, bigEndian>(src + i * 4) * (1.0f / 2147483648.0f);
+            break;
+        case PCM::PCM_FLT:
+            for (int i = 0; i < count; ++i)
+            {
+                const quint32 value = load<quint32, bigEndian>(src + i * 4);
+                memcpy(dst + i, &value, sizeof(float));
+            }
+            break;
+        default:
+            break;
+    }
+}
+
 /**/
 
 PCM::PCM(Module &module)
@@ -47,6 +104,7 @@ bool PCM::set()
         return false;
 
     bigEndian = sets().getBool("PCM/BE");
+    packetDuration = sets().getInt("PacketDuration");
     if (!reader)
     {
         fmt = format;
@@ -87,40 +145,16 @@ bool PCM::read(Packet &decoded, int &idx)
 
     decoded.setTS((reader->pos() - offset) / (double)bytes[fmt] / chn / srate);
 
-    const QByteArray dataBA = reader->read(chn * bytes[fmt] * 256);
+    const int frames = qMax<qint64>(1, static_cast<qint64>(srate) * packetDuration / 1000);
+    const QByteArray dataBA = reader->read(chn * bytes[fmt] * frames);
     const int samples_with_channels = dataBA.size() / bytes[fmt];
     decoded.resize(samples_with_channels * sizeof(float));
     float *decoded_data = (float *)decoded.data();
-    ByteArray data(dataBA.constData(), dataBA.size(), bigEndian);
-    switch (fmt)
-    {
-        case PCM_U8:
-            for (int i = 0; i < samples_with_channels; i++)
-                decoded_data[i] = (data.getBYTE() - 0x7F) / 128.0f;
-            break;
-        case PCM_S8:
-            for (int i = 0; i < samples_with_channels; i++)
-                decoded_data[i] = (qint8)data.getBYTE() / 128.0f;
-            break;
-        case PCM_S16:
-            for (int i = 0; i < samples_with_channels; i++)
-                decoded_data[i] = (qint16)data.getWORD() / 32768.0f;
-            break;
-        case PCM_S24:
-            for (int i = 0; i < samples_with_channels; i++)
-                decoded_data[i] = (qint32)data.get24bAs32b() / 2147483648.0f;
-            break;
-        case PCM_S32:
-            for (int i = 0; i < samples_with_channels; i++)
-                decoded_data[i] = (qint32)data.getDWORD() / 2147483648.0f;
-            break;
-        case PCM_FLT:
-            for (int i = 0; i < samples_with_channels; i++)
-                decoded_data[i] = data.getFloat();
-            break;
-        default:
-            break;
-    }
+    const uchar *data = (const uchar *)dataBA.constData();
+    if (bigEndian)
+        convert<true>(fmt, data, decoded_data, samples_with_channels);
+    else
+        convert<false>(fmt, data, decoded_data, samples_with_channels);
 
     idx = 0;
     decoded.setDuration(decoded.size() / chn / sizeof(float) / (double)srate);
@@ -52,6 +52,7 @@ private:
     FORMAT fmt;
     unsigned char chn;
     int srate, offset;
+    int packetDuration;
     bool bigEndian;
 };
 
@@ -22,10 +22,18 @@
 #include <Packet.hpp>
 #include <Reader.hpp>
 
+#include <array>
+
 /**/
 
-static float decode(unsigned char nibble, short &stepIndex, int &predictor)
+struct AdpcmEntry
 {
+    int diff;
+    qint8 nextStepIndex;
+};
+
+// Difference and next step index for every step index and nibble
+static constexpr auto g_adpcmTable = [] {
     constexpr quint16 ima_step_table[89] =
     {
         7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
@@ -40,31 +48,47 @@ static float decode(unsigned char nibble, short &stepIndex, int &predictor)
     };
     constexpr qint8 ima_index_table[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
 
-    const int step = ima_step_table[stepIndex];
-    int diff = step >> 3;
+    std::array<AdpcmEntry, 89 * 16> table {};
+    for (int stepIndex = 0; stepIndex < 89; ++stepIndex)
+    {
+        const int step = ima_step_table[stepIndex];
+        for (int nibble = 0; nibble < 16; ++nibble)
+        {
+            int diff = step >> 3;
+            if (nibble & 1)
+                diff += step >> 2;
+            if (nibble & 2)
+                diff += step >> 1;
+            if (nibble & 4)
+                diff += step;
+            if (nibble & 8)
+                diff = -diff;
+
+            int nextStepIndex = stepIndex + ima_index_table[nibble & 7];
+            if (nextStepIndex > 88)
+                nextStepIndex = 88;
+            else if (nextStepIndex < 0)
+                nextStepIndex = 0;
+
+            table[stepIndex * 16 + nibble] = {diff, static_cast<qint8>(nextStepIndex)};
+        }
+    }
+    return table;
+}();
 
-    if (nibble & 1)
-        diff += step >> 2;
-    if (nibble & 2)
-        diff += step >> 1;
-    if (nibble & 4)
-        diff += step;
-    if (nibble & 8)
-        diff = -diff;
+static inline float decode(quint8 nibble, short &stepIndex, int &predictor)
+{
+    const AdpcmEntry &entry = g_adpcmTable[stepIndex * 16 + (nibble & 0x0F)];
 
-    predictor += diff;
+    predictor += entry.diff;
     if (predictor > 32767)
         predictor = 32767;
     else if (predictor < -32768)
         predictor = -32768;
 
-    stepIndex += ima_index_table[nibble & 7];
-    if (stepIndex > 88)
-        stepIndex = 88;
-    else if (stepIndex < 0)
-        stepIndex = 0;
+    stepIndex = entry.nextStepIndex;
 
-    return predictor / 32768.0f;
+    return predictor * (1.0f / 32768.0f);
 }
 
 /**/
@@ -76,6 +100,7 @@ Rayman2::Rayman2(Module &module)
 
 bool Rayman2::set()
 {
+    packetDuration = sets().getInt("PacketDuration");
     return sets().getBool("Rayman2");
 }
 
@@ -108,12 +133,13 @@ bool Rayman2::seek(double pos, bool backward)
     const QByteArray sampleCodes = reader->read(filePos - reader->pos());
     if (filePos - reader->pos() != 0)
         return false;
+    const uchar *codes = (const uchar *)sampleCodes.constData();
     for (int i = 0; !reader.isAborted() && i < sampleCodes.size(); i += chn)
     {
         for (int c = 0; c < chn; ++c)
         {
-            decode(sampleCodes[i+c] >> 4, stepIndex[c], predictor[c]);
-            decode(sampleCodes[i+c], stepIndex[c], predictor[c]);
+            decode(codes[i+c] >> 4, stepIndex[c], predictor[c]);
+            decode(codes[i+c], stepIndex[c], predictor[c]);
         }
     }
     return true;
@@ -125,17 +151,36 @@ bool Rayman2::read(Packet &decoded, int &idx)
 
     decoded.setTS((reader->pos() - 0x64) * 2.0 / chn / srate);
 
-    const QByteArray sampleCodes = reader->read(chn * 256);
+    // Every byte holds two samples of one channel
+    const int codesPerChannel = qMax<qint64>(1, static_cast<qint64>(srate) * packetDuration / 2000);
+    const QByteArray sampleCodes = reader->read(chn * codesPerChannel);
+    const int size = sampleCodes.size() / chn * chn;
 
-    decoded.resize(sampleCodes.size() * sizeof(float) * 2);
+    decoded.resize(size * sizeof(float) * 2);
     float *decodedData = (float *)decoded.data();
 
-    for (int i = 0; !reader.isAborted() && i + chn <= sampleCodes.size(); i += chn)
+    const uchar *codes = (const uchar *)sampleCodes.constData();
+    if (chn == 1)
     {
-        for (int c = 0; c < chn; ++c)
-            *(decodedData++) = decode(sampleCodes[i+c] >> 4, stepIndex[c], predictor[c]);
-        for (int c = 0; c < chn; ++c)
-            *(decodedData++) = decode(sampleCodes[i+c],      stepIndex[c], predictor[c]);
+        short stepIdx = stepIndex[0];
+        int pred = predictor[0];
+        for (int i = 0; i < size; ++i)
+        {
+            *(decodedData++) = decode(codes[i] >> 4, stepIdx, pred);
+            *(decodedData++) = decode(codes[i],      stepIdx, pred);
+        }
+        stepIndex[0] = stepIdx;
+        predictor[0] = pred;
+    }
+    else
+    {
+        for (int i = 0; i < size; i += chn)
+        {
+            for (int c = 0; c < chn; ++c)
+                *(decodedData++) = decode(codes[i+c] >> 4, stepIndex[c], predictor[c]);
+            for (int c = 0; c < chn; ++c)
+                *(decodedData++) = decode(codes[i+c],      stepIndex[c], predictor[c]);
+        }
     }
 
     if (reader.isAborted())
@@ -190,4 +235,7 @@ void Rayman2::readHeader(const char *_data)
     }
     predictor[0] = data.getDWORD();
     stepIndex[0] = data.getWORD();
+
+    for (int c = 0; c < qMin<int>(chn, 2); ++c)
+        stepIndex[c] = qBound<short>(0, stepIndex[c], 88);
 }
@@ -51,6 +51,7 @@ private:
     double len;
     unsigned srate;
     unsigned short chn;
+    int packetDuration;
     int predictor[2];
     short stepIndex[2];
 };
@@ -20,11 +20,63 @@
 
 #include <Functions.hpp>
 #include <Packet.hpp>
+#include <Tracer.hpp>
 
 #include <QUrlQuery>
 
+#include <array>
+#include <cstring>
 #include <cmath>
 
+constexpr int g_wavetableBits = 12;
+constexpr int g_wavetableSize = 1 << g_wavetableBits;
+constexpr int g_phaseFracBits = 32 - g_wavetableBits;
+constexpr quint32 g_phaseFracMask = (1u << g_phaseFracBits) - 1;
+constexpr double g_sweepStartFreq = 20.0;
+
+static const float *wavetable()
+{
+    // One period of sine, the extra sample is for interpolation
+    static const auto table = [] {
+        std::array<float, g_wavetableSize + 1> table;
+        for (int i = 0; i <= g_wavetableSize; ++i)
+            table[i] = sin(2.0 * M_PI * i / g_wavetableSize);
+        return table;
+    }();
+    return table.data();
+}
+
+static inline float wavetableSample(const float *table, const quint32 phase)
+{
+    const quint32 i = phase >> g_phaseFracBits;
+    const float frac = (phase & g_phaseFracMask) * (1.0f / (g_phaseFracMask + 1.0f));
+    return table[i] + (table[i + 1] - table[i]) * frac;
+}
+
+static inline quint32 phaseIncrement(const double freq, const quint32 srate)
+{
+    // 2^32 is one period, so the phase wraps around for free
+    double cycles = freq / srate;
+    cycles -= floor(cycles);
+    return static_cast<quint32>(static_cast<quint64>(cycles * 4294967296.0 + 0.5));
+}
+
+/**/
+
+const char *ToneGenerator::modeName(int mode)
+{
+    switch (mode)
+    {
+        case Sweep:
+            return "sweep";
+        case Impulse:
+            return "impulse";
+        default:
+            break;
+    }
+    return "sine";
+}
+
 ToneGenerator::ToneGenerator(Module &module) :
     aborted(false), metadata_changed(false), fromUrl(false), pos(0.0), srate(0)
 {
@@ -47,8 +99,17 @@ bool ToneGenerator::set()
                 metadata_changed = true;
             for (int i = 0; i < freqs.size(); ++i)
                 freqs[i] = newFreqs[i].toInt();
+            const Mode newMode = static_cast<Mode>(qBound(0, sets().getInt("ToneGenerator/mode"), MODE_COUNT - 1));
+            const int newPeriod = qMax(1, sets().getInt("ToneGenerator/period"));
+            if (m_mode != newMode || m_period != newPeriod)
+            {
+                m_mode = newMode;
+                m_period = newPeriod;
+                metadata_changed = true;
+            }
         }
     }
+    m_packetDuration = m_urlPacketDuration > 0 ? m_urlPacketDuration : sets().getInt("PacketDuration");
     return !restartPlaying;
 }
 
@@ -69,8 +130,20 @@ QString ToneGenerator::name() const
 QString ToneGenerator::title() const
 {
     QString t;
-    for (quint32 hz : freqs)
-        t += "   - " + QString::number(hz) + tr("Hz") + "\n";
+    if (m_mode == Impulse)
+    {
+        t = "   - " + tr("Impulse every %1 ms").arg(m_period) + "\n";
+    }
+    else
+    {
+        for (quint32 hz : freqs)
+        {
+            if (m_mode == Sweep)
+                t += "   - " + tr("Sweep %1Hz - %2Hz in %3 ms").arg(g_sweepStartFreq).arg(hz).arg(m_period) + "\n";
+            else
+                t += "   - " + QString::number(hz) + tr("Hz") + "\n";
+        }
+    }
     t.chop(1);
     return tr("Tone generator") + " (" + QString::number(srate) + tr("Hz") + "):\n" + t;
 }
@@ -97,18 +170,35 @@ bool ToneGenerator::read(Packet &decoded, int &idx)
     if (aborted)
         return false;
 
-    int chn = freqs.size();
+    const int chn = freqs.size();
+    const int frames = qMax<qint64>(1, static_cast<qint64>(srate) * m_packetDuration / 1000);
 
-    decoded.resize(sizeof(float) * chn * srate);
+    decoded.resize(sizeof(float) * chn * frames);
     float *samples = (float *)decoded.data();
 
-    for (quint32 i = 0; i < srate * chn; i += chn)
-        for (int c = 0; c < chn; ++c)
-            samples[i + c] = sin(2.0 * M_PI * freqs[c] * i / srate / chn); //don't use sinf()!
+    if (m_phases.size() != static_cast<size_t>(chn))
+    {
+        m_phases.assign(chn, 0);
+        m_sweepFreqs.assign(chn, g_sweepStartFreq);
+    }
+
+    switch (m_mode)
+    {
+        case Sweep:
+            generateSweep(samples, frames, chn);
+            break;
+        case Impulse:
+            generateImpulse(samples, frames, chn);
+            break;
+        default:
+            generateSine(samples, frames, chn);
+            break;
+    }
+    m_frame += frames;
 
     idx = 0;
     decoded.setTS(pos);
-    decoded.setDuration(1.0);
+    decoded.setDuration(frames / static_cast<double>(srate));
     pos += decoded.duration();
 
     return true;
@@ -118,6 +208,88 @@ void ToneGenerator::abort()
     aborted = true;
 }
 
+float *ToneGenerator::channelSamples(float *samples, int frames, int chn)
+{
+    // Channels are generated one by one into a contiguous buffer and then interleaved
+    if (chn == 1)
+        return samples;
+    m_channelSamples.resize(frames);
+    return m_channelSamples.data();
+}
+void ToneGenerator::storeChannel(float *samples, int frames, int c, int chn) const
+{
+    if (chn == 1)
+        return;
+    const float *src = m_channelSamples.data();
+    for (int i = 0; i < frames; ++i)
+        samples[i * chn + c] = src[i];
+}
+
+void ToneGenerator::generateSine(float *samples, int frames, int chn)
+{
+    const float *table = wavetable();
+    float *dst = channelSamples(samples, frames, chn);
+    for (int c = 0; c < chn; ++c)
+    {
+        const quint32 increment = phaseIncrement(freqs[c], srate);
+        const quint32 phase = m_phases[c];
+        // No loop-carried phase, so only the table lookups depend on the target's gather support
+        for (int i = 0; i < frames; ++i)
+            dst[i] = wavetableSample(table, phase + static_cast<quint32>(i) * increment);
+        m_phases[c] = phase + static_cast<quint32>(frames) * increment;
+        storeChannel(samples, frames, c, chn);
+    }
+}
+void ToneGenerator::generateSweep(float *samples, int frames, int chn)
+{
+    // Exponential sweep which starts again every period, the frequency is kept as a phase increment
+    const float *table = wavetable();
+    const double toIncrement = 4294967296.0 / srate;
+    const double startIncrement = g_sweepStartFreq * toIncrement;
+    const quint64 periodFrames = qMax<quint64>(1, static_cast<quint64>(srate) * m_period / 1000);
+    const quint64 framesToRestart = (periodFrames - m_frame % periodFrames) % periodFrames;
+    float *dst = channelSamples(samples, frames, chn);
+    for (int c = 0; c < chn; ++c)
+    {
+        // Limited to Nyquist, so the increment fits in 32 bits
+        const double endFreq = qBound<double>(g_sweepStartFreq, freqs[c], srate / 2.0);
+        const double ratio = pow(endFreq / g_sweepStartFreq, 1.0 / periodFrames);
+        quint32 phase = m_phases[c];
+        double increment = m_sweepFreqs[c] * toIncrement;
+        int i = 0;
+        int restart = static_cast<int>(qMin<quint64>(framesToRestart, frames));
+        for (;;)
+        {
+            for (; i < restart; ++i)
+            {
+                dst[i] = wavetableSample(table, phase);
+                phase += static_cast<quint32>(increment + 0.5);
+                increment *= ratio;
+            }
+            if (i >= frames)
+                break;
+            increment = startIncrement;
+            restart = static_cast<int>(qMin<quint64>(i + periodFrames, frames));
+        }
+        m_phases[c] = phase;
+        m_sweepFreqs[c] = increment / toIncrement;
+        storeChannel(samples, frames, c, chn);
+    }
+}
+void ToneGenerator::generateImpulse(float *samples, int frames, int chn)
+{
+    // Single full-scale sample on all channels at the beginning of every period
+    const quint64 periodFrames = qMax<quint64>(1, static_cast<quint64>(srate) * m_period / 1000);
+    memset(samples, 0, sizeof(float) * chn * frames);
+    for (quint64 frame = (periodFrames - m_frame % periodFrames) % periodFrames; frame < static_cast<quint64>(frames); frame += periodFrames)
+    {
+        for (int c = 0; c < chn; ++c)
+            samples[frame * chn + c] = 1.0f;
+        if (Tracer::isEnabled())
+            Tracer::instant("ToneGenerator impulse", QString::number(pos + frame / static_cast<double>(srate), 'f', 6), "demuxer");
+    }
+}
+
 bool ToneGenerator::open(const QString &entireUrl)
 {
     QString prefix, _url;
@@ -132,6 +304,21 @@ bool ToneGenerator::open(const QString &entireUrl)
         return true;
     }
 
+    const QUrlQuery query(url);
+
+    const QString mode = query.queryItemValue("mode");
+    m_mode = Sine;
+    for (int i = 0; i < MODE_COUNT; ++i)
+    {
+        if (mode == modeName(i))
+            m_mode = static_cast<Mode>(i);
+    }
+    if (query.hasQueryItem("period"))
+        m_period = qMax(1, query.queryItemValue("period").toInt());
+    m_urlPacketDuration = query.queryItemValue("packet").toInt();
+    if (m_urlPacketDuration > 0)
+        m_packetDuration = m_urlPacketDuration;
+
     srate = QUrlQuery(url).queryItemValue("samplerate").toUInt();
     if (!srate)
         srate = 44100;
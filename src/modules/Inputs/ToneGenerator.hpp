@@ -20,10 +20,16 @@
 
 #include <Demuxer.hpp>
 
+#include <vector>
+
 class ToneGenerator final : public Demuxer
 {
     Q_DECLARE_TR_FUNCTIONS(ToneGenerator)
 public:
+    enum Mode {Sine, Sweep, Impulse, MODE_COUNT};
+
+    static const char *modeName(int mode);
+
     ToneGenerator(Module &);
 
     bool set() override;
@@ -45,12 +51,29 @@ private:
 
     /**/
 
+    float *channelSamples(float *samples, int frames, int chn);
+    void storeChannel(float *samples, int frames, int c, int chn) const;
+
+    void generateSine(float *samples, int frames, int chn);
+    void generateSweep(float *samples, int frames, int chn);
+    void generateImpulse(float *samples, int frames, int chn);
+
     volatile bool aborted;
     mutable volatile bool metadata_changed;
     bool fromUrl;
     double pos;
     quint32 srate;
     QVector<quint32> freqs;
+
+    Mode m_mode = Sine;
+    int m_period = 1000; // Sweep duration or impulse interval in ms
+    int m_packetDuration = 50;
+    int m_urlPacketDuration = 0;
+
+    quint64 m_frame = 0;
+    std::vector<quint32> m_phases;
+    std::vector<double> m_sweepFreqs;
+    std::vector<float> m_channelSamples;
 };
 
 #define ToneGeneratorName "ToneGenerator"
@@ -33,7 +33,41 @@ QList<Modplug::Info> Modplug::getModulesInfo(const bool showDisabled) const
 {
     QList<Info> modulesInfo;
     if (showDisabled || getBool("ModplugEnabled"))
-        modulesInfo += Info(DemuxerName, DEMUXER, QStringList{"669", "amf", "ams", "dbm", "dmf", "dsm", "far", "it", "j2b", "mdl", "med", "mod", "mt2", "mtm", "okt", "psm", "ptm", "s3m", "stm", "ult", "umx", "xm", "sfx"}, modIcon);
+    {
+        Info info(DemuxerName, DEMUXER, QStringList{"669", "amf", "ams", "dbm", "dmf", "dsm", "far", "it", "j2b", "mdl", "med", "mod", "mt2", "mtm", "okt", "psm", "ptm", "s3m", "stm", "ult", "umx", "xm", "sfx"}, modIcon);
+        // MOD, DSM and SFX have no reliable signatures
+        info.magic = {
+            {"669", 0, "if"},
+            {"669", 0, "JN"},
+            {"amf", 0, "AMF"},
+            {"amf", 0, "ASYLUM Music Format"},
+            {"ams", 0, "Extreme"},
+            {"ams", 0, "AMShdr\x1A"},
+            {"dbm", 0, "DBM0"},
+            {"dmf", 0, "DDMF"},
+            {"far", 0, "FAR\xFE"},
+            {"it", 0, "IMPM"},
+            {"j2b", 0, "MUSE"},
+            {"mdl", 0, "DMDL"},
+            {"med", 0, "MMD0"},
+            {"med", 0, "MMD1"},
+            {"med", 0, "MMD2"},
+            {"med", 0, "MMD3"},
+            {"mt2", 0, "MT20"},
+            {"mtm", 0, "MTM"},
+            {"okt", 0, "OKTASONG"},
+            {"psm", 0, "PSM "},
+            {"psm", 0, "PSM\xFE"},
+            {"ptm", 44, "PTMF"},
+            {"s3m", 44, "SCRM"},
+            {"stm", 20, "!Scream!"},
+            {"stm", 20, "BMOD2STM"},
+            {"ult", 0, "MAS_UTrack_V00"},
+            {"umx", 0, "\xC1\x83\x2A\x9E"},
+            {"xm", 0, "Extended Module: "},
+        };
+        modulesInfo += info;
+    }
     return modulesInfo;
 }
 void *Modplug::createInstance(const QString &name)
@@ -1604,6 +1604,70 @@ UINT CSoundFile::CreateStereoMix(int count)
 }
 
 
+// Same as CreateStereoMix(), but only advances the channels without mixing (used for seeking)
+UINT CSoundFile::CreateDryMix(int count)
+//--------------------------------------
+{
+	DWORD nchused = 0;
+
+	if (count <= 0) return 0;
+	for (UINT nChn=0; nChn<m_nMixChannels; nChn++)
+	{
+		MODCHANNEL * const pChannel = &Chn[ChnMix[nChn]];
+		LONG nSmpCount;
+		int nsamples = count;
+
+		if (!pChannel->pCurrentSample) continue;
+		nchused++;
+		while (nsamples > 0)
+		{
+			UINT nrampsamples = nsamples;
+			if (pChannel->nRampLength > 0)
+			{
+				if ((LONG)nrampsamples > pChannel->nRampLength) nrampsamples = pChannel->nRampLength;
+			}
+			if ((nSmpCount = GetSampleCount(pChannel, nrampsamples)) <= 0)
+			{
+				// Stopping the channel
+				pChannel->pCurrentSample = NULL;
+				pChannel->nLength = 0;
+				pChannel->nPos = 0;
+				pChannel->nPosLo = 0;
+				pChannel->nRampLength = 0;
+				pChannel->dwFlags &= ~CHN_PINGPONGFLAG;
+				break;
+			}
+			LONG delta = (pChannel->nInc * (LONG)nSmpCount) + (LONG)pChannel->nPosLo;
+			pChannel->nPosLo = delta & 0xFFFF;
+			pChannel->nPos += (delta >> 16);
+			nsamples -= nSmpCount;
+			if (pChannel->nRampLength)
+			{
+				pChannel->nRampRightVol += pChannel->nRightRamp * nSmpCount;
+				pChannel->nRampLeftVol += pChannel->nLeftRamp * nSmpCount;
+				pChannel->nRightVol = pChannel->nRampRightVol >> VOLUMERAMPPRECISION;
+				pChannel->nLeftVol = pChannel->nRampLeftVol >> VOLUMERAMPPRECISION;
+				pChannel->nRampLength -= nSmpCount;
+				if (pChannel->nRampLength <= 0)
+				{
+					pChannel->nRampLength = 0;
+					pChannel->nRightVol = pChannel->nNewRightVol;
+					pChannel->nLeftVol = pChannel->nNewLeftVol;
+					pChannel->nRightRamp = pChannel->nLeftRamp = 0;
+					if ((pChannel->dwFlags & CHN_NOTEFADE) && (!(pChannel->nFadeOutVol)))
+					{
+						pChannel->nLength = 0;
+						pChannel->pCurrentSample = NULL;
+					}
+				}
+			}
+		}
+		pChannel->nROfs = pChannel->nLOfs = 0;
+	}
+	return nchused;
+}
+
+
 #ifdef MSC_VER
 #pragma warning (disable:4100)
 #endif
@@ -8,13 +8,45 @@
 #include "stdafx.hpp"
 #include "sndfile.hpp"
 
+#include <utility>
+#include <vector>
+
 namespace QMPlay2ModPlug {
 
+	// Playback state at a tick boundary, everything "ReadNote()" and the mixer modify
+	struct PlayState
+	{
+		unsigned long long nSample; // song position in samples
+		std::vector<MODCHANNEL> Chn; // channels above this are silent
+		std::vector<UINT> ChnMix;
+		DWORD dwSongFlags;
+		UINT nBufferCount;
+		UINT nTickCount, nTotalCount, nPatternDelay, nFrameDelay;
+		UINT nMusicSpeed, nMusicTempo;
+		UINT nNextRow, nRow;
+		UINT nPattern, nCurrentPattern, nNextPattern;
+		UINT nGlobalVolume, nOldGlbVolSlide;
+		UINT nFreqFactor, nTempoFactor;
+		LONG nRepeatCount;
+		DWORD nGlobalFadeSamples, nGlobalFadeMaxSamples;
+	};
+
 	struct File
 	{
 		CSoundFile mSoundFile;
+
+		// Seek index built once on load by simulating the song without mixing
+		std::vector<PlayState> mSeekPoints;
+		unsigned long long mSeekInterval; // in samples
+		unsigned long long mLength; // in samples
+		unsigned int mFrequency;
 	};
 
+	// Maximum number of seek points, the interval grows for longer (also looped) songs
+	static const unsigned int gMaxSeekPoints = 512;
+	// Looped songs (backward jumps) have no end, limit the index to one hour
+	static const unsigned int gMaxIndexedSeconds = 3600;
+
 	Settings gSettings =
 	{
 		ENABLE_OVERSAMPLING | ENABLE_NOISE_REDUCTION,
@@ -81,6 +113,150 @@ namespace QMPlay2ModPlug {
 	}
 
 
+static void SavePlayState(const CSoundFile &sf, unsigned long long nSample, PlayState &state)
+{
+	UINT nChannels = sf.m_nChannels;
+	for (UINT i = nChannels; i < MAX_CHANNELS; i++)
+	{
+		if (sf.Chn[i].nLength)
+			nChannels = i + 1;
+	}
+
+	state.nSample = nSample;
+	state.Chn.assign(sf.Chn, sf.Chn + nChannels);
+	state.ChnMix.assign(sf.ChnMix, sf.ChnMix + sf.m_nMixChannels);
+	state.dwSongFlags = sf.m_dwSongFlags;
+	state.nBufferCount = sf.m_nBufferCount;
+	state.nTickCount = sf.m_nTickCount;
+	state.nTotalCount = sf.m_nTotalCount;
+	state.nPatternDelay = sf.m_nPatternDelay;
+	state.nFrameDelay = sf.m_nFrameDelay;
+	state.nMusicSpeed = sf.m_nMusicSpeed;
+	state.nMusicTempo = sf.m_nMusicTempo;
+	state.nNextRow = sf.m_nNextRow;
+	state.nRow = sf.m_nRow;
+	state.nPattern = sf.m_nPattern;
+	state.nCurrentPattern = sf.m_nCurrentPattern;
+	state.nNextPattern = sf.m_nNextPattern;
+	state.nGlobalVolume = sf.m_nGlobalVolume;
+	state.nOldGlbVolSlide = sf.m_nOldGlbVolSlide;
+	state.nFreqFactor = sf.m_nFreqFactor;
+	state.nTempoFactor = sf.m_nTempoFactor;
+	state.nRepeatCount = sf.m_nRepeatCount;
+	state.nGlobalFadeSamples = sf.m_nGlobalFadeSamples;
+	state.nGlobalFadeMaxSamples = sf.m_nGlobalFadeMaxSamples;
+}
+
+static void RestorePlayState(CSoundFile &sf, const PlayState &state)
+{
+	const UINT nChannels = state.Chn.size();
+	memcpy(sf.Chn, state.Chn.data(), nChannels * sizeof(MODCHANNEL));
+	for (UINT i = nChannels; i < MAX_CHANNELS; i++)
+	{
+		MODCHANNEL &chn = sf.Chn[i];
+		chn.pCurrentSample = NULL;
+		chn.nPos = chn.nPosLo = chn.nLength = 0;
+		chn.nROfs = chn.nLOfs = 0;
+		chn.nRampLength = 0;
+		chn.nLeftVol = chn.nRightVol = 0;
+		chn.nNewLeftVol = chn.nNewRightVol = 0;
+		chn.nLeftRamp = chn.nRightRamp = 0;
+	}
+	memcpy(sf.ChnMix, state.ChnMix.data(), state.ChnMix.size() * sizeof(UINT));
+	sf.m_nMixChannels = state.ChnMix.size();
+	sf.m_dwSongFlags = state.dwSongFlags;
+	sf.m_nBufferCount = state.nBufferCount;
+	sf.m_nTickCount = state.nTickCount;
+	sf.m_nTotalCount = state.nTotalCount;
+	sf.m_nPatternDelay = state.nPatternDelay;
+	sf.m_nFrameDelay = state.nFrameDelay;
+	sf.m_nMusicSpeed = state.nMusicSpeed;
+	sf.m_nMusicTempo = state.nMusicTempo;
+	sf.m_nNextRow = state.nNextRow;
+	sf.m_nRow = state.nRow;
+	sf.m_nPattern = state.nPattern;
+	sf.m_nCurrentPattern = state.nCurrentPattern;
+	sf.m_nNextPattern = state.nNextPattern;
+	sf.m_nGlobalVolume = state.nGlobalVolume;
+	sf.m_nOldGlbVolSlide = state.nOldGlbVolSlide;
+	sf.m_nFreqFactor = state.nFreqFactor;
+	sf.m_nTempoFactor = state.nTempoFactor;
+	sf.m_nRepeatCount = state.nRepeatCount;
+	sf.m_nGlobalFadeSamples = state.nGlobalFadeSamples;
+	sf.m_nGlobalFadeMaxSamples = state.nGlobalFadeMaxSamples;
+}
+
+// Advances the song without mixing, stops at the end of the song
+static unsigned long long SkipSamples(CSoundFile &sf, unsigned long long nSamples)
+{
+	unsigned long long nSkipped = 0;
+	while (nSkipped < nSamples)
+	{
+		if (!sf.m_nBufferCount)
+		{
+			if (sf.m_dwSongFlags & (SONG_FADINGSONG | SONG_ENDREACHED))
+				break;
+			if (!sf.ReadNote())
+			{
+				sf.m_nBufferCount = 0;
+				break;
+			}
+		}
+		UINT nCount = sf.m_nBufferCount;
+		if (nCount > nSamples - nSkipped)
+			nCount = nSamples - nSkipped;
+		sf.CreateDryMix(nCount);
+		sf.m_nBufferCount -= nCount;
+		nSkipped += nCount;
+	}
+	return nSkipped;
+}
+
+// Simulates the whole song once, tick by tick, and stores the playback state periodically
+static void BuildSeekIndex(File* file)
+{
+	CSoundFile &sf = file->mSoundFile;
+
+	file->mFrequency = CSoundFile::GetSampleRate();
+
+	// Only an estimation (it doesn't know the real tick lengths), used for the seek interval
+	const unsigned long long nEstimatedLength = (unsigned long long)sf.GetSongTime() * file->mFrequency;
+	const unsigned long long nMaxLength = (unsigned long long)gMaxIndexedSeconds * file->mFrequency;
+
+	file->mSeekInterval = nEstimatedLength / gMaxSeekPoints;
+	if (file->mSeekInterval < file->mFrequency)
+		file->mSeekInterval = file->mFrequency;
+
+	unsigned long long nSample = 0, nNextSeekPoint = 0;
+	for (;;)
+	{
+		if (nSample >= nNextSeekPoint)
+		{
+			if (file->mSeekPoints.size() >= gMaxSeekPoints)
+			{
+				// Looped songs are longer than estimated, keep every second point and double the interval
+				const size_t nPoints = file->mSeekPoints.size() / 2;
+				for (size_t i = 1; i < nPoints; i++)
+					file->mSeekPoints[i] = std::move(file->mSeekPoints[i * 2]);
+				file->mSeekPoints.resize(nPoints);
+				file->mSeekInterval *= 2;
+			}
+			file->mSeekPoints.emplace_back();
+			SavePlayState(sf, nSample, file->mSeekPoints.back());
+			nNextSeekPoint += file->mSeekInterval;
+		}
+		if (nSample >= nMaxLength || !sf.ReadNote())
+			break;
+		const UINT nCount = sf.m_nBufferCount;
+		sf.CreateDryMix(nCount);
+		sf.m_nBufferCount = 0;
+		nSample += nCount;
+	}
+	file->mLength = nSample;
+
+	RestorePlayState(sf, file->mSeekPoints.front());
+}
+
 File* Load(const void* data, int size)
 {
 	File* result = new File;
@@ -88,6 +264,7 @@ File* Load(const void* data, int size)
 	if(result->mSoundFile.Create((const BYTE*)data, size))
 	{
 		result->mSoundFile.SetRepeatCount(gSettings.mLoopCount);
+		BuildSeekIndex(result);
 		return result;
 	}
 	else
@@ -115,7 +292,7 @@ const char* GetName(File* file)
 
 int GetLength(File* file)
 {
-	return file->mSoundFile.GetSongTime() * 1000;
+	return file->mLength * 1000 / file->mFrequency;
 }
 
 void InitMixerCallback(File* file,ModPlugMixerProc proc)
@@ -251,18 +428,21 @@ ModPlugNote* GetPattern(File* file,int pattern,unsigned int* numrows) {
 
 void Seek(File* file, int millisecond)
 {
-	int maxpos;
-	int maxtime = file->mSoundFile.GetSongTime() * 1000;
-	float postime;
+	CSoundFile &sf = file->mSoundFile;
+
+	unsigned long long nSample = (millisecond > 0) ? (unsigned long long)millisecond * file->mFrequency / 1000 : 0;
+	if (nSample > file->mLength)
+		nSample = file->mLength;
 
-	if(millisecond > maxtime)
-		millisecond = maxtime;
-	maxpos = file->mSoundFile.GetMaxPosition();
-	postime = 0.0f;
-	if (maxtime != 0.0f)
-		postime = (float)maxpos / (float)maxtime;
+	size_t idx = nSample / file->mSeekInterval;
+	if (idx >= file->mSeekPoints.size())
+		idx = file->mSeekPoints.size() - 1;
+	while (idx > 0 && file->mSeekPoints[idx].nSample > nSample)
+		--idx;
 
-	file->mSoundFile.SetCurrentPos((int)(millisecond * postime));
+	const PlayState &state = file->mSeekPoints[idx];
+	RestorePlayState(sf, state);
+	SkipSamples(sf, nSample - state.nSample);
 }
 
 void GetSettings(Settings* settings)
@@ -37,16 +37,15 @@ int  Read(File* file, void* buffer, int size);
  * structure and will remain valid until you unload the file. */
 const char* GetName(File* file);
 
-/* Get the length of the mod, in milliseconds.  Note that this result is not always
- * accurate, especially in the case of mods with loops. */
+/* Get the length of the mod, in milliseconds.  The length is computed once on load by
+ * simulating the whole song, so tempo and speed changes are taken into account.  Songs
+ * which loop forever are limited to one hour. */
 int GetLength(File* file);
 
-/* Seek to a particular position in the song.  Note that seeking and MODs don't mix very
- * well.  Some mods will be missing instruments for a short time after a seek, as ModPlug
- * does not scan the sequence backwards to find out which instruments were supposed to be
- * playing at that time.  (Doing so would be difficult and not very reliable.)  Also,
- * note that seeking is not very exact in some mods -- especially those for which
- * GetLength() does not report the full length. */
+/* Seek to a particular position in the song.  The playback state (channels, tempo, speed,
+ * global volume, ...) is restored from the nearest snapshot taken on load and then the song
+ * is advanced without mixing to the exact sample, so the seek time doesn't depend on the
+ * position in the song. */
 void Seek(File* file, int millisecond);
 
 enum Flags
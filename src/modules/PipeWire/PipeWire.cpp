@@ -52,6 +52,11 @@ PipeWire::SettingsWidget *PipeWire::getSettingsWidget()
     return new ModuleSettingsWidget(*this);
 }
 
+bool PipeWire::canLoadOnDemand() const
+{
+    return false; // Calls "pw_init()" from constructor
+}
+
 QMPLAY2_EXPORT_MODULE(PipeWire)
 
 /**/
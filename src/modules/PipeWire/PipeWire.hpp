@@ -31,6 +31,8 @@ private:
     void *createInstance(const QString &) override;
 
     SettingsWidget *getSettingsWidget() override;
+
+    bool canLoadOnDemand() const override;
 };
 
 /**/
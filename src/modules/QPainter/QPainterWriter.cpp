@@ -23,18 +23,24 @@
 #include <Functions.hpp>
 
 #include <QCoreApplication>
+#include <QPaintEvent>
 #include <QPainter>
+#include <QThread>
 
 extern "C" {
     #include <libavutil/cpu.h>
     #include <libavutil/mem.h>
 }
 
+constexpr int g_threadedScaleArea = 1280 * 720;
+constexpr int g_maxScaleThreads = 8;
+
 Drawable::Drawable(QPainterWriter &writer) :
+    Brightness(0), Contrast(0), Saturation(0),
     writer(writer)
 {
     grabGesture(Qt::PinchGesture);
-    setAutoFillBackground(true);
+    setAttribute(Qt::WA_OpaquePaintEvent); // Only borders around the video are filled in "paintEvent()"
     setMouseTracking(true);
     setPalette(Qt::black);
 }
@@ -51,7 +57,15 @@ void Drawable::draw(const Frame &newVideoFrame, bool canRepaint, bool entireScre
         return;
     }
     m_scaleByQt = (imgW > videoFrame.width()) || (imgH > videoFrame.height());
-    if (imgScaler.create(videoFrame, m_scaleByQt ? -1 : imgW, m_scaleByQt ? -1 : imgH))
+    const int dstW = m_scaleByQt ? videoFrame.width() : imgW;
+    const int dstH = m_scaleByQt ? videoFrame.height() : imgH;
+    const int threads = (dstW * dstH >= g_threadedScaleArea)
+        ? qBound(1, QThread::idealThreadCount(), g_maxScaleThreads)
+        : 1
+    ;
+    // Brightness, contrast and saturation are applied by the YUV to RGB conversion
+    imgScaler.setColorAdjustment(Brightness, Contrast, Saturation);
+    if (imgScaler.create(videoFrame, dstW, dstH, threads))
     {
         auto createImg = [this](int w, int h) {
             auto imgData = reinterpret_cast<uint8_t *>(av_malloc(w * h * 4 + av_cpu_max_align()));
@@ -70,8 +84,8 @@ void Drawable::draw(const Frame &newVideoFrame, bool canRepaint, bool entireScre
         imgScaler.scale(videoFrame, img.bits());
         if (writer.flip)
             img = img.mirrored(writer.flip & Qt::Horizontal, writer.flip & Qt::Vertical);
-        if (Brightness != 0 || Contrast != 100)
-            Functions::ImageEQ(Contrast, Brightness, img.bits(), img.bytesPerLine() * img.height());
+        if (!imgScaler.hasColorAdjustment() && (Brightness != 0 || Contrast != 0))
+            Functions::ImageEQ(Contrast + 100, Brightness * 256 / 100, img.bits(), img.bytesPerLine() * img.height());
     }
     if (canRepaint && !entireScreen)
         update(X, Y, W, H);
@@ -90,10 +104,23 @@ void Drawable::resizeEvent(QResizeEvent *e)
 
     draw(Frame(), e ? false : true, true);
 }
-void Drawable::paintEvent(QPaintEvent *)
+void Drawable::paintEvent(QPaintEvent *e)
 {
     QPainter p(this);
 
+    const QRect videoRect(X, Y, W, H);
+    const bool hasImg = !img.isNull();
+
+    const QRegion borders = hasImg
+        ? e->region().subtracted(videoRect)
+        : e->region()
+    ;
+    for (const QRect &rect : borders)
+        p.fillRect(rect, Qt::black);
+
+    if (!hasImg || !e->region().intersects(videoRect))
+        return;
+
     if (m_scaleByQt)
         p.setRenderHint(QPainter::SmoothPixmapTransform);
     p.translate(X, Y);
@@ -137,6 +164,7 @@ QPainterWriter::QPainterWriter(Module &module) :
     addParam("Flip");
     addParam("Brightness");
     addParam("Contrast");
+    addParam("Saturation");
 
     SetModule(module);
 }
@@ -165,15 +193,17 @@ bool QPainterWriter::processParams(bool *)
     const double _aspect_ratio = getParam("AspectRatio").toDouble();
     const double _zoom = getParam("Zoom").toDouble();
     const int _flip = getParam("Flip").toInt();
-    const int Contrast = getParam("Contrast").toInt() + 100;
-    const int Brightness = getParam("Brightness").toInt() * 256 / 100;
-    if (_aspect_ratio != aspect_ratio || _zoom != zoom || _flip != flip || Contrast != drawable->Contrast || Brightness != drawable->Brightness)
+    const int Contrast = getParam("Contrast").toInt();
+    const int Brightness = getParam("Brightness").toInt();
+    const int Saturation = getParam("Saturation").toInt();
+    if (_aspect_ratio != aspect_ratio || _zoom != zoom || _flip != flip || Contrast != drawable->Contrast || Brightness != drawable->Brightness || Saturation != drawable->Saturation)
     {
         zoom = _zoom;
         aspect_ratio = _aspect_ratio;
         flip = _flip;
         drawable->Contrast = Contrast;
         drawable->Brightness = Brightness;
+        drawable->Saturation = Saturation;
         doResizeEvent = drawable->isVisible();
     }
 
@@ -39,7 +39,7 @@ public:
 
     Frame videoFrame;
     QMPlay2OSDList osd_list;
-    int Brightness, Contrast;
+    int Brightness, Contrast, Saturation;
 private:
     void paintEvent(QPaintEvent *) override;
     bool event(QEvent *) override;
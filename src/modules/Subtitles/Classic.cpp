@@ -17,16 +17,14 @@
 */
 
 #include <Classic.hpp>
+#include <SubsReader.hpp>
 
 #include <Functions.hpp>
 #include <LibASS.hpp>
 
-#include <QRegularExpression>
-#include <QStringList>
+#include <QList>
 
 #include <algorithm>
-#include <cstdlib>
-#include <cstdio>
 
 /**
  * TMP      - hh:mm:ss:text    - "|" breaks line
@@ -37,7 +35,7 @@
 class SubWithoutEnd
 {
 public:
-    inline SubWithoutEnd(unsigned start, double duration, const QString &sub) :
+    inline SubWithoutEnd(unsigned start, double duration, const QByteArray &sub) :
         start(start), duration(duration), sub(sub)
     {}
 
@@ -58,7 +56,7 @@ public:
 
     unsigned start;
     double duration;
-    QString sub;
+    QByteArray sub;
 };
 
 static inline void initOnce(bool &ok, LibASS *ass)
@@ -70,12 +68,55 @@ static inline void initOnce(bool &ok, LibASS *ass)
     }
 }
 
-static inline QString convertLine(const QRegularExpression &rx, const QString &line)
+static inline bool isDigit(char c)
 {
-    return line.section(rx, 1, 1, QString::SectionIncludeTrailingSep).replace('|', '\n');
+    return (c >= '0' && c <= '9');
+}
+static inline bool isSpace(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\v' || c == '\f');
+}
+static inline bool isWordChar(char c)
+{
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// Returns the text after the timestamps with "|" replaced by line breaks
+static inline void convertLine(const char *p, const char *end, QByteArray &sub)
+{
+    if (p < end && isSpace(*p))
+        ++p;
+    sub.append(p, end - p);
+    sub.replace('|', '\n');
 }
 
-static void replaceText(QString &sub, int &pos, const int matchedLength, const bool singleLine, const QString &replaced, const QString &lf)
+// hh:mm:ss followed by any non-digit separator
+static bool parseTMP(const char *&p, const char *end, int &h, int &m, int &s)
+{
+    int digits = 0;
+    if (!SubsReader::readNumber(p, end, h, &digits) || digits > 2 || p >= end || *p++ != ':')
+        return false;
+    if (!SubsReader::readNumber(p, end, m, &digits) || digits > 2 || p >= end || *p++ != ':')
+        return false;
+    if (!SubsReader::readNumber(p, end, s, &digits) || digits > 2 || p >= end || isDigit(*p))
+        return false;
+    ++p;
+    return true;
+}
+
+// [begin][end] or {begin}{end}, the end value is optional (-1 if not present)
+static bool parseFrames(const char *&p, const char *end, char open, char close, int &b, int &e)
+{
+    if (p >= end || *p++ != open || !SubsReader::readNumber(p, end, b) || p >= end || *p++ != close)
+        return false;
+    if (p >= end || *p++ != open)
+        return false;
+    if (!SubsReader::readNumber(p, end, e))
+        e = -1;
+    return (p < end && *p++ == close);
+}
+
+static void replaceText(QByteArray &sub, int &pos, const int matchedLength, const bool singleLine, const QByteArray &replaced, const char *lf)
 {
     sub.replace(pos, matchedLength, replaced);
     pos += replaced.length();
@@ -87,6 +128,64 @@ static void replaceText(QString &sub, int &pos, const int matchedLength, const b
     }
 }
 
+static void convertMicroDVDStyles(QByteArray &sub)
+{
+    // {X:text} where "X" is the style, lowercase style applies to a single line
+    int pos = 0;
+    for (;;)
+    {
+        pos = sub.indexOf('{', pos);
+        if (pos < 0 || pos + 3 > sub.size())
+            break;
+
+        const char s = sub.at(pos + 1);
+        if (!isWordChar(s) || sub.at(pos + 2) != ':')
+        {
+            ++pos;
+            continue;
+        }
+
+        const int closePos = sub.indexOf('}', pos + 3);
+        const int lfPos = sub.indexOf('\n', pos + 3);
+        if (closePos < 0 || (lfPos > -1 && lfPos < closePos))
+        {
+            ++pos;
+            continue;
+        }
+
+        const int matchedLength = closePos - pos + 1;
+        const QByteArray styleText = sub.mid(pos + 3, closePos - pos - 3);
+        const bool singleLine = (s >= 'a' && s <= 'z');
+        switch (singleLine ? s : (s - 'A' + 'a'))
+        {
+            case 'c':
+                if (styleText.startsWith('$') && styleText.length() == 7)
+                {
+                    replaceText(sub, pos, matchedLength, singleLine, "{\\1c&" + styleText.mid(1) + "&}", "{\\1c}");
+                    continue;
+                }
+                break;
+            case 'f':
+                replaceText(sub, pos, matchedLength, singleLine, "{\\fn" + styleText + "}", "{\\fn}");
+                continue;
+            case 's':
+                replaceText(sub, pos, matchedLength, singleLine, "{\\fs" + styleText + "}", "{\\fs}");
+                continue;
+            case 'p':
+                if (!singleLine)
+                {
+                    replaceText(sub, pos, matchedLength, false, "{\\pos(" + styleText + ")}", "");
+                    continue;
+                }
+                break;
+            case 'y':
+                replaceText(sub, pos, matchedLength, singleLine, "{\\" + styleText + "1}", "{\\" + styleText + "0}");
+                continue;
+        }
+        pos += matchedLength;
+    }
+}
+
 /**/
 
 Classic::Classic(bool Use_mDVD_FPS, double Sub_max_s) :
@@ -100,42 +199,45 @@ bool Classic::toASS(const QByteArray &txt, LibASS *ass, double fps)
 
     bool ok = false, use_mDVD_FPS = Use_mDVD_FPS;
 
-    const QRegularExpression TMPRegExp(R"(\d{1,2}:\d{1,2}:\d{1,2}\D\s?)");
-    const QRegularExpression MPL2RegExp(R"(\[\d+\]\[\d*\]\s?)");
-    const QRegularExpression MicroDVDRegExp(R"(\{\d+\}\{\d*\}\s?)");
-    const QRegularExpression MicroDVDStylesRegExp(R"(\{(\w):(.*)\})", QRegularExpression::InvertedGreedinessOption);
-
     QList<SubWithoutEnd> subsWithoutEnd;
 
-    for (const QString &line : QString(txt).remove('\r').split('\n', Qt::SkipEmptyParts))
+    SubsReader reader(txt);
+    const char *line, *lineEnd;
+    QByteArray sub;
+
+    while (reader.readLine(line, lineEnd))
     {
+        const char *p = line;
+        SubsReader::skipSpaces(p, lineEnd);
+        if (p == lineEnd)
+            continue;
+
         double start = 0.0, duration = 0.0;
-        QString sub;
-        int idx;
+        int h, m, s, e;
+
+        sub.truncate(0);
 
-        if ((idx = line.indexOf(TMPRegExp)) > -1)
+        if (isDigit(*p))
         {
-            int h = -1, m = -1, s = -1;
-            sscanf(line.toLatin1().constData() + idx, "%d:%d:%d", &h, &m, &s);
-            if (h > -1 && m > -1 && s > -1)
+            if (parseTMP(p, lineEnd, h, m, s))
             {
                 start = h*3600 + m*60 + s;
-                sub = convertLine(TMPRegExp, line);
+                convertLine(p, lineEnd, sub);
             }
         }
-        else if ((idx = line.indexOf(MPL2RegExp)) > -1)
+        else if (*p == '[')
         {
-            int s = -1, e = -1;
-            sscanf(line.toLatin1().constData() + idx, "[%d][%d]", &s, &e);
-            if (s > -1)
+            if (parseFrames(p, lineEnd, '[', ']', s, e))
             {
-                for (const QString &l : convertLine(MPL2RegExp, line).split('\n'))
+                QByteArray text;
+                convertLine(p, lineEnd, text);
+                for (const QByteArray &l : text.split('\n'))
                 {
                     if (!sub.isEmpty())
                         sub.append('\n');
                     if (!l.isEmpty())
                     {
-                        switch (l.at(0).toLatin1()) {
+                        switch (l.at(0)) {
                             case '/':
                                 sub.append("{\\i1}" + l.mid(1) + "{\\i0}");
                                 break;
@@ -155,66 +257,25 @@ bool Classic::toASS(const QByteArray &txt, LibASS *ass, double fps)
                 duration = e / 10.0 - start;
             }
         }
-        else if ((idx = line.indexOf(MicroDVDRegExp)) > -1)
+        else if (*p == '{')
         {
-            int s = -1, e = -1;
-            sscanf(line.toLatin1().constData() + idx, "{%d}{%d}", &s, &e);
-            if (s > -1)
+            if (parseFrames(p, lineEnd, '{', '}', s, e))
             {
-                sub = convertLine(MicroDVDRegExp, line);
+                convertLine(p, lineEnd, sub);
 
                 if (use_mDVD_FPS && (s == 0 || s == 1))
                 {
                     use_mDVD_FPS = false;
-                    const double newFPS = QStringView(sub).left(qMin(6, sub.size())).toDouble();
-                    if (newFPS > 0.0 && newFPS < 100.0)
+                    bool fpsOk = false;
+                    const double newFPS = sub.left(6).toDouble(&fpsOk);
+                    if (fpsOk && newFPS > 0.0 && newFPS < 100.0)
                     {
                         fps = newFPS;
                         continue;
                     }
                 }
 
-                int pos = 0;
-                for (;;)
-                {
-                    const auto match = MicroDVDStylesRegExp.match(sub, pos);
-                    if (!match.hasMatch())
-                        break;
-
-                    pos = match.capturedStart();
-
-                    const int matchedLength = match.capturedLength();
-                    const QString styleText = match.captured(2);
-                    const QChar s = match.captured(1).at(0);
-                    const bool singleLine = s.isLower();
-                    switch (s.toLower().toLatin1())
-                    {
-                        case 'c':
-                            if (styleText.startsWith('$') && styleText.length() == 7)
-                            {
-                                replaceText(sub, pos, matchedLength, singleLine, "{\\1c&" + styleText.mid(1) + "&}", "{\\1c}");
-                                continue;
-                            }
-                            break;
-                        case 'f':
-                            replaceText(sub, pos, matchedLength, singleLine, "{\\fn" + styleText + "}", "{\\fn}");
-                            continue;
-                        case 's':
-                            replaceText(sub, pos, matchedLength, singleLine, "{\\fs" + styleText + "}", "{\\fs}");
-                            continue;
-                        case 'p':
-                            if (!singleLine)
-                            {
-                                replaceText(sub, pos, matchedLength, false, "{\\pos(" + styleText + ")}", QString());
-                                continue;
-                            }
-                            break;
-                        case 'y':
-                            replaceText(sub, pos, matchedLength, singleLine, "{\\" + styleText + "1}", "{\\" + styleText + "0}");
-                            continue;
-                    }
-                    pos += matchedLength;
-                }
+                convertMicroDVDStyles(sub);
 
                 start = s / fps;
                 duration = e / fps - start;
@@ -226,7 +287,7 @@ bool Classic::toASS(const QByteArray &txt, LibASS *ass, double fps)
             if (duration > 0.0)
             {
                 initOnce(ok, ass);
-                ass->addASSEvent(Functions::convertToASS(sub), start, duration);
+                ass->addASSEvent(Functions::convertToASS(QString::fromUtf8(sub)), start, duration);
             }
             else
                 subsWithoutEnd.append(SubWithoutEnd(start, Sub_max_s, sub));
@@ -252,7 +313,7 @@ bool Classic::toASS(const QByteArray &txt, LibASS *ass, double fps)
 
         initOnce(ok, ass);
         for (const SubWithoutEnd &sub : std::as_const(subsWithoutEnd))
-            ass->addASSEvent(Functions::convertToASS(sub.sub), sub.start, sub.duration);
+            ass->addASSEvent(Functions::convertToASS(QString::fromUtf8(sub.sub)), sub.start, sub.duration);
     }
 
     return ok;
@@ -17,52 +17,103 @@
 */
 
 #include <SRT.hpp>
+#include <SubsReader.hpp>
 #include <Functions.hpp>
 #include <LibASS.hpp>
 
-#include <QRegularExpression>
-#include <QStringList>
+#include <algorithm>
 
-#include <cstdio>
+// [hh:]mm:ss,ttt or [hh:]mm:ss.ttt (WebVTT)
+static bool parseTime(const char *p, const char *end, double &time)
+{
+    int fields[3];
+    int nFields = 0;
+
+    SubsReader::skipSpaces(p, end);
+    for (;;)
+    {
+        if (!SubsReader::readNumber(p, end, fields[nFields++]))
+            return false;
+        if (nFields == 3 || p >= end || *p != ':')
+            break;
+        ++p;
+    }
+    if (nFields < 2 || p >= end || (*p != ',' && *p != '.'))
+        return false;
+    ++p;
+
+    int fraction = 0, fractionDigits = 0;
+    if (!SubsReader::readNumber(p, end, fraction, &fractionDigits))
+        return false;
+
+    time = (nFields == 3)
+        ? fields[0] * 3600 + fields[1] * 60 + fields[2]
+        : fields[0] * 60 + fields[1]
+    ;
+    double divisor = 1.0;
+    while (fractionDigits-- > 0)
+        divisor *= 10.0;
+    time += fraction / divisor;
+
+    return true;
+}
 
 bool SRT::toASS(const QByteArray &srt, LibASS *ass, double)
 {
     if (!ass)
         return false;
 
+    static constexpr char arrow[] = "-->";
+
+    SubsReader reader(srt);
+    const char *line, *lineEnd;
+
+    const char *textBegin = nullptr, *textEnd = nullptr;
+    double start = -1.0, end = -1.0;
+    bool inCue = false;
     bool ok = false;
-    const char *scanfFmt = (srt.left(11 /* Including BOM */).contains("WEBVTT")) ? "%d:%d:%d.%d" : "%d:%d:%d,%d";
 
-    for (const QString &entry : QString(QString("\n\n") + srt).remove('\r').split(QRegularExpression("\n\n+(\\d+\n)?"), Qt::SkipEmptyParts))
+    auto addEvent = [&] {
+        if (textBegin && start >= 0.0 && end > start)
+        {
+            if (!ok)
+            {
+                ass->initASS();
+                ok = true;
+            }
+            // Lines inside the text keep their terminators, "convertToASS()" handles them
+            ass->addASSEvent(Functions::convertToASS(QString::fromUtf8(textBegin, textEnd - textBegin)), start, end - start);
+        }
+        textBegin = textEnd = nullptr;
+        inCue = false;
+    };
+
+    while (reader.readLine(line, lineEnd))
     {
-        int idx = entry.indexOf('\n');
-        if (idx > -1)
+        if (inCue)
         {
-            const QStringList time = entry.mid(0, idx).split(" --> ");
-            if (time.size() == 2)
+            if (line == lineEnd)
+            {
+                addEvent();
+            }
+            else
             {
-                double time_double[2] = {-1.0, -1.0};
-                for (int i = 0; i < 2; ++i)
-                {
-                    int h = -1, m = -1, s = -1, ms = -1;
-                    sscanf(time[i].toLatin1().constData(), scanfFmt, &h, &m, &s, &ms);
-                    if (h > -1 && m > -1 && s > -1 && ms > -1)
-                        time_double[i] = h*3600 + m*60 + s + ms/1000.0;
-                    else
-                        break;
-                }
-                if (time_double[0] >= 0.0 && time_double[1] > time_double[0])
-                {
-                    if (!ok)
-                    {
-                        ass->initASS();
-                        ok = true;
-                    }
-                    ass->addASSEvent(Functions::convertToASS(entry.mid(idx+1)), time_double[0], time_double[1]-time_double[0]);
-                }
+                if (!textBegin)
+                    textBegin = line;
+                textEnd = lineEnd;
             }
+            continue;
         }
+
+        // Everything outside of a cue except the timing line (cue numbers, WebVTT header and identifiers) is skipped
+        const char *arrowPos = std::search(line, lineEnd, arrow, arrow + 3);
+        if (arrowPos == lineEnd)
+            continue;
+
+        if (parseTime(line, arrowPos, start) && parseTime(arrowPos + 3, lineEnd, end))
+            inCue = true;
     }
+    addEvent();
 
     return ok;
 }
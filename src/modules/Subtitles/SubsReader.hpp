@@ -0,0 +1,88 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+
+#include <cstring>
+
+/* Byte-oriented single-pass line reader for text subtitles, it never copies the input data */
+
+class SubsReader
+{
+public:
+    inline SubsReader(const QByteArray &data)
+        : m_pos(data.constData())
+        , m_end(data.constData() + data.size())
+    {
+        if (m_end - m_pos >= 3 && memcmp(m_pos, "\xEF\xBB\xBF", 3) == 0)
+            m_pos += 3;
+    }
+
+    // Returns the next line without the line terminator
+    inline bool readLine(const char *&line, const char *&lineEnd)
+    {
+        if (m_pos >= m_end)
+            return false;
+
+        line = m_pos;
+
+        auto eol = static_cast<const char *>(memchr(m_pos, '\n', m_end - m_pos));
+        if (eol)
+        {
+            m_pos = eol + 1;
+        }
+        else
+        {
+            eol = m_end;
+            m_pos = m_end;
+        }
+
+        if (eol > line && eol[-1] == '\r')
+            --eol;
+        lineEnd = eol;
+
+        return true;
+    }
+
+    static inline void skipSpaces(const char *&p, const char *end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            ++p;
+    }
+
+    // Reads up to 9 decimal digits, "digits" receives the number of digits read
+    static inline bool readNumber(const char *&p, const char *end, int &value, int *digits = nullptr)
+    {
+        const char *const begin = p;
+        int v = 0;
+        while (p < end && p - begin < 9 && *p >= '0' && *p <= '9')
+            v = v * 10 + (*p++ - '0');
+        if (p == begin)
+            return false;
+        value = v;
+        if (digits)
+            *digits = p - begin;
+        return true;
+    }
+
+private:
+    const char *m_pos;
+    const char *const m_end;
+};
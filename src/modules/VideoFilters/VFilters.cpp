@@ -87,6 +87,11 @@ Module::SettingsWidget *VFilters::getSettingsWidget()
     return new ModuleSettingsWidget(*this);
 }
 
+bool VFilters::canLoadOnDemand() const
+{
+    return false; // Full screen state must be tracked from the beginning
+}
+
 QMPLAY2_EXPORT_MODULE(VFilters)
 
 /**/
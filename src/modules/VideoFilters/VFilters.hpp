@@ -33,6 +33,8 @@ private:
 
     SettingsWidget *getSettingsWidget() override;
 
+    bool canLoadOnDemand() const override;
+
 private:
     bool m_fullScreen = false;
 };
@@ -0,0 +1,140 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <AudioTap.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+constexpr int g_ringSize = 1 << 18; // ~170 ms of 8 channels at 192 kHz
+constexpr int g_ringMask = g_ringSize - 1;
+constexpr unsigned long g_analysisIntervalMs = 4;
+
+void AudioTap::setEnabled(bool enabled)
+{
+    if (enabled && !m_ring)
+        m_ring.reset(new float[g_ringSize]);
+    m_enabled.store(enabled, memory_order_release);
+}
+
+void AudioTap::push(const QByteArray &data)
+{
+    if (!m_enabled.load(memory_order_acquire))
+        return;
+
+    const int count = data.size() / sizeof(float);
+    const quint64 writePos = m_writePos.load(memory_order_relaxed);
+    if (count <= 0 || writePos + count - m_readPos.load(memory_order_acquire) > g_ringSize)
+        return; // Analysis thread is late, drop the chunk instead of waiting for it
+
+    const int pos = writePos & g_ringMask;
+    const int firstCount = min(count, g_ringSize - pos);
+    const auto src = reinterpret_cast<const float *>(data.constData());
+    memcpy(m_ring.get() + pos, src, firstCount * sizeof(float));
+    if (firstCount < count)
+        memcpy(m_ring.get(), src + firstCount, (count - firstCount) * sizeof(float));
+
+    m_writePos.store(writePos + count, memory_order_release);
+}
+
+int AudioTap::read(float *dst, int maxCount)
+{
+    if (m_discardRequested.exchange(false, memory_order_acq_rel))
+        discard();
+
+    const quint64 readPos = m_readPos.load(memory_order_relaxed);
+    const int count = min<quint64>(m_writePos.load(memory_order_acquire) - readPos, maxCount);
+    if (count <= 0)
+        return 0;
+
+    const int pos = readPos & g_ringMask;
+    const int firstCount = min(count, g_ringSize - pos);
+    memcpy(dst, m_ring.get() + pos, firstCount * sizeof(float));
+    if (firstCount < count)
+        memcpy(dst + firstCount, m_ring.get(), (count - firstCount) * sizeof(float));
+
+    m_readPos.store(readPos + count, memory_order_release);
+    return count;
+}
+void AudioTap::discard()
+{
+    m_readPos.store(m_writePos.load(memory_order_acquire), memory_order_release);
+}
+
+/**/
+
+shared_ptr<VisAnalysisThread> VisAnalysisThread::instance()
+{
+    static weak_ptr<VisAnalysisThread> weakInstance;
+    auto analysisThr = weakInstance.lock();
+    if (!analysisThr)
+    {
+        analysisThr.reset(new VisAnalysisThread);
+        weakInstance = analysisThr;
+    }
+    return analysisThr;
+}
+
+VisAnalysisThread::~VisAnalysisThread()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_br = true;
+        m_cond.wakeOne();
+    }
+    wait();
+}
+
+void VisAnalysisThread::addAnalyzer(VisAnalyzer *analyzer)
+{
+    QMutexLocker locker(&m_mutex);
+    if (find(m_analyzers.begin(), m_analyzers.end(), analyzer) != m_analyzers.end())
+        return;
+    m_analyzers.push_back(analyzer);
+    if (!isRunning())
+    {
+        setObjectName("VisAnalysisThr");
+        start();
+    }
+    m_cond.wakeOne();
+}
+void VisAnalysisThread::removeAnalyzer(VisAnalyzer *analyzer)
+{
+    // Waits for the current analysis pass, so the analyzer is not used anymore after return
+    QMutexLocker locker(&m_mutex);
+    m_analyzers.erase(remove(m_analyzers.begin(), m_analyzers.end(), analyzer), m_analyzers.end());
+}
+
+void VisAnalysisThread::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_br)
+    {
+        if (m_analyzers.empty())
+        {
+            m_cond.wait(&m_mutex);
+            continue;
+        }
+        for (VisAnalyzer *analyzer : m_analyzers)
+            analyzer->analyze();
+        m_cond.wait(&m_mutex, g_analysisIntervalMs);
+    }
+}
@@ -0,0 +1,161 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QThread>
+#include <QMutex>
+
+#include <memory>
+#include <vector>
+#include <atomic>
+
+/* Lock-free single producer (audio thread), single consumer (analysis thread) sample queue */
+class AudioTap
+{
+    Q_DISABLE_COPY(AudioTap)
+
+public:
+    AudioTap() = default;
+
+    void setEnabled(bool enabled);
+
+    void push(const QByteArray &data);
+
+    // Consumer only
+    int read(float *dst, int maxCount);
+    void discard();
+
+    // Any thread, the consumer discards the queued samples on the next "read()"
+    inline void requestDiscard()
+    {
+        m_discardRequested.store(true, std::memory_order_release);
+    }
+
+    inline void requestClear()
+    {
+        m_clearRequested.store(true, std::memory_order_release);
+    }
+    inline bool isClearRequested() const
+    {
+        return m_clearRequested.load(std::memory_order_acquire);
+    }
+    inline void clearDone()
+    {
+        m_clearRequested.store(false, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<float[]> m_ring;
+    std::atomic<quint64> m_writePos {0};
+    std::atomic<quint64> m_readPos {0};
+    std::atomic_bool m_enabled {false};
+    std::atomic_bool m_clearRequested {false};
+    std::atomic_bool m_discardRequested {false};
+};
+
+/**/
+
+/*
+ * Triple buffer - the analysis thread fills "back()" and publishes it, the GUI thread
+ * takes the newest published buffer in "fetch()" and reads it as "front()". None of
+ * them waits for the other one.
+ */
+template<typename T>
+class VisSnapshot
+{
+    Q_DISABLE_COPY(VisSnapshot)
+
+public:
+    VisSnapshot() = default;
+
+    // Only when the analysis thread doesn't use it
+    void reset(const T &value)
+    {
+        for (T &buffer : m_buffers)
+            buffer = value;
+        m_back = 0;
+        m_middle.store(1, std::memory_order_relaxed);
+        m_front = 2;
+    }
+
+    inline T &back()
+    {
+        return m_buffers[m_back];
+    }
+    inline void publish()
+    {
+        m_back = m_middle.exchange(m_back | g_newData, std::memory_order_acq_rel) & g_indexMask;
+    }
+
+    inline bool fetch()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & g_newData))
+            return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & g_indexMask;
+        return true;
+    }
+    inline const T &front() const
+    {
+        return m_buffers[m_front];
+    }
+
+private:
+    static constexpr int g_indexMask = 0x3;
+    static constexpr int g_newData = 0x4;
+
+    T m_buffers[3];
+    int m_back = 0;
+    std::atomic_int m_middle {1};
+    int m_front = 2;
+};
+
+/**/
+
+class VisAnalyzer
+{
+public:
+    virtual ~VisAnalyzer() = default;
+
+    virtual void analyze() = 0;
+};
+
+/* Single thread shared by all visualizations, it does all the work which was done on the audio thread */
+class VisAnalysisThread final : public QThread
+{
+public:
+    static std::shared_ptr<VisAnalysisThread> instance();
+
+    ~VisAnalysisThread();
+
+    void addAnalyzer(VisAnalyzer *analyzer);
+    void removeAnalyzer(VisAnalyzer *analyzer);
+
+private:
+    VisAnalysisThread() = default;
+
+    void run() override;
+
+    QMutex m_mutex;
+    QWaitCondition m_cond;
+    std::vector<VisAnalyzer *> m_analyzers;
+    bool m_br = false;
+};
@@ -18,12 +18,15 @@
 
 #include <FFTSpectrum.hpp>
 #include <Functions.hpp>
+#include <Tracer.hpp>
 
 #include <QPainter>
 #include <qevent.h>
 
 #include <cmath>
 
+constexpr int g_gradientLutSize = 1024;
+
 static inline void fltmix(FFT::Complex *dest, const float *winFunc, const float *src, const int size, const uchar chn)
 {
     for (int i = 0, j = 0; i < size; i += chn)
@@ -63,69 +66,134 @@ FFTSpectrumW::FFTSpectrumW(FFTSpectrum &fftSpectrum) :
 
 void FFTSpectrumW::paint(QPainter &p)
 {
-    bool canStop = true;
+    Tracer::Span traceSpan("FFTSpectrum::paint", "visualization");
+
+    bool canStop = !fftSpectrum.m_tap.isClearRequested();
 
-    auto getLimitedSize = [this](int limitFreq) {
-        const int size = spectrumData.size();
-        return qBound(1, qRound(size * 2.0 * limitFreq / srate), size);
-    };
+    spectrumData.fetch();
+    const QVector<float> &currSpectrum = spectrumData.front();
 
-    int size = spectrumData.size();
+    const int spectrumSize = currSpectrum.size();
+    int size = spectrumSize;
     if (m_limitFreq > 0 && size > 0 && Q_LIKELY(srate > 0))
-    {
-        size = getLimitedSize(m_limitFreq);
-    }
-    if (size)
-    {
-        QTransform t;
-        t.scale(width() / static_cast<qreal>(size), height());
+        size = qBound(1, qRound(size * 2.0 * m_limitFreq / srate), size);
 
-        if (mGradientImg.width() != size || linearGrad.finalStop().x() != size)
+    const qreal dpr = devicePixelRatioF();
+    const int columns = qRound(width() * dpr);
+    const int rows = qRound(height() * dpr);
+    if (size > 0 && columns > 0 && rows > 0)
+    {
+        if (mGradientImg.isNull())
         {
-            mGradientImg = QImage(size, 1, QImage::Format_RGB32);
+            mGradientImg = QImage(g_gradientLutSize, 1, QImage::Format_RGB32);
 
-            linearGrad.setFinalStop(getLimitedSize(20000), 0.0);
+            linearGrad.setFinalStop(g_gradientLutSize, 0.0);
 
             QPainter gp(&mGradientImg);
             gp.setPen(QPen(linearGrad, 0.0));
             gp.drawLine(0, 0, mGradientImg.width() - 1, 0);
+
+            m_columnBins.clear();
+        }
+
+        if (m_columnBins.size() != static_cast<size_t>(columns + 1) || m_columnsSize != size || m_columnsSpectrumSize != spectrumSize || m_columnsSrate != srate)
+        {
+            m_columnsSize = size;
+            m_columnsSpectrumSize = spectrumSize;
+            m_columnsSrate = srate;
+
+            const auto gradientLut = reinterpret_cast<const uint32_t *>(mGradientImg.constBits());
+
+            m_columnBins.resize(columns + 1);
+            m_columnColors.resize(columns);
+            for (int x = 0; x <= columns; ++x)
+                m_columnBins[x] = qBound(0, static_cast<int>(columnBin(x, columns)), size);
+            for (int x = 0; x < columns; ++x)
+            {
+                // Color depends on frequency, the whole gradient spans 0 - 20 kHz
+                const double freq = (srate > 0) ? m_columnBins[x] * (srate / 2.0) / spectrumSize : 20000.0 * x / columns;
+                m_columnColors[x] = gradientLut[qBound(0, static_cast<int>(freq * g_gradientLutSize / 20000.0), g_gradientLutSize - 1)];
+            }
+
+            lastData.fill({}, columns);
+            m_barTop.resize(columns);
+            m_lineRow.resize(columns);
         }
 
+        if (m_img.width() != columns || m_img.height() != rows)
+            m_img = QImage(columns, rows, QImage::Format_ARGB32_Premultiplied);
+
         const double currTime = Functions::gettime();
         const double realInterval = currTime - time;
         time = currTime;
 
-        const auto gradientLut = reinterpret_cast<const uint32_t *>(mGradientImg.constBits());
-        const float *spectrum = spectrumData.constData();
-        for (int x = 0; x < size; ++x)
+        const float *spectrum = currSpectrum.constData();
+        for (int x = 0; x < columns; ++x)
         {
+            /* Aggregate bins which fall into the pixel column */
+            const int binBegin = qMin(m_columnBins[x], size - 1);
+            const int binEnd = qMax(m_columnBins[x + 1], binBegin + 1);
+            float value = spectrum[binBegin];
+            for (int i = binBegin + 1; i < binEnd; ++i)
+                value = qMax(value, spectrum[i]);
+
             auto &lastDataX = lastData[x];
 
             /* Bars */
-            setValue(lastDataX.first, spectrum[x], realInterval * 2.0);
-            p.fillRect(t.mapRect(QRectF(x, 1.0 - lastDataX.first, 1.0, lastDataX.first)), gradientLut[x]);
+            setValue(lastDataX.first, value, realInterval * 2.0);
+            m_barTop[x] = rows - qBound(0, qRound(lastDataX.first * rows), rows);
 
             /* Horizontal lines over bars */
-            setValue(lastDataX.second, spectrum[x], realInterval * 0.5);
-            p.setPen(gradientLut[x]);
-            p.drawLine(t.map(QLineF(x, 1.0 - lastDataX.second.first, x + 1.0, 1.0 - lastDataX.second.first)));
+            setValue(lastDataX.second, value, realInterval * 0.5);
+            m_lineRow[x] = qBound(0, qRound((1.0 - lastDataX.second.first) * rows), rows - 1);
+
+            canStop &= (lastDataX.second.first == value);
+        }
 
-            canStop &= (lastDataX.second.first == spectrum[x]);
+        /* Rasterize everything in a single pass and draw it as one image */
+        const uint32_t *colors = m_columnColors.data();
+        const int *barTop = m_barTop.data();
+        const int *lineRow = m_lineRow.data();
+        for (int y = 0; y < rows; ++y)
+        {
+            auto line = reinterpret_cast<uint32_t *>(m_img.scanLine(y));
+            for (int x = 0; x < columns; ++x)
+                line[x] = (y >= barTop[x] || y == lineRow[x]) ? colors[x] : 0;
         }
+        p.drawImage(QRectF(0.0, 0.0, width(), height()), m_img);
+
+        if (Tracer::isEnabled())
+            traceSpan.setDetail(QString("%1 bins -> %2x%3").arg(size).arg(columns).arg(rows));
     }
 
     if (stopped && tim.isActive() && canStop)
         tim.stop();
 }
 
+double FFTSpectrumW::columnBin(double x, int columns) const
+{
+    if (m_logFreqScale)
+        return pow(m_columnsSize + 1.0, x / columns) - 1.0;
+    return x * m_columnsSize / columns;
+}
+
 void FFTSpectrumW::mouseMoveEvent(QMouseEvent *e)
 {
     if (srate > 0)
     {
-        double freq = srate / 2.0;
-        if (m_limitFreq > 0)
-            freq = qMin<double>(freq, m_limitFreq);
-        const int pointedFreq = qRound((e->pos().x() + 0.5) * freq / width());
+        int pointedFreq;
+        if (m_columnsSpectrumSize > 0 && m_columnsSrate == srate)
+        {
+            const double bin = columnBin(e->pos().x() + 0.5, width());
+            pointedFreq = qRound(bin * (srate / 2.0) / m_columnsSpectrumSize);
+        }
+        else
+        {
+            double freq = srate / 2.0;
+            if (m_limitFreq > 0)
+                freq = qMin<double>(freq, m_limitFreq);
+            pointedFreq = qRound((e->pos().x() + 0.5) * freq / width());
+        }
         QMPlay2Core.statusBarMessage(tr("Pointed frequency: %1 Hz").arg(pointedFreq), 1000);
     }
     VisWidget::mouseMoveEvent(e);
@@ -151,22 +219,31 @@ void FFTSpectrumW::stop()
 /**/
 
 FFTSpectrum::FFTSpectrum(Module &module) :
-    w(*this), tmpDataSize(0), tmpDataPos(0), m_linearScale(false)
+    w(*this),
+    m_analysisThr(VisAnalysisThread::instance()),
+    tmpDataSize(0), tmpDataPos(0), m_linearScale(false)
 {
     SetModule(module);
 }
+FFTSpectrum::~FFTSpectrum()
+{
+    m_analysisThr->removeAnalyzer(this);
+    FFT::freeComplex(m_complex);
+}
 
 void FFTSpectrum::soundBuffer(const bool enable)
 {
-    QMutexLocker mL(&mutex);
+    // The analysis thread doesn't use the buffers below until "addAnalyzer()"
+    m_analysisThr->removeAnalyzer(this);
+    m_tap.setEnabled(false);
+
     const int arrSize = enable ? (1 << w.fftSize) : 0;
     if (arrSize != tmpDataSize)
     {
         tmpDataPos = 0;
         FFT::freeComplex(m_complex);
         m_winFunc.clear();
-        w.spectrumData.clear();
-        w.lastData.clear();
+        w.spectrumData.reset(QVector<float>());
         m_fft.finish();
         if ((tmpDataSize = arrSize))
         {
@@ -175,10 +252,23 @@ void FFTSpectrum::soundBuffer(const bool enable)
             m_winFunc.resize(tmpDataSize);
             for (int i = 0; i < tmpDataSize; ++i)
                 m_winFunc[i] = 0.5f - 0.5f * cos(2.0f * static_cast<float>(M_PI) * i / (tmpDataSize - 1));
-            w.spectrumData.resize(tmpDataSize / 2);
-            w.lastData.resize(tmpDataSize / 2);
+            w.spectrumData.reset(QVector<float>(tmpDataSize / 2));
         }
     }
+
+    if (tmpDataSize > 0)
+    {
+        if (m_chn != w.chn)
+        {
+            m_chn = w.chn;
+            tmpDataPos = 0;
+        }
+        m_samples.resize(tmpDataSize * m_chn);
+        m_tap.requestDiscard(); // The analysis thread is the only one which can move the read position
+        m_tap.clearDone();
+        m_tap.setEnabled(true);
+        m_analysisThr->addAnalyzer(this);
+    }
 }
 
 bool FFTSpectrum::set()
@@ -193,6 +283,8 @@ bool FFTSpectrum::set()
     w.interval = isGlOnWindow ? 1 : sets().getInt("RefreshTime");
     m_linearScale = sets().getBool("FFTSpectrum/LinearScale");
     w.m_limitFreq = sets().getInt("FFTSpectrum/LimitFreq");
+    w.m_logFreqScale = sets().getBool("FFTSpectrum/LogFrequencyScale");
+    w.m_columnBins.clear();
     if (w.tim.isActive())
         w.start();
     else
@@ -237,44 +329,55 @@ void FFTSpectrum::visState(bool playing, uchar chn, uint srate)
 }
 void FFTSpectrum::sendSoundData(const QByteArray &data)
 {
-    if (!w.tim.isActive() || !data.size())
-        return;
-    QMutexLocker mL(&mutex);
-    if (!tmpDataSize)
+    m_tap.push(data);
+}
+void FFTSpectrum::clearSoundData()
+{
+    if (w.tim.isActive())
+    {
+        m_tap.requestClear();
+        w.stopped = true;
+        w.update();
+    }
+}
+
+void FFTSpectrum::analyze()
+{
+    if (m_tap.isClearRequested())
+    {
+        m_tap.discard();
+        tmpDataPos = 0;
+        w.spectrumData.back().fill(0.0f);
+        w.spectrumData.publish();
+        m_tap.clearDone();
         return;
-    int newDataPos = 0;
-    while (newDataPos < data.size())
+    }
+
+    const bool linearScale = m_linearScale;
+    for (;;)
     {
-        const int size = qMin((data.size() - newDataPos) / (int)sizeof(float), (tmpDataSize - tmpDataPos) * w.chn);
-        if (!size)
+        const int size = m_tap.read(m_samples.data(), (tmpDataSize - tmpDataPos) * m_chn);
+        if (size <= 0)
             break;
-        fltmix(m_complex + tmpDataPos, m_winFunc.data() + tmpDataPos, (const float *)(data.constData() + newDataPos), size, w.chn);
-        newDataPos += size * sizeof(float);
-        tmpDataPos += size / w.chn;
+        fltmix(m_complex + tmpDataPos, m_winFunc.data() + tmpDataPos, m_samples.data(), size, m_chn);
+        tmpDataPos += size / m_chn;
         if (tmpDataPos == tmpDataSize)
         {
             m_fft.calc(m_complex);
             tmpDataPos /= 2;
-            float *spectrumData = w.spectrumData.data();
+            QVector<float> &spectrum = w.spectrumData.back();
+            spectrum.resize(tmpDataPos);
+            float *spectrumData = spectrum.data();
             for (int i = 0; i < tmpDataPos; ++i)
             {
                 spectrumData[i] = sqrt(m_complex[i].re * m_complex[i].re + m_complex[i].im * m_complex[i].im) / tmpDataPos;
-                if (m_linearScale)
+                if (linearScale)
                     spectrumData[i] *= 2.0f;
                 else
                     spectrumData[i] = qBound(0.0f, (20.0f * std::log10(spectrumData[i]) + 65.0f) / 59.0f, 1.0f);
             }
+            w.spectrumData.publish();
             tmpDataPos = 0;
         }
     }
 }
-void FFTSpectrum::clearSoundData()
-{
-    if (w.tim.isActive())
-    {
-        QMutexLocker mL(&mutex);
-        w.spectrumData.fill(0.0f);
-        w.stopped = true;
-        w.update();
-    }
-}
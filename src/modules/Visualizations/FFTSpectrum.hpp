@@ -20,6 +20,7 @@
 
 #include <QMPlay2Extensions.hpp>
 #include <VisWidget.hpp>
+#include <AudioTap.hpp>
 #include <FFT.hpp>
 
 #include <QCoreApplication>
@@ -36,28 +37,43 @@ public:
 private:
     void paint(QPainter &p) override;
 
+    double columnBin(double x, int columns) const;
+
     void mouseMoveEvent(QMouseEvent *e) override;
 
     void start() override;
     void stop() override;
 
-    QVector<float> spectrumData;
+    VisSnapshot<QVector<float>> spectrumData;
     QVector<QPair<qreal, QPair<qreal, double>>> lastData;
     uchar chn;
     uint srate;
     int m_limitFreq = 0;
+    bool m_logFreqScale = true;
     int interval, fftSize;
     FFTSpectrum &fftSpectrum;
     QLinearGradient linearGrad;
     QImage mGradientImg;
+
+    // Spectrum bins mapped to pixel columns
+    std::vector<int> m_columnBins;
+    std::vector<uint32_t> m_columnColors;
+    std::vector<int> m_barTop, m_lineRow;
+    int m_columnsSize = 0;
+    int m_columnsSpectrumSize = 0;
+    uint m_columnsSrate = 0;
+    QImage m_img;
 };
 
 /**/
 
-class FFTSpectrum final : public QMPlay2Extensions
+class FFTSpectrum final : public QMPlay2Extensions, public VisAnalyzer
 {
+    friend class FFTSpectrumW;
+
 public:
     FFTSpectrum(Module &);
+    ~FFTSpectrum();
 
     void soundBuffer(const bool);
 
@@ -71,16 +87,23 @@ private:
     void sendSoundData(const QByteArray &) override;
     void clearSoundData() override;
 
+    void analyze() override;
+
     /**/
 
     FFTSpectrumW w;
 
+    AudioTap m_tap;
+    std::shared_ptr<VisAnalysisThread> m_analysisThr;
+
+    // Used by the analysis thread
     FFT m_fft;
     FFT::Complex *m_complex = nullptr;
     std::vector<float> m_winFunc;
+    std::vector<float> m_samples;
     int tmpDataSize, tmpDataPos;
-    bool m_linearScale;
-    QMutex mutex;
+    uchar m_chn = 0;
+    std::atomic_bool m_linearScale;
 };
 
 #define FFTSpectrumName "Widmo FFT"
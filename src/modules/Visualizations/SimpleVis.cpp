@@ -18,9 +18,9 @@
 
 #include <SimpleVis.hpp>
 #include <Functions.hpp>
+#include <Tracer.hpp>
 
 #include <QPainter>
-#include <QPainterPath>
 
 #include <cmath>
 
@@ -34,11 +34,11 @@ static inline float fltclip(float f)
         f = 0.0f;
     return f;
 }
-static inline void fltcpy(float *dest, const float *src, int size)
+static inline void fltclip(float *data, int size)
 {
     size /= sizeof(float);
     for (int i = 0; i < size; ++i)
-        dest[i] = fltclip(src[i]);
+        data[i] = fltclip(data[i]);
 }
 
 /**/
@@ -65,32 +65,65 @@ SimpleVisW::SimpleVisW(SimpleVis &simpleVis) :
 
 void SimpleVisW::paint(QPainter &p)
 {
-    const int size = soundData.size() / sizeof(float);
+    Tracer::Span traceSpan("SimpleVis::paint", "visualization");
+
+    soundData.fetch();
+    const QByteArray &currSoundData = soundData.front();
+
+    const int size = currSoundData.size() / sizeof(float);
     if (size >= chn)
     {
-        const float *samples = (const float *)soundData.constData();
+        const float *samples = (const float *)currSoundData.constData();
         const qreal dpr = devicePixelRatioF();
+        const int numSamples = size / chn;
+        const int columns = qMax(1, qRound((width() - 1) * 0.9 * dpr));
+        const bool aggregate = (numSamples > 2 * columns);
 
         qreal lr[2] = {0.0f, 0.0f};
 
+        m_baseLines.clear();
+        m_waveLines.clear();
+
         QTransform t;
         t.translate(0.0, fullScreen);
         t.scale((width() - 1) * 0.9, (height() - 1 - fullScreen) / 2.0 / chn);
         t.translate(0.055, 0.0);
         for (int c = 0; c < chn; ++c)
         {
-            p.setPen(QColor(102, 51, 128));
-            p.drawLine(t.map(QLineF(0.0, 1.0, 1.0, 1.0)));
+            m_baseLines.append(t.map(QLineF(0.0, 1.0, 1.0, 1.0)));
 
-            p.setPen(QPen(QColor(102, 179, 102), 1.0 / dpr));
-            QPainterPath path(t.map(QPointF(0.0, 1.0 - samples[c])));
-            for (int i = chn; i < size; i += chn)
-                path.lineTo(t.map(QPointF(i / (qreal)(size - chn), 1.0 - samples[i + c])));
-            p.drawPath(path);
+            if (aggregate)
+            {
+                /* Min and max of samples which fall into the pixel column */
+                for (int x = 0; x < columns; ++x)
+                {
+                    const int begin = static_cast<qint64>(x) * numSamples / columns;
+                    const int end = static_cast<qint64>(x + 1) * numSamples / columns;
+                    float minSample = samples[begin * chn + c];
+                    float maxSample = minSample;
+                    for (int i = begin + 1; i < end; ++i)
+                    {
+                        const float sample = samples[i * chn + c];
+                        minSample = qMin(minSample, sample);
+                        maxSample = qMax(maxSample, sample);
+                    }
+                    const qreal xPos = (x + 0.5) / columns;
+                    m_waveLines.append(t.map(QLineF(xPos, 1.0 - maxSample, xPos, 1.0 - minSample)));
+                }
+            }
+            else
+            {
+                QPointF prev = t.map(QPointF(0.0, 1.0 - samples[c]));
+                for (int i = chn; i < size; i += chn)
+                {
+                    const QPointF curr = t.map(QPointF(i / (qreal)(size - chn), 1.0 - samples[i + c]));
+                    m_waveLines.append(QLineF(prev, curr));
+                    prev = curr;
+                }
+            }
 
             if (c < 2)
             {
-                const int numSamples = size / chn;
                 for (int i = 0; i < size; i += chn)
                     lr[c] += samples[i + c] * samples[i + c];
                 lr[c] = 20.0 * log10(sqrt(lr[c] / numSamples));
@@ -100,6 +133,15 @@ void SimpleVisW::paint(QPainter &p)
             t.translate(0.0, 2.0);
         }
 
+        /* All channels at once */
+        p.setPen(QColor(102, 51, 128));
+        p.drawLines(m_baseLines);
+        p.setPen(QPen(QColor(102, 179, 102), 1.0 / dpr));
+        p.drawLines(m_waveLines);
+
+        if (Tracer::isEnabled())
+            traceSpan.setDetail(QString("%1 samples x %2 channel(s) -> %3 line(s)").arg(numSamples).arg(chn).arg(m_waveLines.size()));
+
         t.reset();
         t.scale(width()-1, height()-1);
 
@@ -125,7 +167,7 @@ void SimpleVisW::paint(QPainter &p)
         p.drawLine(t.map(QLineF(0.005, -leftLine.first  + 1.0, 0.040, -leftLine.first  + 1.0)));
         p.drawLine(t.map(QLineF(0.960, -rightLine.first + 1.0, 0.995, -rightLine.first + 1.0)));
 
-        if (stopped && tim.isActive() && leftLine.first == lr[0] && rightLine.first == lr[1])
+        if (stopped && tim.isActive() && !simpleVis.m_tap.isClearRequested() && leftLine.first == lr[0] && rightLine.first == lr[1])
             tim.stop();
     }
 }
@@ -156,29 +198,50 @@ void SimpleVisW::stop()
 /**/
 
 SimpleVis::SimpleVis(Module &module) :
-    w(*this), tmpDataPos(0)
+    w(*this),
+    m_analysisThr(VisAnalysisThread::instance()),
+    tmpDataPos(0)
 {
     SetModule(module);
 }
+SimpleVis::~SimpleVis()
+{
+    m_analysisThr->removeAnalyzer(this);
+}
 
 void SimpleVis::soundBuffer(const bool enable)
 {
-    QMutexLocker mL(&mutex);
+    // The analysis thread doesn't use the buffers below until "addAnalyzer()"
+    m_analysisThr->removeAnalyzer(this);
+    m_tap.setEnabled(false);
+
     const int arrSize = enable ? (ceil(sndLen * w.srate) * w.chn * sizeof(float)) : 0;
-    if (arrSize != tmpData.size() || arrSize != w.soundData.size())
+    if (arrSize != tmpData.size() || arrSize != w.soundData.front().size())
     {
         tmpDataPos = 0;
         tmpData.clear();
         if (arrSize)
         {
             tmpData.resize(arrSize);
-            const int oldSize = w.soundData.size();
-            w.soundData.resize(arrSize);
+            QByteArray soundData = w.soundData.front();
+            const int oldSize = soundData.size();
+            soundData.resize(arrSize);
             if (arrSize > oldSize)
-                memset(w.soundData.data() + oldSize, 0, arrSize - oldSize);
+                memset(soundData.data() + oldSize, 0, arrSize - oldSize);
+            w.soundData.reset(soundData);
         }
         else
-            w.soundData.clear();
+        {
+            w.soundData.reset(QByteArray());
+        }
+    }
+
+    if (arrSize > 0)
+    {
+        m_tap.requestDiscard(); // The analysis thread is the only one which can move the read position
+        m_tap.clearDone();
+        m_tap.setEnabled(true);
+        m_analysisThr->addAnalyzer(this);
     }
 }
 
@@ -230,32 +293,44 @@ void SimpleVis::visState(bool playing, uchar chn, uint srate)
 }
 void SimpleVis::sendSoundData(const QByteArray &data)
 {
-    if (!w.tim.isActive() || !data.size())
-        return;
-    QMutexLocker mL(&mutex);
-    if (!tmpData.size())
-        return;
-    int newDataPos = 0;
-    while (newDataPos < data.size())
-    {
-        const int size = qMin(data.size() - newDataPos, tmpData.size() - tmpDataPos);
-        fltcpy((float *)(tmpData.data() + tmpDataPos), (const float *)(data.constData() + newDataPos), size);
-        newDataPos += size;
-        tmpDataPos += size;
-        if (tmpDataPos == tmpData.size())
-        {
-            memcpy(w.soundData.data(), tmpData.constData(), tmpDataPos);
-            tmpDataPos = 0;
-        }
-    }
+    m_tap.push(data);
 }
 void SimpleVis::clearSoundData()
 {
     if (w.tim.isActive())
     {
-        QMutexLocker mL(&mutex);
-        w.soundData.fill(0);
+        m_tap.requestClear();
         w.stopped = true;
         w.update();
     }
 }
+
+void SimpleVis::analyze()
+{
+    if (m_tap.isClearRequested())
+    {
+        m_tap.discard();
+        tmpDataPos = 0;
+        w.soundData.back().fill(0);
+        w.soundData.publish();
+        m_tap.clearDone();
+        return;
+    }
+
+    for (;;)
+    {
+        float *dst = (float *)(tmpData.data() + tmpDataPos);
+        const int size = m_tap.read(dst, (tmpData.size() - tmpDataPos) / sizeof(float)) * sizeof(float);
+        if (size <= 0)
+            break;
+        fltclip(dst, size);
+        tmpDataPos += size;
+        if (tmpDataPos == tmpData.size())
+        {
+            QByteArray &soundData = w.soundData.back();
+            memcpy(soundData.data(), tmpData.constData(), tmpDataPos);
+            w.soundData.publish();
+            tmpDataPos = 0;
+        }
+    }
+}
@@ -20,9 +20,12 @@
 
 #include <QMPlay2Extensions.hpp>
 #include <VisWidget.hpp>
+#include <AudioTap.hpp>
 
 #include <QCoreApplication>
 #include <QLinearGradient>
+#include <QVector>
+#include <QLine>
 
 class SimpleVis;
 
@@ -41,10 +44,11 @@ private:
     void start() override;
     void stop() override;
 
-    QByteArray soundData;
+    VisSnapshot<QByteArray> soundData;
     quint8 chn;
     quint32 srate;
     int interval;
+    QVector<QLineF> m_baseLines, m_waveLines;
     qreal leftBar, rightBar;
     QPair<qreal, double> leftLine, rightLine;
     SimpleVis &simpleVis;
@@ -54,10 +58,13 @@ private:
 
 /**/
 
-class SimpleVis final : public QMPlay2Extensions
+class SimpleVis final : public QMPlay2Extensions, public VisAnalyzer
 {
+    friend class SimpleVisW;
+
 public:
     SimpleVis(Module &);
+    ~SimpleVis();
 
     void soundBuffer(const bool);
 
@@ -71,13 +78,19 @@ private:
     void sendSoundData(const QByteArray &) override;
     void clearSoundData() override;
 
+    void analyze() override;
+
     /**/
 
     SimpleVisW w;
 
+    AudioTap m_tap;
+    std::shared_ptr<VisAnalysisThread> m_analysisThr;
+
+    // Used by the analysis thread
     QByteArray tmpData;
     int tmpDataPos;
-    QMutex mutex;
+
     float sndLen;
 };
 
@@ -33,6 +33,7 @@ Visualizations::Visualizations() :
     init("SimpleVis/SoundLength", ms);
     init("FFTSpectrum/Size", 8);
     init("FFTSpectrum/LimitFreq", 20000);
+    init("FFTSpectrum/LogFrequencyScale", true);
 }
 
 QList<Visualizations::Info> Visualizations::getModulesInfo(const bool) const
@@ -121,6 +122,9 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
     m_fftLinearScaleB = new QCheckBox(tr("Linear volume scale in FFT spectrum"));
     m_fftLinearScaleB->setChecked(sets().getBool("FFTSpectrum/LinearScale"));
 
+    m_fftLogFreqScaleB = new QCheckBox(tr("Logarithmic frequency scale in FFT spectrum"));
+    m_fftLogFreqScaleB->setChecked(sets().getBool("FFTSpectrum/LogFrequencyScale"));
+
     QFormLayout *layout = new QFormLayout(this);
     if (refTimeB)
         layout->addRow(tr("Refresh time") + ": ", refTimeB);
@@ -128,6 +132,7 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
     layout->addRow(tr("FFT spectrum size") + ": ", fftSizeB);
     layout->addRow(tr("Limit frequency in FFT spectrum"), m_fftLimitFreqB);
     layout->addRow(m_fftLinearScaleB);
+    layout->addRow(m_fftLogFreqScaleB);
 
     if (refTimeB)
         connect(refTimeB, SIGNAL(valueChanged(int)), sndLenB, SLOT(setValue(int)));
@@ -140,5 +145,6 @@ void ModuleSettingsWidget::saveSettings()
     sets().set("SimpleVis/SoundLength", sndLenB->value());
     sets().set("FFTSpectrum/Size", fftSizeB->value());
     sets().set("FFTSpectrum/LinearScale", m_fftLinearScaleB->isChecked());
+    sets().set("FFTSpectrum/LogFrequencyScale", m_fftLogFreqScaleB->isChecked());
     sets().set("FFTSpectrum/LimitFreq", m_fftLimitFreqB->currentData().toInt());
 }
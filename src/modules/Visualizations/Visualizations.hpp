@@ -50,4 +50,5 @@ private:
     QSpinBox *refTimeB = nullptr, *sndLenB, *fftSizeB;
     QComboBox *m_fftLimitFreqB;
     QCheckBox *m_fftLinearScaleB;
+    QCheckBox *m_fftLogFreqScaleB;
 };
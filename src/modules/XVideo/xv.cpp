@@ -175,8 +175,9 @@ void XVIDEO::open(int W, int H, unsigned long _handle, const QString &adaptorNam
     if (!image)
         return close();
 
-    osdImg = QImage(image->width, image->height, QImage::Format_ARGB32);
+    osdImg = QImage(image->width, image->height, QImage::Format_ARGB32_Premultiplied);
     osdImg.fill(0);
+    osdBounds = QRect();
 
     _isOpen = true;
 }
@@ -225,7 +226,7 @@ void XVIDEO::draw(const Frame &videoFrame, const QRect &srcRect, const QRect &ds
         Functions::vFlip((quint8 *)image->data, image->pitches[0], image->height);
 
     if (!osd_list.isEmpty())
-        Functions::paintOSDtoYV12((quint8 *)image->data, osdImg, W, H, image->pitches[0], image->pitches[1], osd_list, osd_ids);
+        Functions::paintOSDtoYV12((quint8 *)image->data, osdImg, osdBounds, W, H, image->pitches[0], image->pitches[1], osd_list, osd_ids);
 
     putImage(srcRect, dstRect);
     hasImage = true;
@@ -324,5 +325,6 @@ void XVIDEO::clrVars()
     hasImage = false;
     fo = nullptr;
     osdImg = QImage();
+    osdBounds = QRect();
     osd_ids.clear();
 }
@@ -24,7 +24,6 @@
 #include <QVector>
 #include <QMutex>
 
-class QRect;
 class Frame;
 class QMPlay2OSD;
 struct XVideoPrivate;
@@ -76,6 +75,7 @@ private:
     unsigned int adaptors;
 
     QVector<quint64> osd_ids;
+    QRect osdBounds;
 
     XVideoPrivate *priv;
 };
@@ -21,52 +21,190 @@
 #include <Functions.hpp>
 #include <Module.hpp>
 
+#include <QMutex>
+#include <QFile>
+
+#include <memory>
+
+constexpr int g_sniffSize = 4096;
+
+struct DemuxerRegistry
+{
+    struct Entry
+    {
+        Module *module;
+        Module::Info info;
+    };
+
+    QVector<Entry> entries;
+    QHash<QString, QVector<int>> byName;
+    QHash<QString, QVector<int>> byExtension;
+    QVector<int> fallbacks;
+    bool hasMagic = false;
+};
+
+static QMutex g_registryMutex;
+static std::shared_ptr<const DemuxerRegistry> g_registry;
+
+static std::shared_ptr<const DemuxerRegistry> getRegistry()
+{
+    QMutexLocker locker(&g_registryMutex);
+    if (g_registry)
+        return g_registry;
+
+    auto registry = std::make_shared<DemuxerRegistry>();
+    for (Module *module : QMPlay2Core.getPluginsInstance())
+    {
+        for (const Module::Info &mod : module->getModulesInfo())
+        {
+            if (mod.type != Module::DEMUXER)
+                continue;
+
+            const int idx = registry->entries.size();
+            registry->entries.push_back({module, mod});
+            registry->byName[mod.name].push_back(idx);
+            if (mod.extensions.isEmpty())
+                registry->fallbacks.push_back(idx);
+            for (const QString &extension : mod.extensions)
+                registry->byExtension[extension].push_back(idx);
+            if (!mod.magic.isEmpty())
+                registry->hasMagic = true;
+        }
+    }
+
+    g_registry = registry;
+    return g_registry;
+}
+
+static QByteArray readHeader(const QString &url)
+{
+    QFile f(url.mid(7));
+    if (!f.open(QFile::ReadOnly))
+        return QByteArray();
+    return f.read(g_sniffSize);
+}
+
+static inline bool matchMagic(const Module::Info::Magic &magic, const QByteArray &header)
+{
+    return (header.mid(magic.offset, magic.bytes.size()) == magic.bytes);
+}
+
+/**/
+
 bool Demuxer::create(const QString &url, IOController<Demuxer> &demuxer, FetchTracks *fetchTracks)
 {
     const QString scheme = Functions::getUrlScheme(url);
     if (demuxer.isAborted() || url.isEmpty() || scheme.isEmpty())
         return false;
-    const QString extension = Functions::fileExt(url).toLower();
-    for (int i = 0; i <= 1; ++i)
-        for (Module *module : QMPlay2Core.getPluginsInstance())
-            for (const Module::Info &mod : module->getModulesInfo())
-                if (mod.type == Module::DEMUXER && (mod.name == scheme || (!i ? mod.extensions.contains(extension) : mod.extensions.isEmpty())))
+
+    const auto registry = getRegistry();
+
+    QVector<int> candidates = registry->byName.value(scheme);
+    if (candidates.isEmpty())
+    {
+        const QString extension = Functions::fileExt(url).toLower();
+        const QVector<int> extCandidates = registry->byExtension.value(extension);
+        QVector<int> mismatched;
+
+        const auto addCandidate = [&](const int idx) {
+            if (!candidates.contains(idx))
+                candidates.push_back(idx);
+        };
+
+        const QByteArray header = (scheme == "file" && registry->hasMagic) ? readHeader(url) : QByteArray();
+        if (!header.isEmpty())
+        {
+            // Content which matches a long enough signature goes to its demuxer first, even if the extension is wrong
+            for (int i = 0; i < registry->entries.size(); ++i)
+            {
+                for (const Module::Info::Magic &magic : registry->entries[i].info.magic)
+                {
+                    if (magic.bytes.size() >= 4 && matchMagic(magic, header))
+                    {
+                        addCandidate(i);
+                        break;
+                    }
+                }
+            }
+
+            // Demuxers which know the signatures for this extension and none of them matches are tried last
+            for (const int idx : extCandidates)
+            {
+                bool hasMagic = false, matches = false;
+                for (const Module::Info::Magic &magic : registry->entries[idx].info.magic)
                 {
-                    if (!demuxer.assign((Demuxer *)module->createInstance(mod.name)))
+                    if (!magic.extension.isEmpty() && magic.extension != extension)
                         continue;
-                    bool canDoOpen = true;
-                    if (fetchTracks)
+                    hasMagic = true;
+                    if (matchMagic(magic, header))
                     {
-                        fetchTracks->isOK = true;
-                        fetchTracks->tracks = demuxer->fetchTracks(url, fetchTracks->isOK);
-                        if (fetchTracks->isOK) //If tracks are fetched correctly (even if track list is empty)
-                        {
-                            if (!fetchTracks->tracks.isEmpty()) //Return tracks list
-                            {
-                                demuxer.reset();
-                                return true;
-                            }
-                            if (fetchTracks->onlyTracks) //If there are no tracks and we want only track list - return false
-                            {
-                                demuxer.reset();
-                                return false;
-                            }
-                        }
-                        else //Tracks can't be fetched - an error occured
-                        {
-                            fetchTracks->tracks.clear(); //Clear if list is not empty
-                            canDoOpen = false;
-                        }
+                        matches = true;
+                        break;
                     }
-                    if (canDoOpen && demuxer->open(url))
-                        return true;
+                }
+                if (hasMagic && !matches)
+                    mismatched.push_back(idx);
+                else
+                    addCandidate(idx);
+            }
+        }
+        else
+        {
+            candidates = extCandidates;
+        }
+
+        for (const int idx : registry->fallbacks)
+            addCandidate(idx);
+        for (const int idx : std::as_const(mismatched))
+            addCandidate(idx);
+    }
+
+    for (const int idx : std::as_const(candidates))
+    {
+        Module *module = registry->entries[idx].module;
+        const Module::Info &mod = registry->entries[idx].info;
+
+        if (!demuxer.assign((Demuxer *)module->createInstance(mod.name)))
+            continue;
+        bool canDoOpen = true;
+        if (fetchTracks)
+        {
+            fetchTracks->isOK = true;
+            fetchTracks->tracks = demuxer->fetchTracks(url, fetchTracks->isOK);
+            if (fetchTracks->isOK) //If tracks are fetched correctly (even if track list is empty)
+            {
+                if (!fetchTracks->tracks.isEmpty()) //Return tracks list
+                {
+                    demuxer.reset();
+                    return true;
+                }
+                if (fetchTracks->onlyTracks) //If there are no tracks and we want only track list - return false
+                {
                     demuxer.reset();
-                    if (mod.name == scheme || demuxer.isAborted())
-                        return false;
+                    return false;
                 }
+            }
+            else //Tracks can't be fetched - an error occured
+            {
+                fetchTracks->tracks.clear(); //Clear if list is not empty
+                canDoOpen = false;
+            }
+        }
+        if (canDoOpen && demuxer->open(url))
+            return true;
+        demuxer.reset();
+        if (mod.name == scheme || demuxer.isAborted())
+            return false;
+    }
     return false;
 }
 
+void Demuxer::resetRegistry()
+{
+    QMutexLocker locker(&g_registryMutex);
+    g_registry.reset();
+}
+
 Demuxer::~Demuxer()
 {
     for (StreamInfo *streamInfo : std::as_const(streams_info))
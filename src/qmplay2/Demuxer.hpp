@@ -44,6 +44,9 @@ public:
 
     static bool create(const QString &url, IOController<Demuxer> &demuxer, FetchTracks *fetchTracks = nullptr);
 
+    // Demuxers lookup tables are built once, call this when modules info changes
+    static void resetRegistry();
+
     ~Demuxer();
 
     virtual bool metadataChanged() const;
@@ -422,11 +422,16 @@ void Functions::paintOSD(bool rgbSwapped, const QMPlay2OSDList &osd_list, const
             painter.scale(scaleW, scaleH);
         }
         osd->iterate([&](const QMPlay2OSD::Image &img) {
+            QImage::Format format;
+            if (img.premultiplied)
+                format = rgbSwapped ? QImage::Format_RGBA8888_Premultiplied : QImage::Format_ARGB32_Premultiplied;
+            else
+                format = rgbSwapped ? QImage::Format_RGBA8888 : QImage::Format_ARGB32;
             const QImage qImg = QImage(
                 (const uchar *)img.rgba.constData(),
                 img.size.width(),
                 img.size.height(),
-                rgbSwapped ? QImage::Format_RGBA8888 : QImage::Format_ARGB32
+                format
             );
             if (osd->needsRescale())
             {
@@ -441,7 +446,97 @@ void Functions::paintOSD(bool rgbSwapped, const QMPlay2OSDList &osd_list, const
             painter.restore();
     }
 }
-void Functions::paintOSDtoYV12(quint8 *imageData, QImage &osdImg, int W, int H, int linesizeLuma, int linesizeChroma, const QMPlay2OSDList &osd_list, OsdIdList &osd_ids)
+void Functions::blendAlphaToRGBA(quint32 *dst, int dstStride, const quint8 *alpha, int alphaLinesize, int w, int h, quint8 r, quint8 g, quint8 b, quint8 a)
+{
+    // Exact "x / 255" with rounding for "x" in range [0, 255 * 255]
+    auto div255 = [](quint32 x)->quint32 {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    };
+
+    // Blends solid color with the alpha mask over premultiplied pixels packed like the other CPU
+    // OSD images: "A << 24 | B << 16 | G << 8 | R". "dstStride" is in pixels.
+    for (int y = 0; y < h; ++y)
+    {
+        quint32 *d = dst + y * dstStride;
+        const quint8 *m = alpha + y * alphaLinesize;
+        for (int x = 0; x < w; ++x)
+        {
+            const quint32 srcA = div255(a * m[x]);
+            const quint32 dstA = 255 - srcA;
+            const quint32 pixel = d[x];
+            d[x] =
+                (srcA + div255((pixel >> 24) * dstA)) << 24 |
+                (div255(b * srcA) + div255(((pixel >> 16) & 0xFF) * dstA)) << 16 |
+                (div255(g * srcA) + div255(((pixel >> 8) & 0xFF) * dstA)) << 8 |
+                (div255(r * srcA) + div255((pixel & 0xFF) * dstA))
+            ;
+        }
+    }
+}
+static void blendOSDtoYV12(quint8 *const data[3], const int linesize[2], const QImage &osdImg, const QRect &bounds)
+{
+    // "osdImg" is premultiplied, so the BT.601 offsets are scaled by alpha, e.g. "Y = (66R + 129G + 25B) / 256 + 16A / 255".
+    // Chroma is blended using the average of the 2x2 block. Everything is computed in 16.16 fixed point without branches.
+
+    auto div255 = [](quint32 x)->quint32 {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    };
+
+    const int osdW = osdImg.width();
+    const quint32 *osdImgData = reinterpret_cast<const quint32 *>(osdImg.constBits());
+
+    for (int h = bounds.top(); h <= bounds.bottom(); ++h)
+    {
+        const quint32 *src = osdImgData + h * osdW;
+        quint8 *dstY = data[0] + h * linesize[0];
+        for (int w = bounds.left(); w <= bounds.right(); ++w)
+        {
+            const quint32 pixel = src[w];
+            const quint32 A = pixel >> 24;
+            const quint32 B = (pixel >> 16) & 0xFF;
+            const quint32 G = (pixel >> 8) & 0xFF;
+            const quint32 R = pixel & 0xFF;
+            const quint32 Y = ((66 * R + 129 * G + 25 * B) * 256 + A * 4112 + 32768) >> 16;
+            dstY[w] = Y + div255(dstY[w] * (255 - A));
+        }
+    }
+
+    const int chromaW = osdW >> 1;
+    const int chromaH = osdImg.height() >> 1;
+    const int chromaTop = bounds.top() >> 1;
+    const int chromaBottom = qMin(bounds.bottom() >> 1, chromaH - 1);
+    const int chromaLeft = bounds.left() >> 1;
+    const int chromaRight = qMin(bounds.right() >> 1, chromaW - 1);
+    for (int h = chromaTop; h <= chromaBottom; ++h)
+    {
+        const quint32 *src0 = osdImgData + (h * 2) * osdW;
+        const quint32 *src1 = src0 + osdW;
+        quint8 *dstCb = data[1] + h * linesize[1];
+        quint8 *dstCr = data[2] + h * linesize[1];
+        for (int w = chromaLeft; w <= chromaRight; ++w)
+        {
+            const quint32 p[4] = {src0[w * 2], src0[w * 2 + 1], src1[w * 2], src1[w * 2 + 1]};
+            quint32 A = 0, B = 0, G = 0, R = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                A += p[i] >> 24;
+                B += (p[i] >> 16) & 0xFF;
+                G += (p[i] >> 8) & 0xFF;
+                R += p[i] & 0xFF;
+            }
+            // Sums of 4 pixels, so "64" instead of "256" and "8224" instead of "32896"
+            // Never negative, because premultiplied components can't exceed alpha
+            const quint32 Cb = ((112 * (int)B - 38 * (int)R - 74 * (int)G) * 64 + (int)A * 8224 + 32768) >> 16;
+            const quint32 Cr = ((112 * (int)R - 94 * (int)G - 18 * (int)B) * 64 + (int)A * 8224 + 32768) >> 16;
+            const quint32 iA = 255 - ((A + 2) >> 2);
+            dstCb[w] = Cb + div255(dstCb[w] * iA);
+            dstCr[w] = Cr + div255(dstCr[w] * iA);
+        }
+    }
+}
+void Functions::paintOSDtoYV12(quint8 *imageData, QImage &osdImg, QRect &osdBounds, int W, int H, int linesizeLuma, int linesizeChroma, const QMPlay2OSDList &osd_list, OsdIdList &osd_ids)
 {
     QRect bounds;
     const int osdW = osdImg.width();
@@ -449,67 +544,38 @@ void Functions::paintOSDtoYV12(quint8 *imageData, QImage &osdImg, int W, int H,
     const qreal iScaleW = (qreal)osdW / W, iScaleH = (qreal)imgH / H;
     const qreal scaleW = (qreal)W / osdW, scaleH = (qreal)H / imgH;
     const bool mustRepaint = Functions::mustRepaintOSD(osd_list, osd_ids, &scaleW, &scaleH, &bounds);
-    bounds = QRect(floor(bounds.x() * iScaleW), floor(bounds.y() * iScaleH), ceil(bounds.width() * iScaleW), ceil(bounds.height() * iScaleH)) & QRect(0, 0, osdW, imgH);
-    quint32 *osdImgData = (quint32 *)osdImg.constBits();
+    bounds = QRect(floor(bounds.x() * iScaleW), floor(bounds.y() * iScaleH), ceil(bounds.width() * iScaleW), ceil(bounds.height() * iScaleH));
+    // Align to the chroma subsampling
+    bounds.setLeft(bounds.left() & ~1);
+    bounds.setTop(bounds.top() & ~1);
+    bounds.setRight(bounds.right() | 1);
+    bounds.setBottom(bounds.bottom() | 1);
+    bounds &= QRect(0, 0, osdW, imgH);
     if (mustRepaint)
     {
-        for (int h = bounds.top(); h <= bounds.bottom(); ++h)
-            memset(osdImgData + (h * osdW + bounds.left()), 0, bounds.width() << 2);
+        // Clear only the previously painted area
+        const QRect dirty = osdBounds & QRect(0, 0, osdW, imgH);
+        quint32 *osdImgData = (quint32 *)osdImg.bits();
+        for (int h = dirty.top(); h <= dirty.bottom(); ++h)
+            memset(osdImgData + (h * osdW + dirty.left()), 0, dirty.width() << 2);
         QPainter p(&osdImg);
+        p.setClipRect(bounds);
         p.setRenderHint(QPainter::SmoothPixmapTransform);
         p.scale(iScaleW, iScaleH);
         Functions::paintOSD(false, osd_list, scaleW, scaleH, p, &osd_ids);
+        osdBounds = bounds;
     }
 
+    if (bounds.isEmpty())
+        return;
+
     quint8 *data[3];
     data[0] = imageData;
     data[2] = data[0] + linesizeLuma * imgH;
     data[1] = data[2] + linesizeChroma * (imgH >> 1);
 
-    for (int h = bounds.top(); h <= bounds.bottom(); ++h)
-    {
-        const int fullLine = h * linesizeLuma;
-        const int halfLine = (h >> 1) * linesizeChroma;
-        const int line = h * osdW;
-
-        for (int w = bounds.left(); w <= bounds.right(); ++w)
-        {
-            const int pixelPos = fullLine + w;
-            const quint32 pixel = osdImgData[line + w];
-            const quint8 A = (pixel >> 24) & 0xFF;
-            if (A)
-            {
-                const quint8 iA = ~A & 0xFF;
-                const quint8  B = (pixel >> 16) & 0xFF;
-                const quint8  G = (pixel >> 8) & 0xFF;
-                const quint8  R = pixel & 0xFF;
-
-                const quint8 Y = ((R * 66) >> 8) + (G >> 1) + ((B * 25) >> 8) + 16;
-                if (A == 0xFF)
-                    data[0][pixelPos] = Y;
-                else
-                    data[0][pixelPos] = data[0][fullLine + w] * iA / 255 + Y * A / 255;
-
-                if (!(w & 1) && !(h & 1))
-                {
-                    const int pixelPos = halfLine + (w >> 1);
-                    const quint8 cB = -((R * 38 ) >> 8) - ((G * 74) >> 8) + ((B * 112) >> 8) + 128;
-                    const quint8 cR =  ((R * 112) >> 8) - ((G * 94) >> 8) - ((B * 18 ) >> 8) + 128;
-                    if (A == 0xFF)
-                    {
-                        data[1][pixelPos] = cB;
-                        data[2][pixelPos] = cR;
-                    }
-                    else
-                    {
-                        const int pixelPosAlpha = halfLine + (w >> 1);
-                        data[1][pixelPos] = data[1][pixelPosAlpha] * iA / 255 + cB * A / 255;
-                        data[2][pixelPos] = data[2][pixelPosAlpha] * iA / 255 + cR * A / 255;
-                    }
-                }
-            }
-        }
-    }
+    const int linesize[2] = {linesizeLuma, linesizeChroma};
+    blendOSDtoYV12(data, linesize, osdImg, bounds);
 }
 
 QPixmap Functions::applyDropShadow(const QPixmap &input, const qreal blurRadius, const QPointF &offset, const QColor &color)
@@ -573,6 +639,13 @@ int Functions::scaleEQValue(int val, int min, int max)
 
 QByteArray Functions::convertToASS(QString txt)
 {
+    txt.remove('\r');
+    txt.replace('\n', "\\N");
+
+    // Most subtitle lines are plain text
+    if (!txt.contains('&') && !txt.contains('<'))
+        return txt.toUtf8();
+
     txt.replace("&nbsp;", " ", Qt::CaseInsensitive);
     txt.replace("&lt;", "<", Qt::CaseInsensitive);
     txt.replace("&gt;", ">", Qt::CaseInsensitive);
@@ -586,11 +659,9 @@ QByteArray Functions::convertToASS(QString txt)
     txt.replace("</u>", "{\\u0}", Qt::CaseInsensitive);
     txt.replace("<s>", "{\\s1}", Qt::CaseInsensitive);
     txt.replace("</s>", "{\\s0}", Qt::CaseInsensitive);
-    txt.remove('\r');
-    txt.replace('\n', "\\N", Qt::CaseInsensitive);
 
     // Colors
-    const QRegularExpression colorRegExp(
+    static const QRegularExpression colorRegExp(
         R"(<font\s+color\s*=\s*\"?\#?(\w{6})\"?\s*>(.*)<\/font\s*>)",
         QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption
     );
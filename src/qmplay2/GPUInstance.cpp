@@ -28,6 +28,7 @@
 #   include <vulkan/VulkanInstance.hpp>
 #endif
 #include <VideoWriter.hpp>
+#include <Tracer.hpp>
 
 #include <QDebug>
 
@@ -35,6 +36,8 @@ using namespace std;
 
 shared_ptr<GPUInstance> GPUInstance::create()
 {
+    Tracer::Span traceSpan("GPUInstance::create", "video");
+
     auto &sets = QMPlay2Core.getSettings();
     auto renderer = sets.getString("Renderer");
 
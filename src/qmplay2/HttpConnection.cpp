@@ -0,0 +1,325 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <HttpConnection.hpp>
+
+#include <QUrl>
+
+extern "C"
+{
+    #include <libavformat/avio.h>
+    #include <libavutil/error.h>
+}
+
+using namespace std;
+
+constexpr int g_maxLineLength = 16 * 1024;
+constexpr int g_readChunkSize = 16 * 1024;
+constexpr chrono::seconds g_defaultKeepAliveTimeout(10);
+
+QByteArray HttpConnection::Response::header(const char *name) const
+{
+    for (auto &&header : headers)
+    {
+        if (qstricmp(header.first.constData(), name) == 0)
+            return header.second;
+    }
+    return QByteArray();
+}
+QList<QByteArray> HttpConnection::Response::headerValues(const char *name) const
+{
+    QList<QByteArray> values;
+    for (auto &&header : headers)
+    {
+        if (qstricmp(header.first.constData(), name) == 0)
+            values += header.second;
+    }
+    return values;
+}
+
+/**/
+
+QByteArray HttpConnection::getKey(const QUrl &url)
+{
+    const QString scheme = url.scheme().toLower();
+    if ((scheme != "http" && scheme != "https") || url.host().isEmpty())
+        return QByteArray();
+    const int port = url.port(scheme == "https" ? 443 : 80);
+    return scheme.toLatin1() + "://" + url.host(QUrl::FullyEncoded).toLatin1() + ":" + QByteArray::number(port);
+}
+
+HttpConnection::HttpConnection(const QByteArray &key)
+    : m_key(key)
+    , m_keepAliveTimeout(g_defaultKeepAliveTimeout)
+{}
+HttpConnection::~HttpConnection()
+{
+    avio_closep(&m_ctx);
+}
+
+void HttpConnection::setInterrupt(HttpInterrupt *interrupt)
+{
+    m_interrupt = interrupt;
+}
+
+bool HttpConnection::open()
+{
+    const int schemeIdx = m_key.indexOf("://");
+    const int portIdx = m_key.lastIndexOf(':');
+    if (schemeIdx < 0 || portIdx <= schemeIdx)
+        return false;
+
+    QByteArray host = m_key.mid(schemeIdx + 3, portIdx - schemeIdx - 3);
+    if (host.contains(':'))
+        host = "[" + host + "]"; // IPv6
+
+    const QByteArray url = (m_key.startsWith("https") ? "tls://" : "tcp://") + host + m_key.mid(portIdx);
+
+    AVIOInterruptCB interruptCB = {(int(*)(void *))HttpConnection::interruptCB, this};
+    return (avio_open2(&m_ctx, url.constData(), AVIO_FLAG_READ_WRITE, &interruptCB, nullptr) >= 0);
+}
+
+bool HttpConnection::sendRequest(const QByteArray &request, const QByteArray &body)
+{
+    if (!m_ctx || !m_bodyDone)
+        return false;
+
+    m_buffer.clear();
+    m_bufferPos = 0;
+    m_keepAlive = false;
+    ++m_requests;
+
+    avio_write(m_ctx, (const quint8 *)request.constData(), request.size());
+    if (!body.isEmpty())
+        avio_write(m_ctx, (const quint8 *)body.constData(), body.size());
+    avio_flush(m_ctx);
+
+    return (m_ctx->error >= 0);
+}
+bool HttpConnection::readResponse(Response &response)
+{
+    QByteArray line;
+    QByteArray version;
+
+    do
+    {
+        response = Response();
+
+        // Status line, skip "100 Continue" and other informational responses
+        if (!readLine(line))
+            return false;
+        const QList<QByteArray> statusLine = line.split(' ');
+        if (statusLine.count() < 2 || !statusLine[0].startsWith("HTTP/"))
+            return false;
+        version = statusLine[0];
+        response.status = statusLine[1].toInt();
+        if (response.status < 100)
+            return false;
+
+        for (;;)
+        {
+            if (!readLine(line))
+                return false;
+            if (line.isEmpty())
+                break;
+            const int idx = line.indexOf(':');
+            if (idx > 0)
+                response.headers += {line.left(idx).trimmed(), line.mid(idx + 1).trimmed()};
+        }
+    } while (response.status < 200);
+
+    const QByteArray connection = response.header("Connection").toLower();
+    if (version == "HTTP/1.0")
+        m_keepAlive = connection.contains("keep-alive");
+    else
+        m_keepAlive = !connection.contains("close");
+
+    const QByteArray keepAlive = response.header("Keep-Alive");
+    const int timeoutIdx = keepAlive.indexOf("timeout=");
+    if (timeoutIdx > -1)
+    {
+        const int timeout = keepAlive.mid(timeoutIdx + 8).split(',').at(0).trimmed().toInt();
+        if (timeout > 0)
+            m_keepAliveTimeout = min(chrono::seconds(timeout - 1), g_defaultKeepAliveTimeout);
+        else
+            m_keepAlive = false;
+    }
+
+    m_chunked = response.header("Transfer-Encoding").toLower().contains("chunked");
+    m_chunkRemaining = 0;
+
+    bool ok = false;
+    m_contentLength = response.header("Content-Length").toLongLong(&ok);
+    if (!ok || m_contentLength < 0 || m_chunked)
+        m_contentLength = -1;
+
+    if (response.status == 204 || response.status == 304)
+        m_contentLength = 0;
+
+    m_bodyRemaining = m_contentLength;
+    m_bodyDone = (m_bodyRemaining == 0);
+
+    if (!m_chunked && m_contentLength < 0)
+        m_keepAlive = false; // Body ends when the connection is closed
+
+    return true;
+}
+
+int HttpConnection::readBody(quint8 *data, int size)
+{
+    if (m_bodyDone)
+        return 0;
+
+    if (m_chunked)
+    {
+        QByteArray line;
+        if (m_chunkRemaining == 0)
+        {
+            if (!readLine(line))
+                return -1;
+            bool ok = false;
+            m_chunkRemaining = line.split(';').at(0).trimmed().toLongLong(&ok, 16);
+            if (!ok || m_chunkRemaining < 0)
+                return -1;
+            if (m_chunkRemaining == 0)
+            {
+                // Skip trailers
+                do
+                {
+                    if (!readLine(line))
+                        return -1;
+                } while (!line.isEmpty());
+                m_bodyDone = true;
+                return 0;
+            }
+        }
+
+        const int received = readRaw(data, min<qint64>(size, m_chunkRemaining));
+        if (received <= 0)
+            return -1;
+
+        m_chunkRemaining -= received;
+        if (m_chunkRemaining == 0 && (!readLine(line) || !line.isEmpty()))
+            return -1;
+
+        return received;
+    }
+
+    const int received = readRaw(data, (m_bodyRemaining < 0) ? size : min<qint64>(size, m_bodyRemaining));
+    if (received < 0)
+        return -1;
+    if (received == 0)
+    {
+        if (m_bodyRemaining > 0)
+            return -1;
+        m_bodyDone = true;
+        return 0;
+    }
+
+    if (m_bodyRemaining > 0 && (m_bodyRemaining -= received) == 0)
+        m_bodyDone = true;
+
+    return received;
+}
+bool HttpConnection::skipBody(int maxSize)
+{
+    quint8 data[4096];
+    int skipped = 0;
+    while (skipped <= maxSize)
+    {
+        const int received = readBody(data, sizeof data);
+        if (received <= 0)
+            return (received == 0);
+        skipped += received;
+    }
+    return false;
+}
+
+bool HttpConnection::canReuse() const
+{
+    return (m_ctx && m_keepAlive && m_bodyDone && m_bufferPos >= m_buffer.size());
+}
+
+void HttpConnection::setIdle()
+{
+    m_interrupt = nullptr;
+    m_idleDeadline = Clock::now() + m_keepAliveTimeout;
+}
+bool HttpConnection::isExpired(Clock::time_point now) const
+{
+    return (now >= m_idleDeadline);
+}
+
+int HttpConnection::interruptCB(HttpConnection *connection)
+{
+    if (HttpInterrupt *interrupt = connection->m_interrupt)
+    {
+        interrupt->afterOpen = true;
+        return interrupt->aborted;
+    }
+    return 0;
+}
+
+int HttpConnection::readRaw(quint8 *data, int size)
+{
+    if (m_bufferPos < m_buffer.size())
+    {
+        const int n = min(size, m_buffer.size() - m_bufferPos);
+        memcpy(data, m_buffer.constData() + m_bufferPos, n);
+        m_bufferPos += n;
+        return n;
+    }
+    const int received = avio_read_partial(m_ctx, data, size);
+    if (received == AVERROR_EOF)
+        return 0;
+    return received;
+}
+bool HttpConnection::fillBuffer()
+{
+    if (m_bufferPos > 0)
+    {
+        m_buffer.remove(0, m_bufferPos);
+        m_bufferPos = 0;
+    }
+    const int oldSize = m_buffer.size();
+    m_buffer.resize(oldSize + g_readChunkSize);
+    const int received = avio_read_partial(m_ctx, (quint8 *)m_buffer.data() + oldSize, g_readChunkSize);
+    m_buffer.resize(oldSize + max(received, 0));
+    return (received > 0);
+}
+bool HttpConnection::readLine(QByteArray &line)
+{
+    int searchPos = m_bufferPos;
+    for (;;)
+    {
+        const int idx = m_buffer.indexOf('\n', searchPos);
+        if (idx > -1)
+        {
+            line = m_buffer.mid(m_bufferPos, idx - m_bufferPos);
+            if (line.endsWith('\r'))
+                line.chop(1);
+            m_bufferPos = idx + 1;
+            return true;
+        }
+        if (m_buffer.size() - m_bufferPos > g_maxLineLength)
+            return false;
+        searchPos = m_buffer.size() - m_bufferPos;
+        if (!fillBuffer())
+            return false;
+    }
+}
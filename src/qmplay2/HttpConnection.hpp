@@ -0,0 +1,114 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+
+#include <chrono>
+#include <atomic>
+
+struct AVIOContext;
+class QUrl;
+
+struct HttpInterrupt
+{
+    std::atomic_bool aborted {false};
+    std::atomic_bool afterOpen {false};
+};
+
+/* Persistent HTTP/1.1 connection over FFmpeg "tcp" or "tls" protocols */
+
+class HttpConnection
+{
+    Q_DISABLE_COPY(HttpConnection)
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Response
+    {
+        QByteArray header(const char *name) const;
+        QList<QByteArray> headerValues(const char *name) const;
+
+        int status = 0;
+        QList<QPair<QByteArray, QByteArray>> headers;
+    };
+
+    static QByteArray getKey(const QUrl &url); // Empty if the URL scheme is not supported
+
+    HttpConnection(const QByteArray &key);
+    ~HttpConnection();
+
+    inline QByteArray key() const
+    {
+        return m_key;
+    }
+    inline bool isReused() const
+    {
+        return m_requests > 0;
+    }
+    inline qint64 contentLength() const
+    {
+        return m_contentLength;
+    }
+
+    void setInterrupt(HttpInterrupt *interrupt);
+
+    bool open();
+
+    bool sendRequest(const QByteArray &request, const QByteArray &body);
+    bool readResponse(Response &response);
+
+    int readBody(quint8 *data, int size); // Returns 0 at the end of body, negative value on error
+    bool skipBody(int maxSize);
+
+    bool canReuse() const;
+
+    void setIdle();
+    bool isExpired(Clock::time_point now) const;
+
+private:
+    static int interruptCB(HttpConnection *connection);
+
+    int readRaw(quint8 *data, int size);
+    bool fillBuffer();
+    bool readLine(QByteArray &line);
+
+private:
+    const QByteArray m_key;
+
+    HttpInterrupt *m_interrupt = nullptr;
+    AVIOContext *m_ctx = nullptr;
+
+    QByteArray m_buffer;
+    int m_bufferPos = 0;
+
+    int m_requests = 0;
+    bool m_keepAlive = false;
+    std::chrono::seconds m_keepAliveTimeout;
+    Clock::time_point m_idleDeadline;
+
+    qint64 m_contentLength = -1;
+    qint64 m_bodyRemaining = -1;
+    qint64 m_chunkRemaining = 0;
+    bool m_chunked = false;
+    bool m_bodyDone = true;
+};
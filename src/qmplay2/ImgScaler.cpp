@@ -27,14 +27,39 @@
 extern "C"
 {
     #include <libswscale/swscale.h>
+    #include <libavutil/frame.h>
+    #include <libavutil/opt.h>
 }
 
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+#   define SWS_SLICE_THREADS
+#endif
+
+#ifdef SWS_SLICE_THREADS
+static void freeNothing(void *, uint8_t *)
+{}
+
+// Wraps the data without copying, "sws_scale_frame()" requires reference counted frames
+static void wrapFrame(AVFrame *frame, int w, int h, AVPixelFormat pixFmt, const uint8_t *const data[4], const int linesize[4])
+{
+    frame->width = w;
+    frame->height = h;
+    frame->format = pixFmt;
+    for (int i = 0; i < 4; ++i)
+    {
+        frame->data[i] = const_cast<uint8_t *>(data[i]);
+        frame->linesize[i] = linesize[i];
+    }
+    frame->buf[0] = av_buffer_create(frame->data[0], 1, freeNothing, nullptr, 0);
+}
+#endif
+
 ImgScaler::ImgScaler() :
     m_swsCtx(nullptr),
     m_srcH(0), m_dstLinesize(0)
 {}
 
-bool ImgScaler::create(const Frame &videoFrame, int newWdst, int newHdst)
+bool ImgScaler::create(const Frame &videoFrame, int newWdst, int newHdst, int threads)
 {
     if (videoFrame.isEmpty())
         return false;
@@ -43,21 +68,75 @@ bool ImgScaler::create(const Frame &videoFrame, int newWdst, int newHdst)
         newWdst = videoFrame.width();
     if (newHdst < 0)
         newHdst = videoFrame.height();
+#ifndef SWS_SLICE_THREADS
+    threads = 1;
+#endif
+
+    const bool changed = (
+        !m_swsCtx ||
+        m_srcW != videoFrame.width() ||
+        m_srcH != videoFrame.height() ||
+        m_srcPixFmt != videoFrame.pixelFormat() ||
+        m_dstW != newWdst ||
+        m_dstH != newHdst ||
+        m_threads != threads
+    );
+
+    m_srcW = videoFrame.width();
     m_srcH = videoFrame.height();
+    m_srcPixFmt = videoFrame.pixelFormat();
+    m_dstW = newWdst;
+    m_dstH = newHdst;
     m_dstLinesize = newWdst << 2;
-    m_swsCtx = sws_getCachedContext(
-        m_swsCtx,
-        videoFrame.width(),
-        m_srcH,
-        videoFrame.pixelFormat(),
-        newWdst,
-        newHdst,
-        AV_PIX_FMT_RGB32,
-        SWS_BILINEAR,
-        nullptr,
-        nullptr,
-        nullptr
-    );
+
+    if (changed)
+    {
+        if (m_threads != threads)
+            destroy();
+        m_threads = threads;
+
+#ifdef SWS_SLICE_THREADS
+        if (threads > 1)
+        {
+            destroy();
+            m_swsCtx = sws_alloc_context();
+            av_opt_set_int(m_swsCtx, "srcw", m_srcW, 0);
+            av_opt_set_int(m_swsCtx, "srch", m_srcH, 0);
+            av_opt_set_int(m_swsCtx, "src_format", m_srcPixFmt, 0);
+            av_opt_set_int(m_swsCtx, "dstw", m_dstW, 0);
+            av_opt_set_int(m_swsCtx, "dsth", m_dstH, 0);
+            av_opt_set_int(m_swsCtx, "dst_format", AV_PIX_FMT_RGB32, 0);
+            av_opt_set_int(m_swsCtx, "sws_flags", SWS_BILINEAR, 0);
+            av_opt_set_int(m_swsCtx, "threads", threads, 0);
+            if (sws_init_context(m_swsCtx, nullptr, nullptr) < 0)
+                destroy();
+        }
+        else
+#endif
+        {
+            m_swsCtx = sws_getCachedContext(
+                m_swsCtx,
+                m_srcW,
+                m_srcH,
+                m_srcPixFmt,
+                m_dstW,
+                m_dstH,
+                AV_PIX_FMT_RGB32,
+                SWS_BILINEAR,
+                nullptr,
+                nullptr,
+                nullptr
+            );
+        }
+
+        // New context has default colorspace details
+        m_colorAdjusted = false;
+        m_colorDirty = m_useColorAdjustment;
+    }
+
+    if (m_swsCtx && m_useColorAdjustment && (m_colorDirty || m_colorSpace != videoFrame.colorSpace() || m_isLimited != videoFrame.isLimited()))
+        applyColorAdjustment(videoFrame);
+
     return (bool)m_swsCtx;
 }
 bool ImgScaler::scale(const Frame &src, void *dst)
@@ -66,6 +145,24 @@ bool ImgScaler::scale(const Frame &src, void *dst)
     const uint8_t *srcData[3] = {};
 
     auto swsScale = [&](int *srcLinesize) {
+#ifdef SWS_SLICE_THREADS
+        if (m_threads > 1)
+        {
+            const uint8_t *srcData4[4] = {srcData[0], srcData[1], srcData[2]};
+            const int srcLinesize4[4] = {srcLinesize[0], srcLinesize[1], srcLinesize[2]};
+            const uint8_t *dstData4[4] = {static_cast<uint8_t *>(dst)};
+            const int dstLinesize4[4] = {m_dstLinesize};
+
+            AVFrame *srcFrame = av_frame_alloc();
+            AVFrame *dstFrame = av_frame_alloc();
+            wrapFrame(srcFrame, m_srcW, m_srcH, m_srcPixFmt, srcData4, srcLinesize4);
+            wrapFrame(dstFrame, m_dstW, m_dstH, AV_PIX_FMT_RGB32, dstData4, dstLinesize4);
+            sws_scale_frame(m_swsCtx, dstFrame, srcFrame);
+            av_frame_free(&dstFrame);
+            av_frame_free(&srcFrame);
+            return;
+        }
+#endif
         sws_scale(m_swsCtx, srcData, srcLinesize, 0, m_srcH, (uint8_t **)&dst, &m_dstLinesize);
     };
 
@@ -115,3 +212,36 @@ void ImgScaler::destroy()
         m_swsCtx = nullptr;
     }
 }
+
+void ImgScaler::setColorAdjustment(int brightness, int contrast, int saturation)
+{
+    if (m_useColorAdjustment && m_brightness == brightness && m_contrast == contrast && m_saturation == saturation)
+        return;
+
+    m_useColorAdjustment = true;
+    m_colorDirty = true;
+    m_brightness = brightness;
+    m_contrast = contrast;
+    m_saturation = saturation;
+}
+
+void ImgScaler::applyColorAdjustment(const Frame &videoFrame)
+{
+    m_colorSpace = videoFrame.colorSpace();
+    m_isLimited = videoFrame.isLimited();
+    m_colorDirty = false;
+
+    // Adjusting the conversion coefficients costs nothing per pixel, unlike a separate "Functions::ImageEQ()" pass.
+    // "SWS_CS_*" values match "AVColorSpace", unknown values fall back to BT.601.
+    // Brightness, contrast and saturation are 16.16 fixed point numbers.
+    m_colorAdjusted = sws_setColorspaceDetails(
+        m_swsCtx,
+        sws_getCoefficients(m_colorSpace),
+        !m_isLimited,
+        sws_getCoefficients(SWS_CS_DEFAULT),
+        1,
+        (m_brightness * 65536 + 50) / 100,
+        ((m_contrast + 100) * 65536 + 50) / 100,
+        ((m_saturation + 100) * 65536 + 50) / 100
+    ) >= 0;
+}
@@ -20,6 +20,10 @@
 
 #include <QMPlay2Lib.hpp>
 
+extern "C" {
+    #include <libavutil/pixfmt.h>
+}
+
 /* YUV planar to RGB32 */
 
 struct SwsContext;
@@ -34,11 +38,31 @@ public:
         destroy();
     }
 
-    bool create(const Frame &videoFrame, int newWdst = -1, int newHdst = -1);
+    // "threads" > 1 scales in parallel slices (requires FFmpeg 5.0 or newer)
+    bool create(const Frame &videoFrame, int newWdst = -1, int newHdst = -1, int threads = 1);
     bool scale(const Frame &videoFrame, void *dst = nullptr);
     void scale(const void *src[], const int srcLinesize[], void *dst);
     void destroy();
+
+    // Brightness, contrast and saturation (-100..100) applied during YUV to RGB conversion,
+    // it also uses the colorspace and range of the frame. Takes effect on next "create()".
+    void setColorAdjustment(int brightness, int contrast, int saturation);
+    inline bool hasColorAdjustment() const
+    {
+        return m_colorAdjusted;
+    }
+
 private:
+    void applyColorAdjustment(const Frame &videoFrame);
+
     SwsContext *m_swsCtx;
     int m_srcH, m_dstLinesize;
+
+    int m_srcW = 0, m_dstW = 0, m_dstH = 0, m_threads = 1;
+    AVPixelFormat m_srcPixFmt = AV_PIX_FMT_NONE;
+
+    bool m_useColorAdjustment = false, m_colorAdjusted = false, m_colorDirty = false;
+    int m_brightness = 0, m_contrast = 0, m_saturation = 0;
+    AVColorSpace m_colorSpace = AVCOL_SPC_UNSPECIFIED;
+    bool m_isLimited = true;
 };
@@ -30,11 +30,16 @@ extern "C" {
 #include <ass/ass.h>
 }
 
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 
 using namespace std;
 
+constexpr int g_renderAheadFrames = 3;
+constexpr int g_maxASSFrames = 16;
+constexpr size_t g_maxRGBABuffers = 8;
+
 #ifdef USE_VULKAN
 #   include "../qmvk/PhysicalDevice.hpp"
 #   include "../qmvk/Device.hpp"
@@ -189,32 +194,85 @@ bool LibASS::addImgs(ass_image *img, QMPlay2OSD *osd)
     }
 #endif
 
-    while (img)
+    // Group overlapping images, every group is composited into a single premultiplied RGBA image
+    QVector<QRect> groups;
+    for (ASS_Image *groupImg = img; groupImg; groupImg = groupImg->next)
+    {
+        if (groupImg->w <= 0 || groupImg->h <= 0)
+            continue;
+
+        QRect rect(groupImg->dst_x, groupImg->dst_y, groupImg->w, groupImg->h);
+        for (int i = groups.size() - 1; i >= 0; --i)
+        {
+            if (groups[i].intersects(rect))
+            {
+                rect |= groups[i];
+                groups.removeAt(i);
+                i = groups.size(); // The merged group might intersect with other groups now
+            }
+        }
+        groups.append(rect);
+    }
+
+    for (auto &&groupRect : std::as_const(groups))
     {
         auto &osdImg = osd->add();
-        osdImg.rect = QRect(img->dst_x, img->dst_y, img->w, img->h);
-        osdImg.size = QSize(img->w, img->h);
-        osdImg.rgba = QByteArray(img->w * img->h * sizeof(uint32_t), Qt::Uninitialized);
+        osdImg.rect = groupRect;
+        osdImg.size = groupRect.size();
+        osdImg.rgba = takeRGBABuffer(groupRect.width() * groupRect.height() * sizeof(quint32));
+        osdImg.premultiplied = true;
 
-        const quint8 r = img->color >> 24;
-        const quint8 g = img->color >> 16;
-        const quint8 b = img->color >>  8;
-        const quint8 a = ~img->color & 0xFF;
+        auto canvas = reinterpret_cast<quint32 *>(osdImg.rgba.data());
+        const int canvasStride = groupRect.width();
 
-        auto data = reinterpret_cast<uint32_t *>(osdImg.rgba.data());
-        for (int y = 0; y < img->h; y++)
+        for (ASS_Image *groupImg = img; groupImg; groupImg = groupImg->next)
         {
-            const int offsetI = y * img->stride;
-            const int offsetB = y * img->w;
-            for (int x = 0; x < img->w; x++)
-                data[offsetB + x] = (a * img->bitmap[offsetI + x] / 0xFF) << 24 | b << 16 | g << 8 | r;
-        }
+            if (groupImg->w <= 0 || groupImg->h <= 0 || !groupRect.contains(QRect(groupImg->dst_x, groupImg->dst_y, groupImg->w, groupImg->h)))
+                continue;
 
-        img = img->next;
+            const int offset = (groupImg->dst_y - groupRect.y()) * canvasStride + (groupImg->dst_x - groupRect.x());
+            Functions::blendAlphaToRGBA(
+                canvas + offset,
+                canvasStride,
+                groupImg->bitmap,
+                groupImg->stride,
+                groupImg->w,
+                groupImg->h,
+                groupImg->color >> 24,
+                groupImg->color >> 16,
+                groupImg->color >> 8,
+                ~groupImg->color
+            );
+        }
     }
 
     return true;
 }
+QByteArray LibASS::takeRGBABuffer(int size)
+{
+    lock_guard<mutex> locker(m_rgbaBuffersMutex);
+
+    // A buffer is free when no OSD (including the cached ones) references it anymore
+    QByteArray *buffer = nullptr;
+    for (auto &&rgbaBuffer : m_rgbaBuffers)
+    {
+        if (!rgbaBuffer.isDetached())
+            continue;
+        if (!buffer || (buffer->capacity() < size && rgbaBuffer.capacity() > buffer->capacity()))
+            buffer = &rgbaBuffer;
+    }
+    if (!buffer && m_rgbaBuffers.size() < g_maxRGBABuffers)
+    {
+        m_rgbaBuffers.emplace_back();
+        buffer = &m_rgbaBuffers.back();
+    }
+    if (!buffer)
+        return QByteArray(size, '\0');
+
+    buffer->resize(size); // Doesn't reallocate if the capacity is enough
+    buffer->fill('\0');
+    return *buffer;
+}
 
 void LibASS::setWindowSize(const QSize &winSize)
 {
@@ -240,6 +298,7 @@ void LibASS::setFontScale(double fs)
 
 void LibASS::addFont(const QByteArray &name, const QByteArray &data)
 {
+    lock_guard<mutex> locker(m_assMutex);
     ass_add_font(m_subsAss, (char *)name.constData(), (char *)data.constData(), data.size());
 }
 
@@ -314,9 +373,14 @@ void LibASS::closeOSD()
 
 void LibASS::initASS(const QByteArray &ass_data)
 {
+    lock_guard<mutex> locker(m_assMutex);
+    lock_guard<mutex> framesLocker(m_assFramesMutex);
+
     if (ass_sub_track && ass_sub_renderer)
         return;
 
+    m_appliedFontScale = 1.0;
+
     ass_sub_track = ass_new_track(m_subsAss);
     if (!ass_data.isEmpty())
     {
@@ -324,28 +388,45 @@ void LibASS::initASS(const QByteArray &ass_data)
         for (int i = 0; i < ass_sub_track->n_events; ++i)
             ass_sub_track->events[i].ReadOrder = i;
         hasASSData = true;
-        setASSStyle();
+        setASSStyleNoLock();
     }
     else
     {
         ass_alloc_style(ass_sub_track);
         ass_sub_track->styles[0].ScaleX = ass_sub_track->styles[0].ScaleY = 1;
         hasASSData = false;
-        setASSStyle();
+        setASSStyleNoLock();
     }
 
     ass_sub_renderer = ass_renderer_init(m_subsAss);
     ass_set_fonts(ass_sub_renderer, nullptr, nullptr, true, nullptr, true);
+
+    m_renderAheadThr = thread(&LibASS::renderAheadThr, this);
 }
 bool LibASS::isASS() const
 {
     return hasASSData && ass_sub_track && ass_sub_renderer;
 }
 void LibASS::setASSStyle()
+{
+    lock_guard<mutex> locker(m_assMutex);
+    quint64 framesGeneration;
+    applyQueuedASSEvents(framesGeneration);
+    lock_guard<mutex> framesLocker(m_assFramesMutex);
+    setASSStyleNoLock();
+    m_lastRendered.valid = false;
+    m_lastRendered.osd.reset();
+}
+void LibASS::setASSStyleNoLock()
 {
     if (!ass_sub_track)
         return;
 
+    invalidateASSFrames();
+
+    // Styles are modified below, so restore the original scale first
+    applyFontScale(1.0);
+
     if (!hasASSData)
     {
         readStyle("Subtitles", &ass_sub_track->styles[0]);
@@ -455,110 +536,142 @@ void LibASS::setASSStyle()
 }
 void LibASS::addASSEvent(const QByteArray &event)
 {
-    if (!ass_sub_track || !ass_sub_renderer || event.isEmpty())
+    if (event.isEmpty())
         return;
-    ass_process_data(ass_sub_track, (char *)event.constData(), event.size());
+    // Processed later, so it must not refer to the packet data (e.g. "QByteArray::fromRawData()")
+    const QByteArray data(event.constData(), event.size());
+    queueASSEvents([=] {
+        ass_process_data(ass_sub_track, const_cast<char *>(data.constData()), data.size());
+    });
 }
 void LibASS::addASSEvents(const QList<QByteArray> &events, double start, double duration)
 {
-    if (!ass_sub_track || !ass_sub_renderer || events.isEmpty())
+    if (events.isEmpty())
         return;
-
-    for (auto &&event : events)
-    {
-        ass_process_chunk(ass_sub_track, const_cast<char *>(event.constData()), event.size(), start * 1000, duration * 1000);
-    }
+    queueASSEvents([=] {
+        for (auto &&event : events)
+        {
+            ass_process_chunk(ass_sub_track, const_cast<char *>(event.constData()), event.size(), start * 1000, duration * 1000);
+        }
+    }, start * 1000, (start + duration) * 1000);
 }
 void LibASS::addASSEvent(const QByteArray &text, double Start, double Duration)
 {
-    if (!ass_sub_track || !ass_sub_renderer || text.isEmpty() || Start < 0 || Duration < 0)
+    if (text.isEmpty() || Start < 0 || Duration < 0)
         return;
-    int eventID = ass_alloc_event(ass_sub_track);
-    ASS_Event *event = &ass_sub_track->events[eventID];
-    event->Text = strdup(text.constData());
-    event->Start = Start * 1000;
-    event->Duration = Duration * 1000;
-    event->Style = 0;
-    event->ReadOrder = eventID;
+    const qint64 startMs = Start * 1000;
+    const qint64 durationMs = Duration * 1000;
+    queueASSEvents([=] {
+        int eventID = ass_alloc_event(ass_sub_track);
+        ASS_Event *event = &ass_sub_track->events[eventID];
+        event->Text = strdup(text.constData());
+        event->Start = startMs;
+        event->Duration = durationMs;
+        event->Style = 0;
+        event->ReadOrder = eventID;
+    }, startMs, startMs + durationMs);
 }
 void LibASS::flushASSEvents()
 {
-    if (!ass_sub_track || !ass_sub_renderer)
-        return;
-    ass_flush_events(ass_sub_track);
+    queueASSEvents([=] {
+        ass_flush_events(ass_sub_track);
+    });
 }
 bool LibASS::getASS(shared_ptr<QMPlay2OSD> &osd, double pos)
 {
-    if (!ass_sub_track || !ass_sub_renderer || !W || !H)
-        return false;
-
-    if (qIsNaN(pos))
-        pos = m_lastPos;
     if (qIsNaN(pos))
-        return false;
+    {
+        // Re-render the current subtitles in place (e.g. the window size has changed)
+        lock_guard<mutex> locker(m_assMutex);
 
-    double _fontScale = fontScale;
+        quint64 framesGeneration;
+        applyQueuedASSEvents(framesGeneration);
 
-    if (_fontScale != 1.0)
-    {
-        for (int i = 0; i < ass_sub_track->n_styles; i++)
+        ASSRenderParams params;
         {
-            ASS_Style &style = ass_sub_track->styles[i];
-            style.ScaleX  *= _fontScale;
-            style.ScaleY  *= _fontScale;
-            style.Shadow  *= _fontScale;
-            style.Outline *= _fontScale;
+            lock_guard<mutex> framesLocker(m_assFramesMutex);
+            if (!ass_sub_track || !ass_sub_renderer || !W || !H)
+                return false;
+            pos = m_lastPos;
+            if (qIsNaN(pos))
+                return false;
+            params = getASSRenderParams();
+            invalidateASSFrames();
         }
+
+        applyFontScale(params.fontScale);
+        ass_set_frame_size(ass_sub_renderer, params.W, params.H);
+        ass_set_margins(ass_sub_renderer, params.marginTB, params.marginTB, params.marginLR, params.marginLR);
+
+        int ch;
+        ASS_Image *img = ass_render_frame(ass_sub_renderer, ass_sub_track, pos * 1000, &ch);
+        m_lastRendered.valid = false;
+        m_lastRendered.osd.reset();
+        if (!img)
+            return false;
+
+        auto osdLocker = QMPlay2OSD::ensure(osd);
+        osd->clear();
+        osd->setPTS(pos);
+        if (addImgs(img, osd.get()))
+            osd->genId();
+        return true;
     }
 
-    ass_set_frame_size(ass_sub_renderer, W, H);
+    unique_lock<mutex> framesLocker(m_assFramesMutex);
 
-    const int marginLR = qMax(0, W / 2 - winW / 2);
-    const int marginTB = qMax(0, H / 2 - winH / 2);
-    ass_set_margins(ass_sub_renderer, marginTB, marginTB, marginLR, marginLR);
+    if (!ass_sub_track || !ass_sub_renderer || !W || !H)
+        return false;
 
-    int ch;
-    ASS_Image *img = ass_render_frame(ass_sub_renderer, ass_sub_track, pos * 1000, &ch);
+    const ASSRenderParams params = getASSRenderParams();
 
+    const qint64 ms = llround(pos * 1000.0);
+
+    const double frameStep = pos - m_lastPos;
+    if (frameStep > 0.0 && frameStep < 1.0)
+        m_frameStep = frameStep;
     m_lastPos = pos;
 
-    if (ch)
-        m_assIDs.clear();
+    const ASSFrame *frame = findASSFrame(ms, params);
+    const bool found = (frame != nullptr);
+    shared_ptr<QMPlay2OSD> frameOSD;
+    if (found)
+        frameOSD = frame->osd;
 
-    if (_fontScale != 1.0)
+    // Remove frames which won't be used anymore
+    m_assFrames.erase(remove_if(m_assFrames.begin(), m_assFrames.end(), [&](const ASSFrame &assFrame) {
+        return (assFrame.params != params || assFrame.endMs < ms);
+    }), m_assFrames.end());
+
+    m_renderAheadParams = params;
+    m_assCond.notify_one();
+
+    framesLocker.unlock();
+
+    if (!found)
     {
-        for (int i = 0; i < ass_sub_track->n_styles; i++)
-        {
-            ASS_Style &style = ass_sub_track->styles[i];
-            style.ScaleX  /= _fontScale;
-            style.ScaleY  /= _fontScale;
-            style.Shadow  /= _fontScale;
-            style.Outline /= _fontScale;
-        }
+        // Not rendered ahead (e.g. after seek), render it here unless the look-ahead
+        // thread is rendering now - don't wait for it. There are no subtitles for this
+        // position yet, the look-ahead thread renders it next.
+        unique_lock<mutex> locker(m_assMutex, try_to_lock);
+        if (!locker.owns_lock())
+            return false;
+        frameOSD = renderASSFrame(ms, params);
     }
 
-    if (!img)
+    if (!frameOSD)
         return false;
 
-    auto locker = QMPlay2OSD::ensure(osd);
-    if (osd->id() != 0 && m_assIDs.count(osd->id()) == 0)
-    {
-        osd->clear();
-    }
+    // Cached frames are shared, so they're never modified
+    osd = QMPlay2OSD::copy(frameOSD);
     osd->setPTS(pos);
-    if (osd->id() == 0)
-    {
-        if (addImgs(img, osd.get()))
-        {
-            osd->genId();
-            Q_ASSERT(osd->id() != 0);
-            m_assIDs.insert(osd->id());
-        }
-    }
     return true;
 }
 void LibASS::closeASS()
 {
+    stopRenderAhead();
+    lock_guard<mutex> locker(m_assMutex);
+    lock_guard<mutex> framesLocker(m_assFramesMutex);
     while (ass_sub_styles_copy.size())
     {
         ASS_Style *style = ass_sub_styles_copy.takeFirst();
@@ -574,7 +687,11 @@ void LibASS::closeASS()
     ass_sub_renderer = nullptr;
     ass_clear_fonts(m_subsAss);
     m_lastPos = qQNaN();
-    m_assIDs.clear();
+    m_frameStep = 0.0;
+    m_queuedASSEvents.clear();
+    invalidateASSFrames();
+    m_lastRendered.valid = false;
+    m_lastRendered.osd.reset();
 }
 
 void LibASS::readStyle(const QString &prefix, ASS_Style *style)
@@ -602,6 +719,200 @@ inline void LibASS::calcSize()
     Functions::getImageSize(aspect_ratio, zoom, winW, winH, W, H);
 }
 
+LibASS::ASSRenderParams LibASS::getASSRenderParams() const
+{
+    ASSRenderParams params;
+    params.W = W;
+    params.H = H;
+    params.marginLR = qMax(0, W / 2 - winW / 2);
+    params.marginTB = qMax(0, H / 2 - winH / 2);
+    params.fontScale = fontScale;
+    return params;
+}
+void LibASS::applyFontScale(double scale)
+{
+    if (scale == m_appliedFontScale)
+        return;
+
+    const double ratio = scale / m_appliedFontScale;
+    for (int i = 0; i < ass_sub_track->n_styles; i++)
+    {
+        ASS_Style &style = ass_sub_track->styles[i];
+        style.ScaleX  *= ratio;
+        style.ScaleY  *= ratio;
+        style.Shadow  *= ratio;
+        style.Outline *= ratio;
+    }
+    m_appliedFontScale = scale;
+}
+
+const LibASS::ASSFrame *LibASS::findASSFrame(qint64 ms, const ASSRenderParams &params) const
+{
+    for (auto &&assFrame : m_assFrames)
+    {
+        if (ms >= assFrame.startMs && ms <= assFrame.endMs && assFrame.params == params)
+            return &assFrame;
+    }
+    return nullptr;
+}
+shared_ptr<QMPlay2OSD> LibASS::renderASSFrame(qint64 ms, const ASSRenderParams &params)
+{
+    // Called with "m_assMutex" locked
+
+    quint64 framesGeneration;
+    if (applyQueuedASSEvents(framesGeneration))
+    {
+        m_lastRendered.valid = false;
+        m_lastRendered.osd.reset();
+    }
+
+    applyFontScale(params.fontScale);
+    ass_set_frame_size(ass_sub_renderer, params.W, params.H);
+    ass_set_margins(ass_sub_renderer, params.marginTB, params.marginTB, params.marginLR, params.marginLR);
+
+    int ch = 2;
+    ASS_Image *img = ass_render_frame(ass_sub_renderer, ass_sub_track, ms, &ch);
+
+    // libass reports no change since the previous render - reuse its images
+    const bool sameAsLast = (ch == 0 && m_lastRendered.valid && m_lastRendered.params == params);
+    const qint64 lastMs = m_lastRendered.ms;
+
+    shared_ptr<QMPlay2OSD> osd;
+    if (sameAsLast)
+    {
+        osd = m_lastRendered.osd;
+    }
+    else if (img)
+    {
+        osd = make_shared<QMPlay2OSD>();
+        if (addImgs(img, osd.get()))
+            osd->genId();
+    }
+
+    m_lastRendered.valid = true;
+    m_lastRendered.ms = ms;
+    m_lastRendered.params = params;
+    m_lastRendered.osd = osd;
+
+    lock_guard<mutex> framesLocker(m_assFramesMutex);
+
+    // Events were queued while rendering, the result might be outdated
+    if (framesGeneration != m_assFramesGeneration)
+        return osd;
+
+    // Extend the time range of the previous frame if it was close enough
+    const qint64 maxGapMs = llround(m_frameStep * 1000.0) + 1;
+    if (sameAsLast && qAbs(ms - lastMs) <= maxGapMs)
+    {
+        for (auto &&assFrame : m_assFrames)
+        {
+            if (assFrame.osd == osd && assFrame.params == params && lastMs >= assFrame.startMs && lastMs <= assFrame.endMs)
+            {
+                assFrame.startMs = qMin(assFrame.startMs, ms);
+                assFrame.endMs = qMax(assFrame.endMs, ms);
+                return osd;
+            }
+        }
+    }
+
+    if (m_assFrames.size() >= g_maxASSFrames)
+        m_assFrames.erase(m_assFrames.begin());
+    m_assFrames.push_back({ms, ms, params, osd});
+
+    return osd;
+}
+void LibASS::invalidateASSFrames(qint64 startMs, qint64 endMs)
+{
+    // Called with "m_assFramesMutex" locked
+
+    ++m_assFramesGeneration;
+
+    if (endMs < startMs)
+    {
+        m_assFrames.clear();
+        return;
+    }
+
+    m_assFrames.erase(remove_if(m_assFrames.begin(), m_assFrames.end(), [=](const ASSFrame &assFrame) {
+        return (assFrame.startMs <= endMs && assFrame.endMs >= startMs);
+    }), m_assFrames.end());
+}
+
+void LibASS::queueASSEvents(function<void()> &&fn, qint64 startMs, qint64 endMs)
+{
+    // Events are applied to the track before the next render, so adding them never waits for a render
+    lock_guard<mutex> framesLocker(m_assFramesMutex);
+    if (!ass_sub_track || !ass_sub_renderer)
+        return;
+    m_queuedASSEvents.push_back(move(fn));
+    invalidateASSFrames(startMs, endMs);
+    m_assCond.notify_one();
+}
+bool LibASS::applyQueuedASSEvents(quint64 &framesGeneration)
+{
+    // Called with "m_assMutex" locked
+
+    vector<function<void()>> queuedEvents;
+    {
+        lock_guard<mutex> framesLocker(m_assFramesMutex);
+        queuedEvents.swap(m_queuedASSEvents);
+        framesGeneration = m_assFramesGeneration;
+    }
+    for (auto &&fn : queuedEvents)
+        fn();
+    return !queuedEvents.empty();
+}
+
+bool LibASS::getNextRenderAheadMs(qint64 &ms) const
+{
+    // Called with "m_assFramesMutex" locked
+
+    if (m_frameStep <= 0.0 || qIsNaN(m_lastPos))
+        return false;
+
+    // Starts from the current position in case it wasn't rendered by "getASS()"
+    for (int i = 0; i <= g_renderAheadFrames; ++i)
+    {
+        ms = llround((m_lastPos + m_frameStep * i) * 1000.0);
+        if (!findASSFrame(ms, m_renderAheadParams))
+            return true;
+    }
+    return false;
+}
+void LibASS::renderAheadThr()
+{
+    for (;;)
+    {
+        qint64 ms = 0;
+        ASSRenderParams params;
+        {
+            unique_lock<mutex> framesLocker(m_assFramesMutex);
+            m_assCond.wait(framesLocker, [&] {
+                return (m_renderAheadStop || getNextRenderAheadMs(ms));
+            });
+            if (m_renderAheadStop)
+                break;
+            params = m_renderAheadParams;
+        }
+
+        lock_guard<mutex> locker(m_assMutex);
+        renderASSFrame(ms, params);
+    }
+}
+void LibASS::stopRenderAhead()
+{
+    if (!m_renderAheadThr.joinable())
+        return;
+
+    {
+        lock_guard<mutex> framesLocker(m_assFramesMutex);
+        m_renderAheadStop = true;
+    }
+    m_assCond.notify_one();
+    m_renderAheadThr.join();
+    m_renderAheadStop = false;
+}
+
 #else // QMPLAY2_LIBASS
 
 bool LibASS::isDummy()
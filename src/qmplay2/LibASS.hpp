@@ -23,8 +23,12 @@
 #include <QByteArray>
 #include <QList>
 
+#include <condition_variable>
+#include <functional>
 #include <memory>
-#include <set>
+#include <thread>
+#include <vector>
+#include <mutex>
 
 class Settings;
 class QMPlay2OSD;
@@ -76,10 +80,51 @@ public:
     void closeASS();
 
 private:
+    struct ASSRenderParams
+    {
+        inline bool operator ==(const ASSRenderParams &other) const
+        {
+            return (W == other.W && H == other.H && marginLR == other.marginLR && marginTB == other.marginTB && fontScale == other.fontScale);
+        }
+        inline bool operator !=(const ASSRenderParams &other) const
+        {
+            return !operator ==(other);
+        }
+
+        int W = 0, H = 0;
+        int marginLR = 0, marginTB = 0;
+        double fontScale = 1.0;
+    };
+    struct ASSFrame
+    {
+        // Time range (in ms) where the rendered images are the same
+        qint64 startMs, endMs;
+        ASSRenderParams params;
+        std::shared_ptr<QMPlay2OSD> osd; // "nullptr" if there is nothing to display
+    };
+
     void readStyle(const QString &, ass_style *);
     inline void calcSize();
 
+    void setASSStyleNoLock();
+
+    ASSRenderParams getASSRenderParams() const;
+    void applyFontScale(double scale);
+
+    void queueASSEvents(std::function<void()> &&fn, qint64 startMs = 0, qint64 endMs = -1);
+    bool applyQueuedASSEvents(quint64 &framesGeneration);
+
+    const ASSFrame *findASSFrame(qint64 ms, const ASSRenderParams &params) const;
+    std::shared_ptr<QMPlay2OSD> renderASSFrame(qint64 ms, const ASSRenderParams &params);
+    void invalidateASSFrames(qint64 startMs = 0, qint64 endMs = -1);
+
+    bool getNextRenderAheadMs(qint64 &ms) const;
+    void renderAheadThr();
+    void stopRenderAhead();
+
 private:
+    QByteArray takeRGBABuffer(int size);
+
     Settings &settings;
 
     ass_library *m_osdAss;
@@ -99,7 +144,34 @@ private:
     QList<ass_style *> ass_sub_styles_copy;
     bool hasASSData;
     double m_lastPos = qQNaN();
-    std::set<int> m_assIDs;
+    double m_appliedFontScale = 1.0;
+
+    // Render-ahead of the ASS subtitles:
+    // - "m_assMutex" guards the track and the renderer, it is held for the whole render,
+    // - "m_assFramesMutex" guards the rendered frames cache and the queued events, it is
+    //   never held while rendering, so looking up the cache never waits for a render.
+    // Changing the track pointers requires both mutexes (in this order).
+    std::mutex m_assMutex;
+    std::mutex m_assFramesMutex;
+    std::condition_variable m_assCond;
+    std::thread m_renderAheadThr;
+    bool m_renderAheadStop = false;
+    double m_frameStep = 0.0;
+    ASSRenderParams m_renderAheadParams;
+    std::vector<ASSFrame> m_assFrames;
+    quint64 m_assFramesGeneration = 0;
+    std::vector<std::function<void()>> m_queuedASSEvents;
+    struct
+    {
+        bool valid = false;
+        qint64 ms = 0;
+        ASSRenderParams params;
+        std::shared_ptr<QMPlay2OSD> osd;
+    } m_lastRendered;
+
+    // Composite images for the CPU path, reused between renders
+    std::mutex m_rgbaBuffersMutex;
+    std::vector<QByteArray> m_rgbaBuffers;
 
 #ifdef USE_VULKAN
     std::shared_ptr<QmVk::BufferPool> m_vkBufferPool;
@@ -18,6 +18,7 @@
 
 #include <Module.hpp>
 #include <ModuleCommon.hpp>
+#include <Demuxer.hpp>
 
 QList<QAction *> Module::getAddActions()
 {
@@ -32,8 +33,15 @@ Module::SettingsWidget *Module::getSettingsWidget()
 void Module::videoDeintSave()
 {}
 
+bool Module::canLoadOnDemand() const
+{
+    return true;
+}
+
 void Module::setInstances(bool &restartPlaying)
 {
+    Demuxer::resetRegistry();
+
     QMutexLocker locker(&mutex);
     for (ModuleCommon *mc : std::as_const(instances))
         if (!mc->set())
@@ -29,6 +29,7 @@ class ModuleCommon;
 class QMPLAY2SHAREDLIB_EXPORT Module : public Settings
 {
     friend class ModuleCommon;
+    friend class ModuleProxy;
 public:
     enum TYPE {NONE, DEMUXER, DECODER, READER, WRITER, PLAYLIST, QMPLAY2EXTENSION, SUBSDEC, AUDIOFILTER, VIDEOFILTER};
     enum FILTERTYPE {DEINTERLACE = 0x400000, DOUBLER = 0x800000, DATAPRESERVE = 0x1000000, USERFLAG = 0x80000000};
@@ -59,10 +60,20 @@ public:
             name(name), description(description), type(type), icon(icon), extensions(extensions)
         {}
 
+        // Signature at the given file offset, used by demuxers for content sniffing.
+        // Empty extension means that the signature applies to all extensions.
+        struct Magic
+        {
+            QString extension;
+            int offset;
+            QByteArray bytes;
+        };
+
         QString name, description;
         quint32 type = NONE;
         QIcon icon;
         QStringList extensions;
+        QList<Magic> magic;
     };
     virtual QList<Info> getModulesInfo(const bool showDisabled = false) const = 0;
     virtual void *createInstance(const QString &) = 0;
@@ -101,12 +112,16 @@ public:
 
     virtual void videoDeintSave();
 
+    // Return false if the module must be created at startup, e.g. it has side effects in its
+    // constructor or it provides "add" actions. Otherwise the library can be loaded when needed.
+    virtual bool canLoadOnDemand() const;
+
     inline QIcon icon() const
     {
         return m_icon;
     }
 
-    void setInstances(bool &);
+    virtual void setInstances(bool &);
 
     template<typename T>
     void setInstance();
@@ -115,6 +130,11 @@ protected:
     QIcon m_icon;
 
 private:
+    // Used by ModuleProxy, the settings belong to the module which is loaded later
+    inline Module(const QString &mName, std::nullptr_t) :
+        mName(mName)
+    {}
+
     QMutex mutex;
     QString mName;
     QList<ModuleCommon *> instances;
@@ -134,7 +154,7 @@ void Module::setInstance()
 
 /**/
 
-#define QMPLAY2_MODULES_API_VERSION 31
+#define QMPLAY2_MODULES_API_VERSION 33
 
 #define QMPLAY2_EXPORT_MODULE(ModuleClass) \
     extern "C" Q_DECL_EXPORT quint32 getQMPlay2ModuleAPIVersion() \
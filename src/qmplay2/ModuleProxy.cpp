@@ -0,0 +1,315 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ModuleProxy.hpp>
+
+#include <Tracer.hpp>
+
+#include <QGuiApplication>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QLibrary>
+#include <QThread>
+#include <QFile>
+
+constexpr quint32 g_magic = 0x514D4D32; // "QMM2"
+
+static QDataStream &operator <<(QDataStream &stream, const Module::Info::Magic &magic)
+{
+    return stream << magic.extension << magic.offset << magic.bytes;
+}
+static QDataStream &operator >>(QDataStream &stream, Module::Info::Magic &magic)
+{
+    return stream >> magic.extension >> magic.offset >> magic.bytes;
+}
+
+static QDataStream &operator <<(QDataStream &stream, const Module::Info &info)
+{
+    return stream << info.name << info.description << info.type << info.icon << info.extensions << info.magic;
+}
+static QDataStream &operator >>(QDataStream &stream, Module::Info &info)
+{
+    return stream >> info.name >> info.description >> info.type >> info.icon >> info.extensions >> info.magic;
+}
+
+/**/
+
+ModulesManifest::ModulesManifest(const QString &filePath)
+    : m_filePath(filePath)
+    , m_header(QString("%1/%2/%3/%4").arg(QMPLAY2_MODULES_API_VERSION).arg(QT_VERSION).arg(QMPlay2Core.getLanguage(), QGuiApplication::platformName()))
+{
+    QFile f(m_filePath);
+    if (!f.open(QFile::ReadOnly))
+        return;
+
+    QDataStream stream(&f);
+    quint32 magic = 0;
+    QString header;
+    quint32 count = 0;
+    stream >> magic >> header >> count;
+    if (stream.status() != QDataStream::Ok || magic != g_magic || header != m_header)
+        return;
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        QString key;
+        Entry entry;
+        stream >> key >> entry.libPath >> entry.settingsModified >> entry.onDemand >> entry.name >> entry.icon >> entry.modulesInfo[0] >> entry.modulesInfo[1];
+        if (stream.status() == QDataStream::Ok)
+            m_entries.insert(key, entry);
+    }
+}
+
+const ModulesManifest::Entry *ModulesManifest::find(const QFileInfo &libInfo) const
+{
+    // The key contains the library modification time and size, so a changed library has no entry
+    const auto it = m_entries.constFind(getKey(libInfo));
+    if (it == m_entries.constEnd())
+        return nullptr;
+
+    // Module info can depend on its settings, so any change of the settings file invalidates the entry
+    if (!it->onDemand || it->settingsModified != getSettingsModified(it->name))
+        return nullptr;
+
+    return &it.value();
+}
+
+void ModulesManifest::addModule(const QFileInfo &libInfo, Module *module)
+{
+    m_modules.insert(module, libInfo);
+}
+void ModulesManifest::updateModules()
+{
+    for (auto it = m_modules.cbegin(), itEnd = m_modules.cend(); it != itEnd; ++it)
+    {
+        Module *module = it.key();
+        QFileInfo libInfo = it.value();
+        if (auto moduleProxy = dynamic_cast<ModuleProxy *>(module))
+        {
+            module = moduleProxy->loadedModule();
+            if (!module)
+                continue;
+            // The library could have been replaced after startup
+            libInfo = moduleProxy->loadedLibInfo();
+        }
+
+        Entry &entry = m_entries[getKey(libInfo)];
+        entry.libPath = libInfo.filePath();
+        entry.onDemand = module->canLoadOnDemand();
+        entry.name = module->name();
+        entry.icon = module->icon();
+        entry.modulesInfo[0] = module->getModulesInfo(false);
+        entry.modulesInfo[1] = module->getModulesInfo(true);
+    }
+    m_modules.clear();
+}
+
+void ModulesManifest::save()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        // Drop the entries of removed and replaced libraries
+        const QFileInfo libInfo(it->libPath);
+        if (!libInfo.exists() || getKey(libInfo) != it.key())
+        {
+            it = m_entries.erase(it);
+            continue;
+        }
+        // Modules must be already destroyed here, so the settings are flushed
+        it->settingsModified = getSettingsModified(it->name);
+        ++it;
+    }
+
+    QSaveFile f(m_filePath);
+    if (!f.open(QFile::WriteOnly))
+        return;
+
+    QDataStream stream(&f);
+    stream << g_magic << m_header << static_cast<quint32>(m_entries.size());
+    for (auto it = m_entries.cbegin(), itEnd = m_entries.cend(); it != itEnd; ++it)
+    {
+        const Entry &entry = it.value();
+        stream << it.key() << entry.libPath << entry.settingsModified << entry.onDemand << entry.name << entry.icon << entry.modulesInfo[0] << entry.modulesInfo[1];
+    }
+    if (stream.status() == QDataStream::Ok)
+        f.commit();
+}
+
+QString ModulesManifest::getKey(const QFileInfo &libInfo)
+{
+    return QString("%1:%2:%3").arg(libInfo.lastModified().toMSecsSinceEpoch()).arg(libInfo.size()).arg(libInfo.filePath());
+}
+qint64 ModulesManifest::getSettingsModified(const QString &name)
+{
+    const QFileInfo settingsInfo(QMPlay2Core.getSettingsDir() + QMPlay2Core.getSettingsProfile() + name + ".ini");
+    return settingsInfo.exists() ? settingsInfo.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+/**/
+
+Module *ModuleProxy::loadLibrary(const QString &filePath)
+{
+    const QString fileName = QFileInfo(filePath).fileName();
+
+    Tracer::Span traceSpan("LoadModule");
+    traceSpan.setDetail(fileName);
+
+    QLibrary lib(filePath);
+    if (!lib.load())
+    {
+        QMPlay2Core.log(lib.errorString(), AddTimeToLog | ErrorLog | SaveLog);
+        return nullptr;
+    }
+
+    using CreateQMPlay2ModuleInstance = Module  *(*)();
+    using GetQMPlay2ModuleAPIVersion  = quint32  (*)();
+
+    GetQMPlay2ModuleAPIVersion  getQMPlay2ModuleAPIVersion  = (GetQMPlay2ModuleAPIVersion )lib.resolve("getQMPlay2ModuleAPIVersion" );
+    CreateQMPlay2ModuleInstance createQMPlay2ModuleInstance = (CreateQMPlay2ModuleInstance)lib.resolve("createQMPlay2ModuleInstance");
+
+    const auto checkModuleAPIVersion = [&](const quint32 v)->bool {
+        const quint8 moduleApiVersion = (v & 0xFF);
+        if (moduleApiVersion != QMPLAY2_MODULES_API_VERSION)
+        {
+            QMPlay2Core.log(fileName + " - " + QMPlay2CoreClass::tr("mismatch module API version"), AddTimeToLog | ErrorLog | SaveLog);
+            return false;
+        }
+        const quint8 qtMajorVersion = ((v >> 24) & 0xFF);
+        const quint8 qtMinorVersion = ((v >> 16) & 0xFF);
+        if (qtMajorVersion != QT_VERSION_MAJOR || qtMinorVersion < QT_VERSION_MINOR)
+        {
+            QMPlay2Core.log(fileName + " - " + QMPlay2CoreClass::tr("mismatch module Qt version"), AddTimeToLog | ErrorLog | SaveLog);
+            return false;
+        }
+        return true;
+    };
+
+    if (!getQMPlay2ModuleAPIVersion || !createQMPlay2ModuleInstance)
+    {
+#ifndef Q_OS_ANDROID
+        if (lib.resolve("qmplay2PluginInstance"))
+            QMPlay2Core.log(fileName + " - " + QMPlay2CoreClass::tr("too old QMPlay2 library"), AddTimeToLog | ErrorLog | SaveLog);
+        else
+            QMPlay2Core.log(fileName + " - " + QMPlay2CoreClass::tr("invalid QMPlay2 library"), AddTimeToLog | ErrorLog | SaveLog);
+#endif
+        return nullptr;
+    }
+
+    if (!checkModuleAPIVersion(getQMPlay2ModuleAPIVersion()))
+        return nullptr;
+
+    return createQMPlay2ModuleInstance();
+}
+
+ModuleProxy::ModuleProxy(const QString &filePath, const ModulesManifest::Entry &entry)
+    : Module(entry.name, nullptr)
+    , m_filePath(filePath)
+    , m_modulesInfo{entry.modulesInfo[0], entry.modulesInfo[1]}
+{
+    m_icon = entry.icon;
+}
+ModuleProxy::~ModuleProxy()
+{
+    delete m_module;
+}
+
+Module *ModuleProxy::loadedModule() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_module;
+}
+QFileInfo ModuleProxy::loadedLibInfo() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_libInfo;
+}
+
+QList<Module::Info> ModuleProxy::getModulesInfo(const bool showDisabled) const
+{
+    if (Module *module = loadedModule())
+        return module->getModulesInfo(showDisabled);
+    return m_modulesInfo[showDisabled];
+}
+void *ModuleProxy::createInstance(const QString &name)
+{
+    if (Module *module = load())
+        return module->createInstance(name);
+    return nullptr;
+}
+
+QList<QAction *> ModuleProxy::getAddActions()
+{
+    // Modules with add actions are never loaded on demand
+    if (Module *module = loadedModule())
+        return module->getAddActions();
+    return {};
+}
+
+Module::SettingsWidget *ModuleProxy::getSettingsWidget()
+{
+    if (Module *module = load())
+        return module->getSettingsWidget();
+    return nullptr;
+}
+
+void ModuleProxy::videoDeintSave()
+{
+    if (Module *module = loadedModule())
+        module->videoDeintSave();
+}
+
+void ModuleProxy::setInstances(bool &restartPlaying)
+{
+    if (Module *module = loadedModule())
+        module->setInstances(restartPlaying);
+}
+
+Module *ModuleProxy::load()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_module || m_loadFailed)
+        return m_module;
+
+    // Modules must live in the main thread like the others and their constructors might not be
+    // thread-safe, so the library is always loaded there. Mutex is not held while waiting, because
+    // the main thread can lock it in "loadedModule()".
+    QCoreApplication *app = QCoreApplication::instance();
+    if (QThread::currentThread() != app->thread())
+    {
+        locker.unlock();
+        Module *module = nullptr;
+        QMetaObject::invokeMethod(app, [&] {
+            module = load();
+        }, Qt::BlockingQueuedConnection);
+        return module;
+    }
+
+    m_libInfo = QFileInfo(m_filePath);
+    m_module = loadLibrary(m_filePath);
+    if (!m_module)
+    {
+        m_loadFailed = true;
+        return nullptr;
+    }
+
+    if (m_module->name() != name())
+        QMPlay2Core.log(QFileInfo(m_filePath).fileName() + " (" + m_module->name() + ") - " + QMPlay2CoreClass::tr("module name has changed"), AddTimeToLog | ErrorLog | SaveLog);
+
+    return m_module;
+}
@@ -0,0 +1,92 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <Module.hpp>
+
+#include <QFileInfo>
+#include <QHash>
+
+class ModulesManifest
+{
+public:
+    struct Entry
+    {
+        QString libPath;
+        qint64 settingsModified = 0;
+        bool onDemand = false;
+        QString name;
+        QIcon icon;
+        QList<Module::Info> modulesInfo[2]; // Index is "showDisabled"
+    };
+
+    ModulesManifest(const QString &filePath);
+
+    const Entry *find(const QFileInfo &libInfo) const;
+
+    void addModule(const QFileInfo &libInfo, Module *module);
+    void updateModules();
+
+    void save();
+
+private:
+    static QString getKey(const QFileInfo &libInfo);
+    static qint64 getSettingsModified(const QString &name);
+
+    const QString m_filePath;
+    const QString m_header;
+    QHash<QString, Entry> m_entries;
+    QHash<Module *, QFileInfo> m_modules;
+};
+
+/**/
+
+class ModuleProxy final : public Module
+{
+public:
+    static Module *loadLibrary(const QString &filePath);
+
+    ModuleProxy(const QString &filePath, const ModulesManifest::Entry &entry);
+    ~ModuleProxy();
+
+    Module *loadedModule() const;
+    QFileInfo loadedLibInfo() const;
+
+    QList<Info> getModulesInfo(const bool showDisabled = false) const override;
+    void *createInstance(const QString &name) override;
+
+    QList<QAction *> getAddActions() override;
+
+    SettingsWidget *getSettingsWidget() override;
+
+    void videoDeintSave() override;
+
+    void setInstances(bool &restartPlaying) override;
+
+private:
+    Module *load();
+
+    const QString m_filePath;
+    const QList<Info> m_modulesInfo[2];
+
+    mutable QMutex m_mutex;
+    Module *m_module = nullptr;
+    QFileInfo m_libInfo;
+    bool m_loadFailed = false;
+};
@@ -18,6 +18,8 @@
 
 #include <NetworkAccess.hpp>
 
+#include <HttpConnection.hpp>
+#include <NetworkCache.hpp>
 #include <QMPlay2Core.hpp>
 #include <Functions.hpp>
 
@@ -29,22 +31,162 @@ extern "C"
     #include <libavutil/opt.h>
 }
 
-#include <QThread>
+#include <QDateTime>
 #include <QMutex>
+#include <QHash>
+#include <QUrl>
 
-static int interruptCB(bool *m_status)
+#include <condition_variable>
+#include <algorithm>
+#include <thread>
+#include <deque>
+#include <mutex>
+#include <map>
+
+using namespace std;
+
+using Clock = HttpConnection::Clock;
+
+constexpr int g_maxThreads = 16;
+constexpr int g_maxConnectionsPerHost = 4;
+constexpr int g_maxIdleConnections = 32;
+constexpr int g_maxRedirects = 10;
+constexpr int g_maxSkippedBodySize = 64 * 1024;
+constexpr chrono::seconds g_threadIdleTimeout(30);
+
+static int interruptCB(HttpInterrupt *interrupt)
+{
+    interrupt->afterOpen = true;
+    return interrupt->aborted;
+}
+
+static bool getCacheExpiry(const HttpConnection::Response &response, qint64 &expires)
+{
+    const QByteArray cacheControl = response.header("Cache-Control").toLower();
+    if (cacheControl.contains("no-store"))
+        return false;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    expires = now; // Revalidate on each request by default
+
+    if (cacheControl.contains("no-cache"))
+        return true;
+
+    const int maxAgeIdx = cacheControl.indexOf("max-age=");
+    if (maxAgeIdx > -1)
+    {
+        expires = now + cacheControl.mid(maxAgeIdx + 8).split(',').at(0).trimmed().toLongLong() * 1000;
+        return true;
+    }
+
+    QByteArray expiresHeader = response.header("Expires");
+    if (!expiresHeader.isEmpty())
+    {
+        const QDateTime dateTime = QDateTime::fromString(QString::fromLatin1(expiresHeader.replace("GMT", "+0000")), Qt::RFC2822Date);
+        if (dateTime.isValid())
+            expires = qMax(now, dateTime.toMSecsSinceEpoch());
+    }
+
+    return true;
+}
+
+static bool isAuthenticated(const QString &url, const QByteArray &rawHeaders)
 {
-    m_status[1] = true;
-    return m_status[0];
+    if (!QUrl(url).userInfo().isEmpty())
+        return true;
+    for (const QByteArray &line : rawHeaders.split('\n'))
+    {
+        const QByteArray name = line.left(line.indexOf(':')).trimmed().toLower();
+        if (name == "authorization" || name == "proxy-authorization" || name == "cookie")
+            return true;
+    }
+    return false;
 }
 
 /**/
 
-static bool doSleep(bool &aborted, int retryInterval)
+struct Cookie
+{
+    QByteArray name;
+    QByteArray nameValue;
+    QByteArray domain;
+    QByteArray path;
+    bool hostOnly = true;
+    bool secure = false;
+};
+
+static void addCookie(const QByteArray &setCookie, const QUrl &url, vector<Cookie> &cookies)
 {
-    for (int i = 0; i < retryInterval && !aborted; ++i)
-        Functions::s_wait(0.1);
-    return !aborted;
+    const QList<QByteArray> attributes = setCookie.split(';');
+
+    Cookie cookie;
+    cookie.nameValue = attributes.at(0).trimmed();
+    const int eqIdx = cookie.nameValue.indexOf('=');
+    if (eqIdx <= 0)
+        return;
+    cookie.name = cookie.nameValue.left(eqIdx);
+    cookie.domain = url.host().toLower().toLatin1();
+
+    bool expired = false;
+    for (int i = 1; i < attributes.size(); ++i)
+    {
+        const QByteArray attribute = attributes.at(i).trimmed();
+        const int idx = attribute.indexOf('=');
+        const QByteArray attrName = attribute.left(idx).trimmed().toLower();
+        const QByteArray attrValue = (idx > -1) ? attribute.mid(idx + 1).trimmed() : QByteArray();
+        if (attrName == "domain" && !attrValue.isEmpty())
+        {
+            const QByteArray domain = (attrValue.startsWith('.') ? attrValue.mid(1) : attrValue).toLower();
+            if (cookie.domain != domain && !cookie.domain.endsWith("." + domain))
+                return; // Foreign domain
+            cookie.domain = domain;
+            cookie.hostOnly = false;
+        }
+        else if (attrName == "path" && attrValue.startsWith('/'))
+        {
+            cookie.path = attrValue;
+        }
+        else if (attrName == "secure")
+        {
+            cookie.secure = true;
+        }
+        else if (attrName == "max-age")
+        {
+            expired = (attrValue.toLongLong() <= 0);
+        }
+    }
+
+    for (auto it = cookies.begin(); it != cookies.end(); ++it)
+    {
+        if (it->name == cookie.name && it->domain == cookie.domain && it->path == cookie.path)
+        {
+            cookies.erase(it);
+            break;
+        }
+    }
+    if (!expired)
+        cookies.push_back(move(cookie));
+}
+static QByteArray getCookieHeader(const vector<Cookie> &cookies, const QUrl &url)
+{
+    const QByteArray host = url.host().toLower().toLatin1();
+    const QByteArray path = url.path(QUrl::FullyEncoded).toLatin1();
+    const bool secure = (url.scheme() == "https");
+
+    QByteArray header;
+    for (auto &&cookie : cookies)
+    {
+        if (cookie.secure && !secure)
+            continue;
+        if (cookie.hostOnly ? (host != cookie.domain) : (host != cookie.domain && !host.endsWith("." + cookie.domain)))
+            continue;
+        if (!cookie.path.isEmpty() && !path.startsWith(cookie.path))
+            continue;
+        if (!header.isEmpty())
+            header += "; ";
+        header += cookie.nameValue;
+    }
+    return header;
 }
 
 /**/
@@ -55,11 +197,56 @@ struct NetworkAccessParams
     int maxSize = INT_MAX;
     int retries = 1;
     int retryInterval = NetworkAccess::s_defaultRetryInterval;
+    bool useCache = false;
 };
 
 /**/
 
-class NetworkReplyPriv : public QThread
+class NetworkReplyPriv;
+
+class NetworkAccessPool
+{
+public:
+    static NetworkAccessPool &instance();
+
+    ~NetworkAccessPool();
+
+    void enqueue(shared_ptr<NetworkReplyPriv> job);
+    void wakeUp();
+
+    unique_ptr<HttpConnection> takeConnection(const QByteArray &key);
+    void putConnection(unique_ptr<HttpConnection> connection);
+
+private:
+    NetworkAccessPool() = default;
+
+    void worker();
+    void takeExitedWorkers(vector<thread> &exited);
+
+    shared_ptr<NetworkReplyPriv> takeJob(const Clock::time_point &now, Clock::time_point &wakeUpTime);
+    void takeExpiredConnections(const Clock::time_point &now, bool all, vector<unique_ptr<HttpConnection>> &expired);
+
+private:
+    mutex m_mutex;
+    condition_variable m_cond;
+
+    deque<shared_ptr<NetworkReplyPriv>> m_queue;
+    QHash<QByteArray, int> m_activeHosts;
+
+    map<QByteArray, vector<unique_ptr<HttpConnection>>> m_idleConnections;
+    int m_idleConnectionsCount = 0;
+
+    vector<thread> m_workers;
+    vector<thread::id> m_exitedWorkers;
+    vector<NetworkReplyPriv *> m_runningJobs;
+    int m_threads = 0;
+    int m_idleThreads = 0;
+    bool m_quit = false;
+};
+
+/**/
+
+class NetworkReplyPriv
 {
 public:
     NetworkReplyPriv(NetworkReply *networkReply, const QString &url, const QByteArray &postData, const QByteArray &rawHeaders, const NetworkAccessParams &params) :
@@ -71,13 +258,18 @@ public:
         m_maxSize(params.maxSize),
         m_retries(params.retries),
         m_retryInterval(params.retryInterval),
-        m_ctx(nullptr),
-        m_error(NetworkReply::Error::Ok),
-        m_aborted(false),
-        m_afterOpen(false)
-    {}
+        m_useCache(params.useCache && postData.isNull() && !isAuthenticated(url, rawHeaders)),
+        m_cacheKey(rawHeaders.isEmpty() ? url : url + "\n" + QString::fromUtf8(rawHeaders))
+    {
+        const QUrl qurl(m_url);
+        m_hostKey = HttpConnection::getKey(qurl);
+        if (m_hostKey.isEmpty())
+            m_hostKey = qurl.scheme().toLatin1() + "://" + qurl.host().toLatin1();
+    }
     ~NetworkReplyPriv() = default;
 
+    bool run(NetworkAccessPool &pool); // Returns true if the request must be retried later
+
     NetworkReply *m_networkReply;
 
     const QString    m_url;
@@ -89,159 +281,661 @@ public:
     int m_retries;
     int m_retryInterval;
 
-    AVIOContext *m_ctx;
+    const bool m_useCache;
+    const QString m_cacheKey;
+    NetworkCache::Entry m_cacheEntry;
+    bool m_hasCacheEntry = false;
+    bool m_storeInCache = false;
+    QByteArray m_cacheData;
+
+    QByteArray m_hostKey;
+    Clock::time_point m_notBefore;
+
     QByteArray m_cookies;
     QByteArray m_data;
-    NetworkReply::Error m_error;
+    NetworkReply::Error m_error = NetworkReply::Error::Ok;
 
     QMutex m_networkReplyMutex, m_dataMutex;
 
-    union
-    {
-        struct
-        {
-            bool m_aborted;
-            bool m_afterOpen;
-        };
-        bool m_status[2];
-    };
+    HttpInterrupt m_interrupt;
+
+    mutex m_finishedMutex;
+    condition_variable m_finishedCond;
+    bool m_finished = false;
 
 private:
-    void run() override
+    bool runHttp(NetworkAccessPool &pool);
+    bool runFFmpeg();
+
+    QByteArray prepareRequest(const QUrl &url, bool post, const QByteArray &cookieHeader) const;
+    void setCookies(const QByteArray &cookies);
+
+    bool findInCache();
+    void setCachedData();
+
+    template<typename ReadFn>
+    void download(qint64 size, ReadFn &&read);
+
+    bool scheduleRetry();
+    void finish();
+};
+
+bool NetworkReplyPriv::run(NetworkAccessPool &pool)
+{
+    if (!m_interrupt.aborted)
     {
         const QString scheme = Functions::getUrlScheme(m_url);
         if (scheme.isEmpty() || scheme == "file")
+        {
             m_error = NetworkReply::Error::UnsupportedScheme;
+        }
+        else if (m_useCache && findInCache())
+        {
+            setCachedData();
+        }
         else
         {
-            AVIOInterruptCB interruptCB = {(int(*)(void*))::interruptCB, m_status};
+            // FFmpeg handles proxies and other protocols
+            const bool useHttpConnection = ((scheme == "http" || scheme == "https") && qEnvironmentVariableIsEmpty("http_proxy"));
+            if (useHttpConnection ? runHttp(pool) : runFFmpeg())
+                return true;
+        }
+    }
+    finish();
+    return false;
+}
+
+bool NetworkReplyPriv::runHttp(NetworkAccessPool &pool)
+{
+    QUrl url(m_url);
+    bool post = !m_postData.isNull();
+    QByteArray cookies;
+    vector<Cookie> redirectCookies;
+
+    for (int redirects = 0;; ++redirects)
+    {
+        const QByteArray key = HttpConnection::getKey(url);
+        if (key.isEmpty())
+        {
+            m_error = NetworkReply::Error::UnsupportedScheme;
+            return false;
+        }
+
+        const QByteArray request = prepareRequest(url, post, getCookieHeader(redirectCookies, url));
+
+        unique_ptr<HttpConnection> connection;
+        HttpConnection::Response response;
+        for (;;)
+        {
+            connection = pool.takeConnection(key);
+            const bool reused = static_cast<bool>(connection);
+            if (!reused)
+                connection.reset(new HttpConnection(key));
+            else
+                m_interrupt.afterOpen = true;
+            connection->setInterrupt(&m_interrupt);
+
+            if ((reused || connection->open()) && connection->sendRequest(request, post ? m_postData : QByteArray()) && connection->readResponse(response))
+                break;
+
+            connection.reset();
+            if (!reused || m_interrupt.aborted)
+                break;
+            // Server has closed the idle connection, try again using a new connection
+        }
+
+        if (!connection)
+        {
+            m_error = NetworkReply::Error::Connection;
+            return scheduleRetry(); // Retry if connection error
+        }
+
+        for (const QByteArray &cookie : response.headerValues("Set-Cookie"))
+        {
+            addCookie(cookie, url, redirectCookies);
+            cookies += cookie + "\n";
+        }
+
+        const int status = response.status;
+        if (status == 304 && m_hasCacheEntry)
+        {
+            pool.putConnection(move(connection));
+
+            const QByteArray eTag = response.header("ETag");
+            if (!eTag.isEmpty())
+                m_cacheEntry.eTag = eTag;
+            if (getCacheExpiry(response, m_cacheEntry.expires))
+                NetworkCache::instance().insert(m_cacheKey, m_cacheEntry);
+            else
+                NetworkCache::instance().remove(m_cacheKey);
+
+            setCookies(cookies);
+            setCachedData();
+            return false;
+        }
+        if (status >= 300 && status < 400 && status != 304)
+        {
+            const QByteArray location = response.header("Location");
+            if (location.isEmpty() || redirects >= g_maxRedirects)
+            {
+                m_error = NetworkReply::Error::Connection;
+                return false;
+            }
+            if (connection->skipBody(g_maxSkippedBodySize))
+                pool.putConnection(move(connection));
+            url = url.resolved(QUrl::fromEncoded(location));
+            if (status == 303 || status == 301 || status == 302)
+                post = false;
+            continue;
+        }
+
+        if (status >= 400)
+        {
+            if (status == 400)
+                m_error = NetworkReply::Error::Connection400;
+            else if (status == 401)
+                m_error = NetworkReply::Error::Connection401;
+            else if (status == 403)
+                m_error = NetworkReply::Error::Connection403;
+            else if (status == 404)
+                m_error = NetworkReply::Error::Connection404;
+            else if (status < 500)
+                m_error = NetworkReply::Error::Connection4XX;
+            else
+                m_error = NetworkReply::Error::Connection5XX;
+
+            if (connection->skipBody(g_maxSkippedBodySize))
+                pool.putConnection(move(connection));
+
+            if (m_error == NetworkReply::Error::Connection5XX)
+                return scheduleRetry(); // Retry if server error (e.g. Service Temporarily Unavailable)
+            return false;
+        }
+
+        m_error = NetworkReply::Error::Ok;
+        setCookies(cookies);
+
+        NetworkCache::Entry cacheEntry;
+        m_storeInCache = (m_useCache && status == 200 && getCacheExpiry(response, cacheEntry.expires));
+        if (m_storeInCache)
+        {
+            cacheEntry.eTag = response.header("ETag");
+            cacheEntry.lastModified = response.header("Last-Modified");
+            m_storeInCache = (cacheEntry.isFresh() || cacheEntry.canRevalidate());
+        }
+
+        download(connection->contentLength(), [&](quint8 *data, int size) {
+            return connection->readBody(data, size);
+        });
 
-            do
+        if (m_error == NetworkReply::Error::Ok)
+        {
+            pool.putConnection(move(connection));
+            if (m_storeInCache)
             {
-                AVDictionary *options = nullptr;
-                const QByteArray url = Functions::prepareFFmpegUrl(m_url, options, true, m_rawHeaders.isEmpty(), m_rawHeaders.isEmpty(), false, m_customUserAgent).toUtf8();
-                av_dict_set(&options, "seekable", "0", 0);
-                if (!m_postData.isNull())
-                {
-                    av_dict_set(&options, "method", "POST", 0);
-                    if (!m_postData.isEmpty())
-                        av_dict_set(&options, "post_data", m_postData.toHex(), 0);
-                }
-                if (!m_rawHeaders.isEmpty())
-                    av_dict_set(&options, "headers", m_rawHeaders, 0);
-
-                const int ret = avio_open2(&m_ctx, url, AVIO_FLAG_READ | AVIO_FLAG_DIRECT, &interruptCB, &options);
-                if (ret >= 0)
-                {
-                    m_error = NetworkReply::Error::Ok;
-                    break;
-                }
-                switch (ret)
-                {
-                    case AVERROR_HTTP_BAD_REQUEST:
-                        m_error = NetworkReply::Error::Connection400;
-                        break;
-                    case AVERROR_HTTP_UNAUTHORIZED:
-                        m_error = NetworkReply::Error::Connection401;
-                        break;
-                    case AVERROR_HTTP_FORBIDDEN:
-                        m_error = NetworkReply::Error::Connection403;
-                        break;
-                    case AVERROR_HTTP_NOT_FOUND:
-                        m_error = NetworkReply::Error::Connection404;
-                        break;
-                    case AVERROR_HTTP_OTHER_4XX:
-                        m_error = NetworkReply::Error::Connection4XX;
-                        break;
-                    case AVERROR_HTTP_SERVER_ERROR:
-                        m_error = NetworkReply::Error::Connection5XX;
-                        continue; // Continue if server error (e.g. Service Temporarily Unavailable)
-                    default:
-                        m_error = NetworkReply::Error::Connection;
-                        continue; // Continue if connection error
-                }
+                cacheEntry.data = move(m_cacheData);
+                NetworkCache::instance().insert(m_cacheKey, cacheEntry);
+            }
+        }
+
+        return false;
+    }
+}
+bool NetworkReplyPriv::runFFmpeg()
+{
+    AVIOInterruptCB interruptCB = {(int(*)(void*))::interruptCB, &m_interrupt};
+
+    AVDictionary *options = nullptr;
+    const QByteArray url = Functions::prepareFFmpegUrl(m_url, options, true, m_rawHeaders.isEmpty(), m_rawHeaders.isEmpty(), false, m_customUserAgent).toUtf8();
+    av_dict_set(&options, "seekable", "0", 0);
+    if (!m_postData.isNull())
+    {
+        av_dict_set(&options, "method", "POST", 0);
+        if (!m_postData.isEmpty())
+            av_dict_set(&options, "post_data", m_postData.toHex(), 0);
+    }
+    if (!m_rawHeaders.isEmpty())
+        av_dict_set(&options, "headers", m_rawHeaders, 0);
+
+    AVIOContext *ctx = nullptr;
+    const int ret = avio_open2(&ctx, url, AVIO_FLAG_READ | AVIO_FLAG_DIRECT, &interruptCB, &options);
+    av_dict_free(&options);
+    if (ret < 0)
+    {
+        switch (ret)
+        {
+            case AVERROR_HTTP_BAD_REQUEST:
+                m_error = NetworkReply::Error::Connection400;
+                break;
+            case AVERROR_HTTP_UNAUTHORIZED:
+                m_error = NetworkReply::Error::Connection401;
+                break;
+            case AVERROR_HTTP_FORBIDDEN:
+                m_error = NetworkReply::Error::Connection403;
+                break;
+            case AVERROR_HTTP_NOT_FOUND:
+                m_error = NetworkReply::Error::Connection404;
+                break;
+            case AVERROR_HTTP_OTHER_4XX:
+                m_error = NetworkReply::Error::Connection4XX;
                 break;
-            } while (--m_retries > 0 && doSleep(m_aborted, m_retryInterval));
+            case AVERROR_HTTP_SERVER_ERROR:
+                m_error = NetworkReply::Error::Connection5XX;
+                return scheduleRetry(); // Retry if server error (e.g. Service Temporarily Unavailable)
+            default:
+                m_error = NetworkReply::Error::Connection;
+                return scheduleRetry(); // Retry if connection error
+        }
+        return false;
+    }
+
+    m_error = NetworkReply::Error::Ok;
+
+    char *cookies = nullptr;
+    if (av_opt_get(ctx, "cookies", AV_OPT_SEARCH_CHILDREN, (uint8_t **)&cookies) >= 0)
+    {
+        setCookies(cookies);
+        av_free(cookies);
+    }
+
+    int64_t size = avio_size(ctx);
+    if (size < -1)
+        size = -1; //Unknown size
+
+    download(size, [&](quint8 *data, int dataSize) {
+        const int received = avio_read(ctx, data, dataSize);
+        return (received == AVERROR_EOF) ? 0 : received;
+    });
+
+    avio_closep(&ctx);
+    return false;
+}
+
+QByteArray NetworkReplyPriv::prepareRequest(const QUrl &url, bool post, const QByteArray &cookieHeader) const
+{
+    AVDictionary *options = nullptr;
+    Functions::prepareFFmpegUrl(url.toString(), options, true, m_rawHeaders.isEmpty(), m_rawHeaders.isEmpty(), false, m_customUserAgent);
+
+    QByteArray path = url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority | QUrl::RemoveFragment);
+    if (path.isEmpty())
+        path = "/";
 
-            if (m_error == NetworkReply::Error::Ok)
+    QByteArray host = url.host(QUrl::FullyEncoded).toLatin1();
+    if (host.contains(':'))
+        host = "[" + host + "]"; // IPv6
+    if (url.port() > -1)
+        host += ":" + QByteArray::number(url.port());
+
+    QByteArray request = (post ? "POST " : "GET ") + path + " HTTP/1.1\r\n";
+    request += "Host: " + host + "\r\n";
+    if (const AVDictionaryEntry *userAgent = av_dict_get(options, "user_agent", nullptr, 0))
+        request += QByteArray("User-Agent: ") + userAgent->value + "\r\n";
+    request += "Accept: */*\r\n";
+    request += "Connection: keep-alive\r\n";
+    if (!url.userInfo().isEmpty())
+        request += "Authorization: Basic " + url.userInfo(QUrl::FullyDecoded).toUtf8().toBase64() + "\r\n";
+    if (post)
+        request += "Content-Length: " + QByteArray::number(m_postData.size()) + "\r\n";
+    if (m_hasCacheEntry)
+    {
+        if (!m_cacheEntry.eTag.isEmpty())
+            request += "If-None-Match: " + m_cacheEntry.eTag + "\r\n";
+        if (!m_cacheEntry.lastModified.isEmpty())
+            request += "If-Modified-Since: " + m_cacheEntry.lastModified + "\r\n";
+    }
+    if (const AVDictionaryEntry *headers = av_dict_get(options, "headers", nullptr, 0))
+        request += headers->value;
+    if (cookieHeader.isEmpty())
+    {
+        request += m_rawHeaders;
+    }
+    else
+    {
+        // Only one "Cookie" header is allowed, so merge it with the user one
+        bool merged = false;
+        for (const QByteArray &line : m_rawHeaders.split('\n'))
+        {
+            QByteArray header = line.trimmed();
+            if (header.isEmpty())
+                continue;
+            if (!merged && header.toLower().startsWith("cookie:"))
             {
-                char *cookies = nullptr;
-                if (av_opt_get(m_ctx, "cookies", AV_OPT_SEARCH_CHILDREN, (uint8_t **)&cookies) >= 0)
-                {
-                    for (const QByteArray &cookie : QByteArray(cookies).trimmed().split('\n'))
-                    {
-                        int idx = cookie.indexOf(';');
-                        if (idx < 0)
-                            idx = cookie.length();
-                        if (idx > 0)
-                            m_cookies += cookie.left(idx) + "; ";
-                    }
-                    m_cookies.chop(1);
-                    av_free(cookies);
-                }
-
-                int64_t size = avio_size(m_ctx);
-                if (size >= m_maxSize)
-                    m_error = NetworkReply::Error::FileTooLarge;
-                else
-                {
-                    if (size < -1)
-                        size = -1; //Unknown size
-
-                    const int chunkSize = qMax<int>(4096, size / 1000);
-                    quint8 *data = new quint8[chunkSize];
-                    int64_t pos = 0;
-
-                    for (;;)
-                    {
-                        const int received = avio_read(m_ctx, data, chunkSize);
-
-                        if (received < 0) //Error
-                        {
-                            if (received != AVERROR_EOF)
-                                m_error = NetworkReply::Error::Download;
-                            break;
-                        }
-
-                        if (received > 0)
-                        {
-                            pos += received;
-
-                            m_dataMutex.lock();
-                            const int dataPos = m_data.size();
-                            m_data.resize(dataPos + received);
-                            memcpy(m_data.data() + dataPos, data, received);
-                            m_dataMutex.unlock();
-
-                            m_networkReplyMutex.lock();
-                            if (m_networkReply)
-                                emit m_networkReply->downloadProgress(pos, size);
-                            m_networkReplyMutex.unlock();
-                        }
-
-                        if (received < chunkSize) //EOF
-                            break;
-
-                        if (pos + chunkSize >= m_maxSize)
-                        {
-                            m_error = NetworkReply::Error::FileTooLarge;
-                            break;
-                        }
-                    }
-
-                    delete[] data;
-                }
-
-                avio_closep(&m_ctx);
+                header += "; " + cookieHeader;
+                merged = true;
             }
+            request += header + "\r\n";
+        }
+        if (!merged)
+            request += "Cookie: " + cookieHeader + "\r\n";
+    }
+    request += "\r\n";
+
+    av_dict_free(&options);
+    return request;
+}
+void NetworkReplyPriv::setCookies(const QByteArray &cookies)
+{
+    for (const QByteArray &cookie : cookies.trimmed().split('\n'))
+    {
+        int idx = cookie.indexOf(';');
+        if (idx < 0)
+            idx = cookie.length();
+        if (idx > 0)
+            m_cookies += cookie.left(idx) + "; ";
+    }
+    m_cookies.chop(1);
+}
+
+bool NetworkReplyPriv::findInCache()
+{
+    if (!m_hasCacheEntry)
+        m_hasCacheEntry = NetworkCache::instance().find(m_cacheKey, m_cacheEntry);
+    return (m_hasCacheEntry && m_cacheEntry.isFresh());
+}
+void NetworkReplyPriv::setCachedData()
+{
+    m_error = NetworkReply::Error::Ok;
+
+    m_dataMutex.lock();
+    m_data = m_cacheEntry.data;
+    m_dataMutex.unlock();
+
+    const int size = m_cacheEntry.data.size();
+    m_networkReplyMutex.lock();
+    if (m_networkReply)
+        emit m_networkReply->downloadProgress(size, size);
+    m_networkReplyMutex.unlock();
+}
+
+template<typename ReadFn>
+void NetworkReplyPriv::download(qint64 size, ReadFn &&read)
+{
+    if (size >= m_maxSize)
+    {
+        m_error = NetworkReply::Error::FileTooLarge;
+        return;
+    }
+
+    const int chunkSize = qMax<int>(4096, size / 1000);
+    unique_ptr<quint8[]> data(new quint8[chunkSize]);
+    qint64 pos = 0;
+
+    for (;;)
+    {
+        const int received = read(data.get(), chunkSize);
+
+        if (received < 0) //Error
+        {
+            m_error = NetworkReply::Error::Download;
+            break;
         }
 
+        if (received == 0) //EOF
+            break;
+
+        pos += received;
+
+        m_dataMutex.lock();
+        const int dataPos = m_data.size();
+        m_data.resize(dataPos + received);
+        memcpy(m_data.data() + dataPos, data.get(), received);
+        m_dataMutex.unlock();
+
+        if (m_storeInCache)
+            m_cacheData.append((const char *)data.get(), received);
+
         m_networkReplyMutex.lock();
         if (m_networkReply)
-            emit m_networkReply->finished();
+            emit m_networkReply->downloadProgress(pos, size);
         m_networkReplyMutex.unlock();
+
+        if (pos >= m_maxSize)
+        {
+            m_error = NetworkReply::Error::FileTooLarge;
+            break;
+        }
     }
-};
+}
+
+bool NetworkReplyPriv::scheduleRetry()
+{
+    if (--m_retries <= 0 || m_interrupt.aborted)
+        return false;
+    m_notBefore = Clock::now() + chrono::milliseconds(m_retryInterval * 100);
+    return true;
+}
+void NetworkReplyPriv::finish()
+{
+    m_networkReplyMutex.lock();
+    if (m_networkReply)
+        emit m_networkReply->finished();
+    m_networkReplyMutex.unlock();
+
+    {
+        lock_guard<mutex> locker(m_finishedMutex);
+        m_finished = true;
+    }
+    m_finishedCond.notify_all();
+}
+
+/**/
+
+NetworkAccessPool &NetworkAccessPool::instance()
+{
+    static NetworkAccessPool pool;
+    return pool;
+}
+
+NetworkAccessPool::~NetworkAccessPool()
+{
+    {
+        // Abort all requests, so worker threads finish as soon as possible
+        lock_guard<mutex> locker(m_mutex);
+        m_quit = true;
+        for (auto &&job : m_queue)
+            job->m_interrupt.aborted = true;
+        for (auto &&job : m_runningJobs)
+            job->m_interrupt.aborted = true;
+        m_cond.notify_all();
+    }
+    for (auto &&worker : m_workers)
+        worker.join();
+}
+
+void NetworkAccessPool::enqueue(shared_ptr<NetworkReplyPriv> job)
+{
+    vector<thread> exited;
+    {
+        lock_guard<mutex> locker(m_mutex);
+        takeExitedWorkers(exited);
+        m_queue.push_back(move(job));
+        if (m_quit)
+            m_queue.back()->m_interrupt.aborted = true;
+        if (m_idleThreads == 0 && m_threads < g_maxThreads)
+        {
+            m_workers.emplace_back(&NetworkAccessPool::worker, this);
+            ++m_threads;
+        }
+        m_cond.notify_all();
+    }
+    for (auto &&worker : exited)
+        worker.join();
+}
+void NetworkAccessPool::wakeUp()
+{
+    lock_guard<mutex> locker(m_mutex);
+    m_cond.notify_all();
+}
+
+unique_ptr<HttpConnection> NetworkAccessPool::takeConnection(const QByteArray &key)
+{
+    vector<unique_ptr<HttpConnection>> expired;
+    unique_ptr<HttpConnection> connection;
+
+    lock_guard<mutex> locker(m_mutex);
+
+    auto it = m_idleConnections.find(key);
+    if (it == m_idleConnections.end())
+        return connection;
+
+    auto &connections = it->second;
+    const auto now = Clock::now();
+    while (!connections.empty() && !connection)
+    {
+        auto idleConnection = move(connections.back());
+        connections.pop_back();
+        --m_idleConnectionsCount;
+        if (idleConnection->isExpired(now))
+            expired.push_back(move(idleConnection));
+        else
+            connection = move(idleConnection);
+    }
+    if (connections.empty())
+        m_idleConnections.erase(it);
+
+    return connection;
+}
+void NetworkAccessPool::putConnection(unique_ptr<HttpConnection> connection)
+{
+    if (!connection->canReuse())
+        return;
+
+    connection->setIdle();
+
+    lock_guard<mutex> locker(m_mutex);
+    if (m_idleConnectionsCount < g_maxIdleConnections)
+    {
+        m_idleConnections[connection->key()].push_back(move(connection));
+        ++m_idleConnectionsCount;
+    }
+}
+
+void NetworkAccessPool::worker()
+{
+    unique_lock<mutex> locker(m_mutex);
+    for (;;)
+    {
+        const auto now = Clock::now();
+        auto wakeUpTime = now + g_threadIdleTimeout;
+
+        vector<unique_ptr<HttpConnection>> expired;
+        takeExpiredConnections(now, false, expired);
+
+        auto job = takeJob(now, wakeUpTime);
+        if (!job)
+        {
+            if (!expired.empty())
+            {
+                // Close connections without holding the lock
+                locker.unlock();
+                expired.clear();
+                locker.lock();
+                continue;
+            }
+
+            bool timeout = m_quit;
+            if (!timeout)
+            {
+                ++m_idleThreads;
+                timeout = (m_cond.wait_until(locker, wakeUpTime) == cv_status::timeout);
+                --m_idleThreads;
+            }
+
+            if (timeout && m_queue.empty())
+            {
+                if (--m_threads == 0)
+                    takeExpiredConnections(now, true, expired);
+                m_exitedWorkers.push_back(this_thread::get_id());
+                locker.unlock();
+                return;
+            }
+
+            continue;
+        }
+
+        const QByteArray hostKey = job->m_hostKey;
+        ++m_activeHosts[hostKey];
+        m_runningJobs.push_back(job.get());
+        if (m_quit)
+            job->m_interrupt.aborted = true;
+        locker.unlock();
+
+        expired.clear();
+
+        const bool retry = job->run(*this);
+
+        locker.lock();
+        m_runningJobs.erase(find(m_runningJobs.begin(), m_runningJobs.end(), job.get()));
+        if (--m_activeHosts[hostKey] <= 0)
+            m_activeHosts.remove(hostKey);
+        if (retry)
+        {
+            if (m_quit)
+                job->m_interrupt.aborted = true; // Don't wait for the retry at exit
+            m_queue.push_back(move(job));
+        }
+        m_cond.notify_all();
+    }
+}
+
+void NetworkAccessPool::takeExitedWorkers(vector<thread> &exited)
+{
+    for (auto &&id : m_exitedWorkers)
+    {
+        auto it = find_if(m_workers.begin(), m_workers.end(), [&](const thread &worker) {
+            return (worker.get_id() == id);
+        });
+        exited.push_back(move(*it));
+        m_workers.erase(it);
+    }
+    m_exitedWorkers.clear();
+}
+
+shared_ptr<NetworkReplyPriv> NetworkAccessPool::takeJob(const Clock::time_point &now, Clock::time_point &wakeUpTime)
+{
+    for (auto it = m_queue.begin(); it != m_queue.end(); ++it)
+    {
+        const auto &job = *it;
+        if (!job->m_interrupt.aborted) // Aborted jobs finish immediately
+        {
+            if (job->m_notBefore > now)
+            {
+                wakeUpTime = min(wakeUpTime, job->m_notBefore);
+                continue;
+            }
+            if (m_activeHosts.value(job->m_hostKey) >= g_maxConnectionsPerHost)
+                continue;
+        }
+        auto ret = move(*it);
+        m_queue.erase(it);
+        return ret;
+    }
+    return nullptr;
+}
+void NetworkAccessPool::takeExpiredConnections(const Clock::time_point &now, bool all, vector<unique_ptr<HttpConnection>> &expired)
+{
+    for (auto it = m_idleConnections.begin(); it != m_idleConnections.end();)
+    {
+        auto &connections = it->second;
+        for (auto connIt = connections.begin(); connIt != connections.end();)
+        {
+            if (all || (*connIt)->isExpired(now))
+            {
+                expired.push_back(move(*connIt));
+                connIt = connections.erase(connIt);
+                --m_idleConnectionsCount;
+            }
+            else
+            {
+                ++connIt;
+            }
+        }
+        if (connections.empty())
+            it = m_idleConnections.erase(it);
+        else
+            ++it;
+    }
+}
 
 /**/
 
@@ -252,7 +946,12 @@ QString NetworkReply::url() const
 
 void NetworkReply::abort()
 {
-    m_priv->m_aborted = true;
+    m_priv->m_interrupt.aborted = true;
+    {
+        lock_guard<mutex> locker(m_priv->m_finishedMutex);
+        m_priv->m_finishedCond.notify_all();
+    }
+    NetworkAccessPool::instance().wakeUp();
 }
 
 bool NetworkReply::hasError() const
@@ -261,7 +960,7 @@ bool NetworkReply::hasError() const
 }
 NetworkReply::Error NetworkReply::error() const
 {
-    return m_priv->m_aborted ? Error::Aborted : m_priv->m_error;
+    return m_priv->m_interrupt.aborted ? Error::Aborted : m_priv->m_error;
 }
 
 QByteArray NetworkReply::getCookies() const
@@ -279,45 +978,31 @@ QByteArray NetworkReply::readAll()
 
 NetworkReply::Wait NetworkReply::waitForFinished(int ms)
 {
-    const bool inf = (ms < 0);
+    const auto isFinished = [this] {
+        // "avio_open2()" can block in DNS name resolution, so it doesn't call interrupt callback.
+        return (m_priv->m_finished || (m_priv->m_interrupt.aborted && !m_priv->m_interrupt.afterOpen));
+    };
+
+    unique_lock<mutex> locker(m_priv->m_finishedMutex);
     bool ret = true;
-    while (m_priv->isRunning() && (!m_priv->m_aborted || m_priv->m_afterOpen))
-    {
-        if (m_priv->m_afterOpen)
-            ret = m_priv->wait(ms);
-        else
-        {
-            // "avio_open2()" can block in DNS name resolution, so it doesn't call interrupt callback.
-            const int timeout = inf ? 100 : qMin(ms, 100);
-            ret = m_priv->wait(timeout);
-            if (ret)
-                break;
-            if (!inf)
-            {
-                ms -= timeout;
-                if (ms == 0)
-                    break;
-            }
-        }
-    }
+    if (ms < 0)
+        m_priv->m_finishedCond.wait(locker, isFinished);
+    else
+        ret = m_priv->m_finishedCond.wait_for(locker, chrono::milliseconds(ms), isFinished);
+    locker.unlock();
+
     return ret ? (hasError() ? Wait::Error : Wait::Ok) : Wait::Timeout;
 }
 
 NetworkReply::NetworkReply(const QString &url, const QByteArray &postData, const QByteArray &rawHeaders, const NetworkAccessParams &params) :
-    m_priv(new NetworkReplyPriv(this, url, postData, rawHeaders, params))
+    m_priv(make_shared<NetworkReplyPriv>(this, url, postData, rawHeaders, params))
 {}
 NetworkReply::~NetworkReply()
 {
-    if (!m_priv->isRunning())
-        delete m_priv;
-    else
-    {
-        connect(m_priv, SIGNAL(finished()), m_priv, SLOT(deleteLater()));
-        m_priv->m_networkReplyMutex.lock();
-        m_priv->m_networkReply = nullptr;
-        m_priv->m_networkReplyMutex.unlock();
-        abort();
-    }
+    m_priv->m_networkReplyMutex.lock();
+    m_priv->m_networkReply = nullptr;
+    m_priv->m_networkReplyMutex.unlock();
+    abort();
 }
 
 /**/
@@ -349,6 +1034,10 @@ void NetworkAccess::setRetries(const int retries, const int retryInterval)
         m_params->retryInterval = retryInterval;
     }
 }
+void NetworkAccess::setUseCache(const bool useCache)
+{
+    m_params->useCache = useCache;
+}
 
 int NetworkAccess::getRetries() const
 {
@@ -360,9 +1049,8 @@ NetworkReply *NetworkAccess::start(const QString &url, const QByteArray &postDat
     const QByteArray rawHeadersData = (rawHeaders.isEmpty() || rawHeaders.endsWith("\r\n")) ? rawHeaders : rawHeaders + "\r\n";
     NetworkReply *reply = new NetworkReply(url, postData, rawHeadersData, *m_params);
     connect(reply, SIGNAL(finished()), this, SLOT(networkFinished()));
-    // Don't set parent to "m_priv" - this prevents waiting for thread at QMPlay2 exit
     reply->setParent(this);
-    reply->m_priv->start();
+    NetworkAccessPool::instance().enqueue(reply->m_priv);
     return reply;
 }
 bool NetworkAccess::start(IOController<NetworkReply> &ioCtrl, const QString &url, const QByteArray &postData, const QByteArray &rawHeaders)
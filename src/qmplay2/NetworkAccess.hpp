@@ -23,6 +23,8 @@
 
 #include <QObject>
 
+#include <memory>
+
 class NetworkReplyPriv;
 struct NetworkAccessParams;
 
@@ -81,7 +83,7 @@ signals:
 private:
     NetworkReply(const QString &url, const QByteArray &postData, const QByteArray &rawHeaders, const NetworkAccessParams &params);
 
-    NetworkReplyPriv *m_priv;
+    std::shared_ptr<NetworkReplyPriv> m_priv;
 };
 
 /**/
@@ -102,6 +104,7 @@ public:
     void setCustomUserAgent(const QString &customUserAgent);
     void setMaxDownloadSize(const int maxSize);
     void setRetries(const int retries, const int retryInterval = s_defaultRetryInterval); // retryInterval is in 1/10 sec units
+    void setUseCache(const bool useCache); // Use persistent "NetworkCache" for GET requests without credentials
 
     int getRetries() const;
 
@@ -0,0 +1,180 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <NetworkCache.hpp>
+
+#include <QMPlay2Core.hpp>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QDir>
+
+constexpr quint32 g_magic = 0x514E4332; // "QNC2"
+constexpr qint64 g_defaultMaxDiskSize = 128 * 1024 * 1024;
+constexpr int g_defaultMaxMemorySize = 32 * 1024 * 1024;
+
+bool NetworkCache::Entry::isFresh() const
+{
+    return (expires > QDateTime::currentMSecsSinceEpoch());
+}
+bool NetworkCache::Entry::canRevalidate() const
+{
+    return (!eTag.isEmpty() || !lastModified.isEmpty());
+}
+
+/**/
+
+NetworkCache &NetworkCache::instance()
+{
+    // Never destroyed, because it can be used by network threads until they are joined at QMPlay2 exit
+    static auto networkCache = new NetworkCache;
+    return *networkCache;
+}
+
+NetworkCache::NetworkCache()
+    : m_dir(QMPlay2Core.getSettingsDir() + "NetworkCache/")
+    , m_maxDiskSize(g_defaultMaxDiskSize)
+    , m_images(g_defaultMaxMemorySize / 1024)
+{}
+
+void NetworkCache::setMaxDiskSize(const qint64 maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxDiskSize = maxSize;
+    if (m_diskSize > m_maxDiskSize)
+        trim();
+}
+void NetworkCache::setMaxMemorySize(const int maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.setMaxCost(maxSize / 1024);
+}
+
+bool NetworkCache::find(const QString &key, Entry &entry)
+{
+    QFile f(getFilePath(key));
+    if (!f.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream stream(&f);
+    quint32 magic = 0;
+    QByteArray storedKeyHash;
+    stream >> magic;
+    if (magic != g_magic)
+        return false;
+    stream >> storedKeyHash;
+    if (storedKeyHash != getKeyHash(key))
+        return false;
+    stream >> entry.eTag >> entry.lastModified >> entry.expires >> entry.data;
+    if (stream.status() != QDataStream::Ok)
+    {
+        entry = Entry();
+        return false;
+    }
+
+    // Modification time is used for LRU eviction
+    f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    return true;
+}
+void NetworkCache::insert(const QString &key, const Entry &entry)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Don't let a single entry flush the whole cache
+    if (entry.data.size() > m_maxDiskSize / 16)
+        return;
+
+    if (!QDir().mkpath(m_dir))
+        return;
+
+    const QString filePath = getFilePath(key);
+    const qint64 oldSize = QFileInfo(filePath).size();
+
+    QSaveFile f(filePath);
+    if (!f.open(QFile::WriteOnly))
+        return;
+
+    QDataStream stream(&f);
+    stream << g_magic << getKeyHash(key) << entry.eTag << entry.lastModified << entry.expires << entry.data;
+    const qint64 newSize = f.size();
+    if (stream.status() != QDataStream::Ok || !f.commit())
+        return;
+
+    if (m_diskSize < 0)
+        trim(); // Scans the directory
+    else if ((m_diskSize += newSize - oldSize) > m_maxDiskSize)
+        trim();
+}
+void NetworkCache::remove(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+    QFile f(getFilePath(key));
+    const qint64 size = f.size();
+    if (f.remove() && m_diskSize >= 0)
+        m_diskSize -= size;
+}
+
+QImage NetworkCache::findImage(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+    if (const QImage *image = m_images.object(key))
+        return *image;
+    return QImage();
+}
+void NetworkCache::insertImage(const QString &key, const QImage &image)
+{
+    if (image.isNull())
+        return;
+    QMutexLocker locker(&m_mutex);
+    m_images.insert(key, new QImage(image), qMax<int>(1, image.sizeInBytes() / 1024));
+}
+
+void NetworkCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.clear();
+    QDir(m_dir).removeRecursively();
+    m_diskSize = 0;
+}
+
+QString NetworkCache::getFilePath(const QString &key) const
+{
+    return m_dir + QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+}
+QByteArray NetworkCache::getKeyHash(const QString &key)
+{
+    // Stored instead of the key, because the URL can contain private data
+    return QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha256);
+}
+
+void NetworkCache::trim()
+{
+    // Keep the most recently used files, trimming to 3/4 of the maximum size to avoid scanning on each insertion
+    const qint64 maxSize = (m_diskSize > m_maxDiskSize) ? m_maxDiskSize * 3 / 4 : m_maxDiskSize;
+    m_diskSize = 0;
+    for (const QFileInfo &fileInfo : QDir(m_dir).entryInfoList(QDir::Files, QDir::Time))
+    {
+        const qint64 size = fileInfo.size();
+        if (m_diskSize + size > maxSize && QFile::remove(fileInfo.filePath()))
+            continue;
+        m_diskSize += size;
+    }
+}
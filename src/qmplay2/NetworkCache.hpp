@@ -0,0 +1,77 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QMPlay2Lib.hpp>
+
+#include <QByteArray>
+#include <QString>
+#include <QImage>
+#include <QCache>
+#include <QMutex>
+
+/* Persistent HTTP response cache with LRU eviction and a memory cache for decoded images */
+
+class QMPLAY2SHAREDLIB_EXPORT NetworkCache
+{
+    Q_DISABLE_COPY(NetworkCache)
+
+public:
+    struct Entry
+    {
+        bool isFresh() const;
+        bool canRevalidate() const;
+
+        QByteArray data;
+        QByteArray eTag;
+        QByteArray lastModified;
+        qint64 expires = 0; // Milliseconds since epoch
+    };
+
+    static NetworkCache &instance();
+
+    void setMaxDiskSize(const qint64 maxSize);
+    void setMaxMemorySize(const int maxSize);
+
+    bool find(const QString &key, Entry &entry);
+    void insert(const QString &key, const Entry &entry);
+    void remove(const QString &key);
+
+    QImage findImage(const QString &key);
+    void insertImage(const QString &key, const QImage &image);
+
+    void clear();
+
+private:
+    NetworkCache();
+    ~NetworkCache() = default;
+
+    QString getFilePath(const QString &key) const;
+    static QByteArray getKeyHash(const QString &key);
+
+    void trim();
+
+private:
+    const QString m_dir;
+
+    QMutex m_mutex;
+    qint64 m_maxDiskSize;
+    qint64 m_diskSize = -1; // Unknown until the cache directory is scanned
+    QCache<QString, QImage> m_images;
+};
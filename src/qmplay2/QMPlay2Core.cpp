@@ -25,8 +25,9 @@
 #   include <CommonJS.hpp>
 #endif
 #include <Playlist.hpp>
+#include <ModuleProxy.hpp>
 #include <Version.hpp>
-#include <Module.hpp>
+#include <Tracer.hpp>
 
 #include <QLoggingCategory>
 #include <QStandardPaths>
@@ -346,68 +347,48 @@ void QMPlay2CoreClass::init(bool loadModulesAndGpu, bool modulesInSubdirs, const
                         pluginsList += fInfo;
         }
 
+        Tracer::Span traceSpan("InitModules");
+
+        m_modulesManifest = std::make_unique<ModulesManifest>(settingsDir + "Modules.cache");
+
         QStringList pluginsName;
+        int onDemand = 0;
         for (const QFileInfo &fInfo : std::as_const(pluginsList))
         {
-            if (QLibrary::isLibrary(fInfo.filePath()))
+            if (!QLibrary::isLibrary(fInfo.filePath()))
+                continue;
+
+            Module *moduleInstance = nullptr;
+            const ModulesManifest::Entry *entry = m_modulesManifest->find(fInfo);
+            if (entry)
             {
-                QLibrary lib(fInfo.filePath());
-                if (!lib.load())
-                    log(lib.errorString(), AddTimeToLog | ErrorLog | SaveLog);
-                else
-                {
-                    using CreateQMPlay2ModuleInstance = Module  *(*)();
-                    using GetQMPlay2ModuleAPIVersion  = quint32  (*)();
-
-                    GetQMPlay2ModuleAPIVersion  getQMPlay2ModuleAPIVersion  = (GetQMPlay2ModuleAPIVersion )lib.resolve("getQMPlay2ModuleAPIVersion" );
-                    CreateQMPlay2ModuleInstance createQMPlay2ModuleInstance = (CreateQMPlay2ModuleInstance)lib.resolve("createQMPlay2ModuleInstance");
-
-                    const auto checkModuleAPIVersion = [&](const quint32 v)->bool {
-                        const quint8 moduleApiVersion = (v & 0xFF);
-                        if (moduleApiVersion != QMPLAY2_MODULES_API_VERSION)
-                        {
-                            log(fInfo.fileName() + " - " + tr("mismatch module API version"), AddTimeToLog | ErrorLog | SaveLog);
-                            return false;
-                        }
-                        const quint8 qtMajorVersion = ((v >> 24) & 0xFF);
-                        const quint8 qtMinorVersion = ((v >> 16) & 0xFF);
-                        if (qtMajorVersion != QT_VERSION_MAJOR || qtMinorVersion < QT_VERSION_MINOR)
-                        {
-                            log(fInfo.fileName() + " - " + tr("mismatch module Qt version"), AddTimeToLog | ErrorLog | SaveLog);
-                            return false;
-                        }
-                        return true;
-                    };
-
-                    if (!getQMPlay2ModuleAPIVersion || !createQMPlay2ModuleInstance)
-                    {
-#ifndef Q_OS_ANDROID
-                        if (lib.resolve("qmplay2PluginInstance"))
-                            log(fInfo.fileName() + " - " + tr("too old QMPlay2 library"), AddTimeToLog | ErrorLog | SaveLog);
-                        else
-                            log(fInfo.fileName() + " - " + tr("invalid QMPlay2 library"), AddTimeToLog | ErrorLog | SaveLog);
-#endif
-                    }
-                    else if (checkModuleAPIVersion(getQMPlay2ModuleAPIVersion()))
-                    {
-                        if (Module *moduleInstance = createQMPlay2ModuleInstance())
-                        {
-                            const QString name = moduleInstance->name();
-                            if (pluginsName.contains(name))
-                            {
-                                log(fInfo.fileName() + " (" + name + ") - " + tr("duplicated module name"), AddTimeToLog | ErrorLog | SaveLog);
-                                delete moduleInstance;
-                            }
-                            else
-                            {
-                                pluginsName += moduleInstance->name();
-                                pluginsInstance += moduleInstance;
-                            }
-                        }
-                    }
-                }
+                moduleInstance = new ModuleProxy(fInfo.filePath(), *entry);
+            }
+            else
+            {
+                moduleInstance = ModuleProxy::loadLibrary(fInfo.filePath());
+            }
+            if (!moduleInstance)
+                continue;
+
+            const QString name = moduleInstance->name();
+            if (pluginsName.contains(name))
+            {
+                log(fInfo.fileName() + " (" + name + ") - " + tr("duplicated module name"), AddTimeToLog | ErrorLog | SaveLog);
+                delete moduleInstance;
+            }
+            else
+            {
+                pluginsName += name;
+                pluginsInstance += moduleInstance;
+                m_modulesManifest->addModule(fInfo, moduleInstance);
+                if (entry)
+                    ++onDemand;
             }
         }
+
+        if (Tracer::isEnabled())
+            traceSpan.setDetail(QString("%1 loaded, %2 on demand").arg(pluginsInstance.size() - onDemand).arg(onDemand));
     }
 
     connect(this, SIGNAL(restoreCursor()), this, SLOT(restoreCursorSlot()));
@@ -418,9 +399,16 @@ void QMPlay2CoreClass::quit()
 {
     if (settingsDir.isEmpty())
         return;
+    if (m_modulesManifest)
+        m_modulesManifest->updateModules();
     for (Module *pluginInstance : std::as_const(pluginsInstance))
         delete pluginInstance;
     pluginsInstance.clear();
+    if (m_modulesManifest)
+    {
+        m_modulesManifest->save();
+        m_modulesManifest.reset();
+    }
     videoFilters.clear();
     settingsDir.clear();
     shareDir.clear();
@@ -43,6 +43,7 @@ class QTranslator;
 class Settings;
 class QWidget;
 class QPixmap;
+class ModulesManifest;
 class Module;
 
 class QMPLAY2SHAREDLIB_EXPORT QMPlay2CoreClass : public QObject
@@ -268,6 +269,8 @@ private:
 
     std::shared_ptr<GPUInstance> m_gpuInstance;
 
+    std::unique_ptr<ModulesManifest> m_modulesManifest;
+
     CommonJS *m_commonJS = nullptr;
 
     int m_suspend = 0;
@@ -41,6 +41,20 @@ unique_lock<mutex> QMPlay2OSD::ensure(shared_ptr<QMPlay2OSD> &osd)
     }
     return locker;
 }
+shared_ptr<QMPlay2OSD> QMPlay2OSD::copy(const shared_ptr<const QMPlay2OSD> &other)
+{
+    auto osd = make_shared<QMPlay2OSD>();
+    auto locker = other->lock();
+    osd->m_images = other->m_images;
+    osd->m_text = other->m_text;
+    osd->m_duration = other->m_duration;
+    osd->m_pts = other->m_pts;
+    osd->m_scale = other->m_scale;
+    osd->m_needsRescale = other->m_needsRescale;
+    osd->m_id = other->m_id; // The same images, so renderers can keep their uploaded data
+    osd->m_source = other; // Owns the Vulkan buffer of the images
+    return osd;
+}
 
 QMPlay2OSD::QMPlay2OSD()
 {
@@ -99,6 +113,7 @@ void QMPlay2OSD::clear()
     m_needsRescale = m_started = false;
     m_timer.invalidate();
     m_id = 0;
+    m_source.reset();
 #ifdef USE_VULKAN
     if (m_returnVkBufferFn)
     {
@@ -52,6 +52,7 @@ public:
 
         // CPU only
         QByteArray rgba;
+        bool premultiplied = false;
 
 #ifdef USE_VULKAN // Vulkan only
         std::shared_ptr<QmVk::BufferView> dataBufferView;
@@ -69,6 +70,8 @@ public:
 
 public:
     static std::unique_lock<std::mutex> ensure(std::shared_ptr<QMPlay2OSD> &osd);
+    // New OSD sharing images with "other", which stays alive as long as the copy uses them
+    static std::shared_ptr<QMPlay2OSD> copy(const std::shared_ptr<const QMPlay2OSD> &other);
 
 public:
     QMPlay2OSD();
@@ -170,6 +173,7 @@ private:
     quint64 m_id;
     QElapsedTimer m_timer;
     mutable std::mutex m_mutex;
+    std::shared_ptr<const QMPlay2OSD> m_source;
 #ifdef USE_VULKAN
     std::function<void()> m_returnVkBufferFn;
 #endif
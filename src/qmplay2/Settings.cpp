@@ -21,6 +21,9 @@
 Settings::Settings(const QString &name) :
     QSettings(QMPlay2Core.getSettingsDir() + QMPlay2Core.getSettingsProfile() + name + ".ini", QSettings::IniFormat)
 {}
+Settings::Settings() :
+    QSettings(QString(), QSettings::IniFormat)
+{}
 Settings::~Settings()
 {
     QMutexLocker mL(&mutex);
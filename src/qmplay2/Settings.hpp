@@ -84,6 +84,11 @@ public:
     {
         return get(key, def).value<QColor>();
     }
+
+protected:
+    // Not backed by any file, for the objects which don't own the settings
+    Settings();
+
 private:
     QVariant get(const QString &key, const QVariant &def = QVariant()) const;
 
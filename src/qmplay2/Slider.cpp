@@ -163,6 +163,11 @@ void Slider::enterEvent(Q_ENTER_EVENT *e)
     lastMousePos = -1;
     QSlider::enterEvent(e);
 }
+void Slider::leaveEvent(QEvent *e)
+{
+    emit mouseLeft();
+    QSlider::leaveEvent(e);
+}
 
 int Slider::getMousePos(const QPoint &pos)
 {
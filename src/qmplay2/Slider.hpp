@@ -51,6 +51,7 @@ protected:
     void mouseMoveEvent(QMouseEvent *) override;
     void wheelEvent(QWheelEvent *) override;
     void enterEvent(Q_ENTER_EVENT *) override;
+    void leaveEvent(QEvent *) override;
 private:
     int getMousePos(const QPoint &pos);
 
@@ -59,4 +60,5 @@ private:
     int cachedSliderValue;
 signals:
     void mousePosition(int xPos);
+    void mouseLeft();
 };
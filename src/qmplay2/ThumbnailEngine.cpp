@@ -0,0 +1,499 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ThumbnailEngine.hpp>
+
+#include <QMPlay2Core.hpp>
+#include <ImgScaler.hpp>
+#include <Functions.hpp>
+#include <Tracer.hpp>
+#include <Frame.hpp>
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <QBuffer>
+#include <QMutex>
+#include <QHash>
+#include <QDir>
+
+#include <functional>
+#include <cstring>
+#include <atomic>
+#include <cmath>
+
+extern "C"
+{
+    #include <libavformat/avformat.h>
+    #include <libavcodec/avcodec.h>
+}
+
+constexpr quint32 g_magic = 0x51544831; // "QTH1"
+constexpr int g_maxThumbnails = 100;
+constexpr double g_minInterval = 2.0;
+constexpr int g_columns = 10;
+constexpr int g_tileWidth = 160;
+constexpr int g_startDelayMs = 2000;
+constexpr int g_maxPacketsPerSeek = 1000;
+constexpr qint64 g_maxCacheSize = 64 * 1024 * 1024;
+
+// Generation is allowed to use at most 1/4 of a single CPU core and to read at most 8 MiB/s
+constexpr int g_cpuIdleFactor = 3;
+constexpr qint64 g_maxBytesPerSecond = 8 * 1024 * 1024;
+
+static int interruptCB(std::atomic_bool *abort)
+{
+    return *abort;
+}
+
+// Coarse to fine order, so the whole range is covered early
+static QVector<int> getTileOrder(int count)
+{
+    QVector<int> order;
+    order.reserve(count);
+    QVector<bool> used(count);
+    int step = 1;
+    while (step * 2 < count)
+        step *= 2;
+    for (; step > 0; step /= 2)
+    {
+        for (int i = 0; i < count; i += step)
+        {
+            if (!used[i])
+            {
+                used[i] = true;
+                order.append(i);
+            }
+        }
+    }
+    return order;
+}
+
+/**/
+
+// A single generation, cancelled jobs are left to finish in their thread while the next one starts
+class ThumbnailEngine::Job
+{
+public:
+    Job(const QString &url)
+        : m_url(url)
+    {}
+
+    void run(const std::function<void()> &tileReady);
+
+    bool hasSheet() const;
+    QImage thumbnail(double pos) const;
+
+private:
+    bool sleepFor(int ms);
+
+    QString getCacheFilePath() const;
+    bool loadCache(const QString &filePath);
+    void saveCache(const QString &filePath);
+
+    void setSheet(int count, double interval, const QSize &tileSize);
+    void setTile(int idx, const QImage &tile);
+
+public:
+    const QString m_url;
+    std::atomic_bool m_abort {false};
+    QThread *m_thread = nullptr; // Used only in the GUI thread
+
+private:
+    mutable QMutex m_mutex;
+    QImage m_sheet;
+    QVector<bool> m_hasTile;
+    QSize m_tileSize;
+    double m_interval = 0.0;
+};
+
+/**/
+
+ThumbnailEngine::ThumbnailEngine(QObject *parent)
+    : QObject(parent)
+{}
+ThumbnailEngine::~ThumbnailEngine()
+{
+    cancel();
+
+    // Cancelled jobs only have to leave the current FFmpeg call or sleep
+    for (auto &&job : std::as_const(m_cancelledJobs))
+    {
+        if (job->m_thread)
+            job->m_thread->wait();
+    }
+}
+
+void ThumbnailEngine::generate(const QString &url)
+{
+    if (m_job && m_job->m_url == url && (m_job->m_thread || m_job->hasSheet()))
+        return;
+
+    cancel();
+
+    if (!url.startsWith("file://"))
+        return;
+
+    const auto job = std::make_shared<Job>(url);
+    const std::weak_ptr<Job> weakJob = job;
+
+    job->m_thread = QThread::create([this, job, weakJob] {
+        job->run([this, weakJob] {
+            QMetaObject::invokeMethod(this, [this, weakJob] {
+                if (m_job && m_job == weakJob.lock())
+                    emit thumbnailReady();
+            }, Qt::QueuedConnection);
+        });
+    });
+    job->m_thread->setParent(this);
+    connect(job->m_thread, &QThread::finished, this, [this, job] {
+        job->m_thread->deleteLater();
+        job->m_thread = nullptr;
+        m_cancelledJobs.removeOne(job);
+    });
+    job->m_thread->start(QThread::LowestPriority);
+
+    m_job = job;
+}
+void ThumbnailEngine::cancel()
+{
+    if (!m_job)
+        return;
+
+    // Don't wait, the job stops on its own
+    m_job->m_abort = true;
+    if (m_job->m_thread)
+        m_cancelledJobs.append(m_job);
+    m_job.reset();
+}
+
+QImage ThumbnailEngine::thumbnail(double pos) const
+{
+    if (!m_job)
+        return QImage();
+    return m_job->thumbnail(pos);
+}
+
+/**/
+
+bool ThumbnailEngine::Job::hasSheet() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_hasTile.isEmpty();
+}
+QImage ThumbnailEngine::Job::thumbnail(double pos) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    const int count = m_hasTile.count();
+    if (count == 0 || m_interval <= 0.0)
+        return QImage();
+
+    const int idx = qBound(0, qRound(pos / m_interval), count - 1);
+    for (int d = 0; d < count; ++d)
+    {
+        for (const int i : {idx - d, idx + d})
+        {
+            if (i >= 0 && i < count && m_hasTile[i])
+            {
+                const int x = (i % g_columns) * m_tileSize.width();
+                const int y = (i / g_columns) * m_tileSize.height();
+                return m_sheet.copy(x, y, m_tileSize.width(), m_tileSize.height());
+            }
+        }
+    }
+    return QImage();
+}
+
+void ThumbnailEngine::Job::run(const std::function<void()> &tileReady)
+{
+    const QString filePath = m_url.mid(7);
+    const QString cacheFilePath = getCacheFilePath();
+
+    if (loadCache(cacheFilePath))
+    {
+        tileReady();
+        return;
+    }
+
+    // Don't compete with opening and buffering of the file being played
+    if (!sleepFor(g_startDelayMs))
+        return;
+
+    Tracer::Span traceSpan("ThumbnailEngine", "thumbnails");
+    traceSpan.setDetail(filePath);
+
+    AVFormatContext *formatCtx = avformat_alloc_context();
+    formatCtx->interrupt_callback.callback = (int(*)(void *))interruptCB;
+    formatCtx->interrupt_callback.opaque = &m_abort;
+
+    AVCodecContext *codecCtx = nullptr;
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+
+    auto finish = [&] {
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+        avcodec_free_context(&codecCtx);
+        avformat_close_input(&formatCtx);
+    };
+
+    if (avformat_open_input(&formatCtx, filePath.toUtf8().constData(), nullptr, nullptr) != 0)
+        return finish();
+    if (avformat_find_stream_info(formatCtx, nullptr) < 0 || formatCtx->duration <= 0)
+        return finish();
+
+    const AVCodec *codec = nullptr;
+    const int streamIdx = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if (streamIdx < 0 || !codec)
+        return finish();
+
+    AVStream *stream = formatCtx->streams[streamIdx];
+    if (stream->disposition & AV_DISPOSITION_ATTACHED_PIC)
+        return finish();
+    for (unsigned i = 0; i < formatCtx->nb_streams; ++i)
+        formatCtx->streams[i]->discard = (static_cast<int>(i) == streamIdx) ? AVDISCARD_NONKEY : AVDISCARD_ALL;
+
+    const int width = stream->codecpar->width;
+    const int height = stream->codecpar->height;
+    if (width <= 0 || height <= 0)
+        return finish();
+
+    codecCtx = avcodec_alloc_context3(codec);
+    if (avcodec_parameters_to_context(codecCtx, stream->codecpar) < 0)
+        return finish();
+    codecCtx->thread_count = 1;
+    codecCtx->skip_frame = AVDISCARD_NONKEY;
+    codecCtx->skip_loop_filter = AVDISCARD_ALL;
+    while (codecCtx->lowres < codec->max_lowres && (width >> (codecCtx->lowres + 1)) >= g_tileWidth)
+        ++codecCtx->lowres;
+    if (avcodec_open2(codecCtx, codec, nullptr) < 0)
+        return finish();
+
+    double sar = av_q2d(stream->sample_aspect_ratio.num ? stream->sample_aspect_ratio : stream->codecpar->sample_aspect_ratio);
+    if (sar <= 0.0)
+        sar = 1.0;
+    const int tileHeight = qBound(2, qRound(g_tileWidth * height / (width * sar)) & ~1, g_tileWidth * 2);
+
+    const double length = formatCtx->duration / static_cast<double>(AV_TIME_BASE);
+    const double interval = qMax(g_minInterval, length / g_maxThumbnails);
+    const int count = qMax(1, static_cast<int>(std::ceil(length / interval)));
+    setSheet(count, interval, QSize(g_tileWidth, tileHeight));
+
+    const double startTime = (formatCtx->start_time != AV_NOPTS_VALUE) ? formatCtx->start_time / static_cast<double>(AV_TIME_BASE) : 0.0;
+
+    ImgScaler imgScaler;
+    QImage tile(g_tileWidth, tileHeight, QImage::Format_RGB32);
+    QHash<int64_t, int> keyFrameTiles; // Seeks which end at the same key frame reuse the tile
+    QElapsedTimer ioTimer;
+    ioTimer.start();
+
+    int nDone = 0;
+    for (const int idx : getTileOrder(count))
+    {
+        if (m_abort)
+            break;
+
+        QElapsedTimer workTimer;
+        workTimer.start();
+
+        const int64_t ts = (startTime + idx * interval) * AV_TIME_BASE;
+        if (av_seek_frame(formatCtx, -1, ts, AVSEEK_FLAG_BACKWARD) < 0)
+            continue;
+        avcodec_flush_buffers(codecCtx);
+
+        bool hasFrame = false;
+        for (int i = 0; i < g_maxPacketsPerSeek && !m_abort; ++i)
+        {
+            if (av_read_frame(formatCtx, packet) < 0)
+                break;
+
+            if (packet->stream_index != streamIdx || !(packet->flags & AV_PKT_FLAG_KEY))
+            {
+                av_packet_unref(packet);
+                continue;
+            }
+
+            const int64_t keyFramePts = (packet->pts != AV_NOPTS_VALUE) ? packet->pts : packet->dts;
+            const auto it = keyFrameTiles.constFind(keyFramePts);
+            if (it != keyFrameTiles.constEnd())
+            {
+                av_packet_unref(packet);
+                QMutexLocker locker(&m_mutex);
+                const int x = (it.value() % g_columns) * g_tileWidth;
+                const int y = (it.value() / g_columns) * tileHeight;
+                tile = m_sheet.copy(x, y, g_tileWidth, tileHeight);
+                hasFrame = true;
+                break;
+            }
+
+            // Decode the single key frame and drain the decoder to get it without any delay
+            const bool sent = (avcodec_send_packet(codecCtx, packet) == 0);
+            av_packet_unref(packet);
+            if (sent && avcodec_send_packet(codecCtx, nullptr) == 0 && avcodec_receive_frame(codecCtx, frame) == 0)
+            {
+                const Frame videoFrame(frame);
+                if (imgScaler.create(videoFrame, g_tileWidth, tileHeight) && imgScaler.scale(videoFrame, tile.bits()))
+                {
+                    keyFrameTiles.insert(keyFramePts, idx);
+                    hasFrame = true;
+                }
+                av_frame_unref(frame);
+            }
+            break;
+        }
+
+        if (hasFrame)
+        {
+            setTile(idx, tile);
+            ++nDone;
+            tileReady();
+        }
+
+        // CPU budget
+        int sleepMs = qMin<qint64>(workTimer.elapsed() * g_cpuIdleFactor, 1000);
+
+        // I/O budget
+        if (formatCtx->pb)
+        {
+            const qint64 minElapsed = formatCtx->pb->bytes_read * 1000 / g_maxBytesPerSecond;
+            sleepMs = qMax<qint64>(sleepMs, minElapsed - ioTimer.elapsed());
+        }
+
+        if (sleepMs > 0 && !sleepFor(sleepMs))
+            break;
+    }
+
+    finish();
+
+    traceSpan.setDetail(QString("%1: %2/%3").arg(filePath).arg(nDone).arg(count));
+
+    if (!m_abort && nDone == count)
+        saveCache(cacheFilePath);
+}
+
+bool ThumbnailEngine::Job::sleepFor(int ms)
+{
+    constexpr int step = 50;
+    for (int slept = 0; slept < ms && !m_abort; slept += step)
+        QThread::msleep(qMin(step, ms - slept));
+    return !m_abort;
+}
+
+QString ThumbnailEngine::Job::getCacheFilePath() const
+{
+    const QFileInfo fileInfo(m_url.mid(7));
+    const QByteArray key = m_url.toUtf8() + '\n' + QByteArray::number(fileInfo.size()) + '\n' + QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch());
+    return QMPlay2Core.getSettingsDir() + "Thumbnails/" + QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+}
+bool ThumbnailEngine::Job::loadCache(const QString &filePath)
+{
+    QFile f(filePath);
+    if (!f.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream stream(&f);
+    quint32 magic = 0;
+    qint32 count = 0;
+    double interval = 0.0;
+    QSize tileSize;
+    QByteArray sheetData;
+    stream >> magic;
+    if (magic != g_magic)
+        return false;
+    stream >> count >> interval >> tileSize >> sheetData;
+    if (stream.status() != QDataStream::Ok || count <= 0 || interval <= 0.0 || tileSize.isEmpty())
+        return false;
+
+    const QImage sheet = QImage::fromData(sheetData, "JPG").convertToFormat(QImage::Format_RGB32);
+    if (sheet.width() < g_columns * tileSize.width() || sheet.height() < ((count + g_columns - 1) / g_columns) * tileSize.height())
+        return false;
+
+    // Modification time is used for LRU eviction
+    f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    QMutexLocker locker(&m_mutex);
+    m_sheet = sheet;
+    m_hasTile.fill(true, count);
+    m_tileSize = tileSize;
+    m_interval = interval;
+    return true;
+}
+void ThumbnailEngine::Job::saveCache(const QString &filePath)
+{
+    QByteArray sheetData;
+    qint32 count;
+    double interval;
+    QSize tileSize;
+    {
+        QMutexLocker locker(&m_mutex);
+        QBuffer buffer(&sheetData);
+        buffer.open(QBuffer::WriteOnly);
+        if (!m_sheet.save(&buffer, "JPG", 80))
+            return;
+        count = m_hasTile.count();
+        interval = m_interval;
+        tileSize = m_tileSize;
+    }
+
+    const QString dir = Functions::filePath(filePath);
+    if (!QDir().mkpath(dir))
+        return;
+
+    QSaveFile f(filePath);
+    if (!f.open(QFile::WriteOnly))
+        return;
+
+    QDataStream stream(&f);
+    stream << g_magic << count << interval << tileSize << sheetData;
+    if (stream.status() != QDataStream::Ok || !f.commit())
+        return;
+
+    // Keep the most recently used files
+    qint64 size = 0;
+    for (const QFileInfo &fileInfo : QDir(dir).entryInfoList(QDir::Files, QDir::Time))
+    {
+        size += fileInfo.size();
+        if (size > g_maxCacheSize)
+            QFile::remove(fileInfo.filePath());
+    }
+}
+
+void ThumbnailEngine::Job::setSheet(int count, double interval, const QSize &tileSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_sheet = QImage(g_columns * tileSize.width(), ((count + g_columns - 1) / g_columns) * tileSize.height(), QImage::Format_RGB32);
+    m_sheet.fill(Qt::black);
+    m_hasTile.fill(false, count);
+    m_tileSize = tileSize;
+    m_interval = interval;
+}
+void ThumbnailEngine::Job::setTile(int idx, const QImage &tile)
+{
+    QMutexLocker locker(&m_mutex);
+    const int x = (idx % g_columns) * m_tileSize.width();
+    const int y = (idx / g_columns) * m_tileSize.height();
+    for (int i = 0; i < m_tileSize.height(); ++i)
+        memcpy(m_sheet.scanLine(y + i) + x * 4, tile.constScanLine(i), m_tileSize.width() * 4);
+    m_hasTile[idx] = true;
+}
@@ -0,0 +1,58 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QMPlay2Lib.hpp>
+
+#include <QObject>
+#include <QImage>
+#include <QList>
+
+#include <memory>
+
+/*
+ * Seek bar preview thumbnails for local files. Only key frames are decoded (in low resolution if the
+ * decoder supports it) into a sprite sheet, which is cached on disk. Generation runs in a background
+ * thread at the lowest priority with CPU and I/O budgets and can be cancelled at any moment without
+ * waiting for the thread.
+ */
+
+class QMPLAY2SHAREDLIB_EXPORT ThumbnailEngine final : public QObject
+{
+    Q_OBJECT
+
+public:
+    ThumbnailEngine(QObject *parent = nullptr);
+    ~ThumbnailEngine();
+
+    void generate(const QString &url);
+    void cancel();
+
+    // Returns the nearest already generated thumbnail or null image
+    QImage thumbnail(double pos) const;
+
+signals:
+    void thumbnailReady();
+
+private:
+    class Job;
+
+    std::shared_ptr<Job> m_job;
+    QList<std::shared_ptr<Job>> m_cancelledJobs; // Still finishing in background
+};
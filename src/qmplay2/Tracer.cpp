@@ -0,0 +1,190 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Tracer.hpp>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    char phase;
+    qint64 ts; // Microseconds
+    qint64 dur;
+    int tid;
+    QString detail;
+};
+
+static atomic_bool g_enabled {false};
+static QElapsedTimer g_timer;
+static QString g_filePath;
+static QMutex g_mutex;
+static vector<TraceEvent> g_events;
+static QHash<QThread *, int> g_threadIds;
+static QList<QString> g_threadNames;
+
+static inline qint64 now()
+{
+    return g_timer.nsecsElapsed() / 1000;
+}
+
+static int threadId(QThread *thread)
+{
+    // Must be called with "g_mutex" locked
+    auto it = g_threadIds.constFind(thread);
+    if (it != g_threadIds.cend())
+        return it.value();
+
+    QString name = thread->objectName();
+    if (name.isEmpty())
+        name = thread->metaObject()->className();
+    g_threadNames.append(name);
+    return *g_threadIds.insert(thread, g_threadNames.count());
+}
+
+static void addEvent(const char *name, const char *category, char phase, qint64 ts, qint64 dur, const QString &detail)
+{
+    QThread *const thread = QThread::currentThread();
+    QMutexLocker locker(&g_mutex);
+    if (!g_enabled)
+        return;
+    g_events.push_back({name, category, phase, ts, dur, threadId(thread), detail});
+}
+
+/**/
+
+Tracer::Span::Span(const char *name, const char *category)
+    : m_name(name)
+    , m_category(category)
+{
+    if (g_enabled.load(memory_order_relaxed))
+        m_begin = now();
+}
+Tracer::Span::~Span()
+{
+    if (m_begin > -1)
+        addEvent(m_name, m_category, 'X', m_begin, now() - m_begin, m_detail);
+}
+
+void Tracer::Span::setDetail(const QString &detail)
+{
+    if (m_begin > -1)
+        m_detail = detail;
+}
+
+/**/
+
+void Tracer::start(const QString &filePath)
+{
+    if (filePath.isEmpty())
+        return;
+
+    QMutexLocker locker(&g_mutex);
+    if (g_enabled)
+        return;
+
+    g_filePath = filePath;
+    g_events.reserve(1024);
+    g_timer.start();
+
+    // The thread which starts the tracer becomes the first one on the list
+    threadId(QThread::currentThread());
+
+    g_enabled = true;
+}
+bool Tracer::finish()
+{
+    QMutexLocker locker(&g_mutex);
+    if (!g_enabled)
+        return false;
+
+    g_enabled = false;
+
+    QJsonArray traceEvents;
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    for (int i = 0; i < g_threadNames.count(); ++i)
+    {
+        traceEvents.append(QJsonObject {
+            {"name", "thread_name"},
+            {"ph", "M"},
+            {"pid", pid},
+            {"tid", i + 1},
+            {"args", QJsonObject {{"name", g_threadNames[i]}}},
+        });
+    }
+
+    for (auto &&event : g_events)
+    {
+        QJsonObject obj {
+            {"name", event.name},
+            {"cat", event.category},
+            {"ph", QString(QLatin1Char(event.phase))},
+            {"ts", event.ts},
+            {"pid", pid},
+            {"tid", event.tid},
+        };
+        if (event.phase == 'X')
+            obj["dur"] = event.dur;
+        else
+            obj["s"] = "g"; // Global instant event
+        if (!event.detail.isEmpty())
+            obj["args"] = QJsonObject {{"detail", event.detail}};
+        traceEvents.append(obj);
+    }
+
+    g_events.clear();
+    g_threadIds.clear();
+    g_threadNames.clear();
+
+    const QJsonObject root {
+        {"traceEvents", traceEvents},
+        {"displayTimeUnit", "ms"},
+    };
+
+    QSaveFile f(g_filePath);
+    if (!f.open(QSaveFile::WriteOnly))
+        return false;
+    f.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return f.commit();
+}
+
+bool Tracer::isEnabled()
+{
+    return g_enabled.load(memory_order_relaxed);
+}
+
+void Tracer::instant(const char *name, const QString &detail, const char *category)
+{
+    if (g_enabled.load(memory_order_relaxed))
+        addEvent(name, category, 'i', now(), 0, detail);
+}
@@ -0,0 +1,57 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QMPlay2Lib.hpp>
+
+#include <QString>
+
+/* Lightweight scoped-span tracer, exports Chrome/Perfetto trace JSON */
+
+class QMPLAY2SHAREDLIB_EXPORT Tracer
+{
+    Tracer() = delete;
+
+public:
+    class QMPLAY2SHAREDLIB_EXPORT Span
+    {
+        Q_DISABLE_COPY(Span)
+
+    public:
+        // "name" and "category" must be string literals
+        Span(const char *name, const char *category = "qmplay2");
+        ~Span();
+
+        void setDetail(const QString &detail);
+
+    private:
+        const char *const m_name;
+        const char *const m_category;
+        qint64 m_begin = -1;
+        QString m_detail;
+    };
+
+    // Starts recording, events are written to "filePath" by "finish()"
+    static void start(const QString &filePath);
+    static bool finish();
+
+    static bool isEnabled();
+
+    static void instant(const char *name, const QString &detail = QString(), const char *category = "qmplay2");
+};
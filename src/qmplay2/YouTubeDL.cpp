@@ -28,14 +28,404 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QDateTime>
 #include <QFileInfo>
+#include <QThread>
 #include <QMutex>
+#include <QHash>
 #include <QFile>
 
+#include <condition_variable>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 constexpr const char *g_name = "YouTubeDL";
 static bool g_mustUpdate = true;
 static QRecursiveMutex g_mutex;
 
+/**/
+
+struct ResolvedEntry
+{
+    QStringList result;
+    QVector<QPair<QString, QByteArray>> cookies;
+    qint64 expires = 0; // Milliseconds since epoch
+};
+
+constexpr int g_maxResolvedEntries = 256;
+constexpr qint64 g_defaultResolvedTimeout = 10 * 60 * 1000;
+constexpr qint64 g_resolvedExpiryMargin = 60 * 1000;
+
+static QHash<QString, ResolvedEntry> g_resolvedCache;
+static QMutex g_resolvedCacheMutex;
+
+static qint64 getResolvedExpiry(const QStringList &result)
+{
+    // Signed stream URLs contain expiration time, e.g. "&expire=1700000000" or "/expire/1700000000/"
+    static const QRegularExpression expireRx(R"([?&/]expire[=/](\d{9,11}))");
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 expires = -1;
+    for (const QString &str : result)
+    {
+        auto it = expireRx.globalMatch(str);
+        while (it.hasNext())
+        {
+            const qint64 urlExpires = it.next().captured(1).toLongLong() * 1000 - g_resolvedExpiryMargin;
+            if (expires < 0 || urlExpires < expires)
+                expires = urlExpires;
+        }
+    }
+    return (expires < 0) ? now + g_defaultResolvedTimeout : expires;
+}
+static bool findResolved(const QString &key, QStringList &result)
+{
+    QMutexLocker locker(&g_resolvedCacheMutex);
+    auto it = g_resolvedCache.find(key);
+    if (it == g_resolvedCache.end())
+        return false;
+    if (it->expires <= QDateTime::currentMSecsSinceEpoch())
+    {
+        g_resolvedCache.erase(it);
+        return false;
+    }
+    for (auto &&cookie : std::as_const(it->cookies))
+        QMPlay2Core.addCookies(cookie.first, cookie.second);
+    result = it->result;
+    return true;
+}
+static void insertResolved(const QString &key, ResolvedEntry &&entry)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (entry.expires <= now)
+        return;
+
+    QMutexLocker locker(&g_resolvedCacheMutex);
+    for (auto it = g_resolvedCache.begin(); it != g_resolvedCache.end();)
+    {
+        if (it->expires <= now)
+            it = g_resolvedCache.erase(it);
+        else
+            ++it;
+    }
+    if (g_resolvedCache.size() >= g_maxResolvedEntries)
+    {
+        auto oldestIt = std::min_element(g_resolvedCache.begin(), g_resolvedCache.end(), [](const ResolvedEntry &a, const ResolvedEntry &b) {
+            return a.expires < b.expires;
+        });
+        g_resolvedCache.erase(oldestIt);
+    }
+    g_resolvedCache.insert(key, std::move(entry));
+}
+
+/**/
+
+static QString getPythonCommand(const QString &program)
+{
+#ifndef Q_OS_WIN
+    QFile ytDlFile(program);
+    if (ytDlFile.open(QFile::ReadOnly))
+    {
+        const auto shebang = ytDlFile.readLine(99).trimmed();
+        const int idx = shebang.lastIndexOf("python");
+        if (shebang.startsWith("#!") && idx > -1)
+        {
+            const auto pythonCmd = shebang.mid(idx);
+            if (QStandardPaths::findExecutable(pythonCmd).endsWith(pythonCmd))
+                return pythonCmd;
+#ifdef Q_OS_MACOS
+            if (QFileInfo(QString("/usr/local/bin/" + pythonCmd)).isExecutable())
+                return "/usr/local/bin/" + pythonCmd;
+#endif
+        }
+    }
+#else
+    Q_UNUSED(program)
+#endif
+    return QString();
+}
+
+/**/
+
+// Imports "yt_dlp" from the yt-dlp zipapp or script and runs its command line interface for each
+// request, so Python start-up and extractors loading are done only once.
+// Protocol: one JSON line per request {"args": [...]}, one JSON line per response {"code": int, "stdout": str, "stderr": str}.
+static const QByteArray g_workerScript = R"(import contextlib, io, json, os, sys
+
+ytdlp_path = sys.argv[1]
+sys.argv = [ytdlp_path]
+sys.path.insert(0, ytdlp_path)
+sys.path.insert(1, os.path.dirname(os.path.realpath(ytdlp_path)))
+
+import yt_dlp
+
+for line in sys.stdin:
+    try:
+        args = json.loads(line)["args"]
+    except Exception:
+        continue
+    out, err = io.StringIO(), io.StringIO()
+    code = 0
+    with contextlib.redirect_stdout(out), contextlib.redirect_stderr(err):
+        try:
+            yt_dlp.main(args)
+        except SystemExit as e:
+            if isinstance(e.code, str):
+                err.write(e.code.strip() + "\n")
+                code = 1
+            else:
+                code = e.code or 0
+        except BaseException as e:
+            err.write("ERROR: %s\n" % e)
+            code = 1
+    sys.__stdout__.write(json.dumps({"code": code, "stdout": out.getvalue(), "stderr": err.getvalue()}) + "\n")
+    sys.__stdout__.flush()
+)";
+
+constexpr auto g_workerIdleTimeout = std::chrono::minutes(5);
+
+static QString getYtDlKey(const QString &ytDlPath)
+{
+    return ytDlPath + "\n" + QString::number(QFileInfo(ytDlPath).lastModified().toMSecsSinceEpoch());
+}
+
+class YouTubeDLWorker final : public QThread
+{
+public:
+    static YouTubeDLWorker *instance();
+
+    bool exec(const QString &ytDlPath, const QStringList &args, const bool &aborted, int &exitCode, QString &stdOut, QString &stdErr);
+
+private:
+    struct Request
+    {
+        QString ytDlPath;
+        QStringList args;
+        std::atomic_bool aborted {false};
+        bool done = false;
+        bool ok = false;
+        int exitCode = -1;
+        QString stdOut, stdErr;
+    };
+
+    YouTubeDLWorker() = default;
+    ~YouTubeDLWorker() = default;
+
+    void stop();
+
+    void run() override;
+
+    bool processRequest(QProcess &process, Request &request);
+    bool startWorkerProcess(QProcess &process, const QString &ytDlPath);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    Request *m_request = nullptr;
+    bool m_running = false;
+    bool m_stop = false;
+    QString m_failedYtDl; // Path and modification time of "yt-dlp" which can't be used by the worker
+
+    // Used only in worker thread
+    QString m_ytDlPath;
+    QDateTime m_ytDlLastModified;
+    bool m_hasResponse = false;
+};
+
+YouTubeDLWorker *YouTubeDLWorker::instance()
+{
+    // Never destroyed, the thread is stopped when application quits
+    static YouTubeDLWorker *worker = [] {
+        auto worker = new YouTubeDLWorker;
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, qApp, [worker] {
+            worker->stop();
+        });
+        return worker;
+    }();
+    return worker;
+}
+
+bool YouTubeDLWorker::exec(const QString &ytDlPath, const QStringList &args, const bool &aborted, int &exitCode, QString &stdOut, QString &stdErr)
+{
+    const QString ytDlKey = getYtDlKey(ytDlPath);
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    if (m_stop || m_request || m_failedYtDl == ytDlKey)
+        return false; // Busy or unusable, start a separate process
+
+    Request request;
+    request.ytDlPath = ytDlPath;
+    request.args = args;
+    m_request = &request;
+
+    if (!m_running)
+    {
+        wait();
+        start();
+        m_running = true;
+    }
+    m_cond.notify_all();
+
+    while (!request.done)
+    {
+        m_cond.wait_for(locker, std::chrono::milliseconds(100));
+        if (aborted)
+            request.aborted = true;
+    }
+
+    if (!request.ok)
+        return false;
+
+    exitCode = request.exitCode;
+    stdOut = std::move(request.stdOut);
+    stdErr = std::move(request.stdErr);
+    return true;
+}
+
+void YouTubeDLWorker::stop()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_stop = true;
+        if (m_request)
+            m_request->aborted = true;
+    }
+    m_cond.notify_all();
+    wait();
+}
+
+void YouTubeDLWorker::run()
+{
+    QProcess process;
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    for (;;)
+    {
+        const bool hasRequest = m_cond.wait_for(locker, g_workerIdleTimeout, [this] {
+            return (m_request || m_stop);
+        });
+        if (!hasRequest || m_stop)
+        {
+            if (m_request)
+            {
+                m_request->done = true;
+                m_request = nullptr;
+                m_cond.notify_all();
+            }
+            m_running = false;
+            break;
+        }
+
+        Request *request = m_request;
+        locker.unlock();
+        const bool ok = processRequest(process, *request);
+        locker.lock();
+
+        request->ok = ok;
+        request->done = true;
+        m_request = nullptr;
+        m_cond.notify_all();
+    }
+    locker.unlock();
+
+    if (process.state() != QProcess::NotRunning)
+    {
+        process.closeWriteChannel();
+        if (!process.waitForFinished(1000))
+        {
+            process.kill();
+            process.waitForFinished();
+        }
+    }
+}
+
+bool YouTubeDLWorker::processRequest(QProcess &process, Request &request)
+{
+    const QDateTime lastModified = QFileInfo(request.ytDlPath).lastModified();
+    if (process.state() != QProcess::Running || request.ytDlPath != m_ytDlPath || lastModified != m_ytDlLastModified)
+    {
+        if (!startWorkerProcess(process, request.ytDlPath))
+        {
+            qCritical() << "Can't start \"yt-dlp\" worker process";
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_failedYtDl = getYtDlKey(request.ytDlPath);
+            return false;
+        }
+        m_ytDlPath = request.ytDlPath;
+        m_ytDlLastModified = lastModified;
+    }
+
+    const QJsonObject requestObj {
+        {"args", QJsonArray::fromStringList(request.args)},
+    };
+    process.write(QJsonDocument(requestObj).toJson(QJsonDocument::Compact) + "\n");
+
+    QByteArray response;
+    while (!response.endsWith('\n'))
+    {
+        if (request.aborted)
+        {
+            process.kill();
+            process.waitForFinished();
+            return false;
+        }
+        if (process.waitForReadyRead(100))
+        {
+            response += process.readAllStandardOutput();
+        }
+        else if (process.state() != QProcess::Running)
+        {
+            qCritical() << "\"yt-dlp\" worker process has been terminated:" << process.readAllStandardError();
+            if (!m_hasResponse)
+            {
+                // Probably "yt_dlp" module can't be imported, don't try again until "yt-dlp" is updated
+                std::lock_guard<std::mutex> locker(m_mutex);
+                m_failedYtDl = getYtDlKey(request.ytDlPath);
+            }
+            return false;
+        }
+    }
+    m_hasResponse = true;
+
+    const QJsonObject responseObj = QJsonDocument::fromJson(response).object();
+    if (responseObj.isEmpty())
+        return false;
+
+    request.exitCode = responseObj["code"].toInt(-1);
+    request.stdOut = responseObj["stdout"].toString();
+    request.stdErr = responseObj["stderr"].toString();
+    return true;
+}
+bool YouTubeDLWorker::startWorkerProcess(QProcess &process, const QString &ytDlPath)
+{
+    if (process.state() != QProcess::NotRunning)
+    {
+        process.kill();
+        process.waitForFinished();
+    }
+
+    const QString pythonCmd = getPythonCommand(ytDlPath);
+    if (pythonCmd.isEmpty())
+        return false;
+
+    const QString scriptPath = QMPlay2Core.getSettingsDir() + "yt-dlp-worker.py";
+    QFile scriptFile(scriptPath);
+    if (!scriptFile.open(QFile::ReadOnly) || scriptFile.readAll() != g_workerScript)
+    {
+        scriptFile.close();
+        if (!scriptFile.open(QFile::WriteOnly | QFile::Truncate) || scriptFile.write(g_workerScript) != g_workerScript.size())
+            return false;
+    }
+    scriptFile.close();
+
+    m_hasResponse = false;
+    process.start(pythonCmd, {scriptPath, ytDlPath});
+    return process.waitForStarted();
+}
+
+/**/
+
 static inline QString getYtDlpFileName()
 {
     return "yt-dlp"
@@ -195,6 +585,10 @@ void YouTubeDL::addr(const QString &url, const QString &param, QString *streamUr
 
 QStringList YouTubeDL::exec(const QString &url, const QStringList &args, QString *silentErr, bool rawOutput)
 {
+    const QString cacheKey = QStringList({url, args.join('\n'), m_commonArgs.join('\n'), rawOutput ? "raw" : QString()}).join('\n');
+    if (QStringList cachedResult; findResolved(cacheKey, cachedResult))
+        return cachedResult;
+
     if (!prepare())
         return {};
 
@@ -207,28 +601,22 @@ QStringList YouTubeDL::exec(const QString &url, const QStringList &args, QString
     if (!rawOutput)
         processArgs += "-j";
 
-    startProcess(processArgs);
-    if (!m_process.waitForStarted() && !m_aborted)
-    {
-        if (!onProcessCantStart())
-            return {};
-        startProcess(processArgs);
-    }
-
-    if (!m_process.waitForFinished(-1) || m_aborted)
+    int exitCode = -1;
+    QString stdOut, stdErr;
+    if (!execProcess(processArgs, exitCode, stdOut, stdErr) || m_aborted)
         return {};
 
     QStringList result;
 
-    bool isOk = (m_process.exitCode() == 0);
+    bool isOk = (exitCode == 0);
     QString error;
 
     if (isOk)
     {
-        result = QStringList(QString::fromLocal8Bit(m_process.readAllStandardOutput()));
+        result = QStringList(stdOut);
         if (rawOutput)
         {
-            result += m_process.readAllStandardError();
+            result += stdErr;
         }
         else
         {
@@ -259,10 +647,9 @@ QStringList YouTubeDL::exec(const QString &url, const QStringList &args, QString
     if (!isOk)
     {
         result.clear();
-        const QString newError = m_process.readAllStandardError();
         if (error.isEmpty())
         {
-            error = newError;
+            error = stdErr;
             if (error.indexOf("ERROR: ") == 0)
                 error.remove(0, 7);
         }
@@ -276,6 +663,9 @@ QStringList YouTubeDL::exec(const QString &url, const QStringList &args, QString
         return {};
     }
 
+    ResolvedEntry resolvedEntry;
+    resolvedEntry.expires = getResolvedExpiry(result);
+
     if (!rawOutput)
     {
         // [Title], url, JSON, [url, JSON]
@@ -294,6 +684,7 @@ QStringList YouTubeDL::exec(const QString &url, const QStringList &args, QString
                         if (cookies.isEmpty())
                             cookies = formats["cookies"].toString();
                         QMPlay2Core.addCookies(url, cookies.toUtf8());
+                        resolvedEntry.cookies.append({url, cookies.toUtf8()});
                     }
                 }
 
@@ -302,6 +693,9 @@ QStringList YouTubeDL::exec(const QString &url, const QStringList &args, QString
         }
     }
 
+    resolvedEntry.result = result;
+    insertResolved(cacheKey, std::move(resolvedEntry));
+
     return result;
 }
 
@@ -495,31 +889,39 @@ void YouTubeDL::startProcess(QStringList args)
 {
     QString program = m_ytDlPath;
 
-#ifndef Q_OS_WIN
-    QFile ytDlFile(program);
-    if (ytDlFile.open(QFile::ReadOnly))
+    const QString pythonCmd = getPythonCommand(program);
+    if (!pythonCmd.isEmpty())
     {
-        const auto shebang = ytDlFile.readLine(99).trimmed();
-        const int idx = shebang.lastIndexOf("python");
-        if (shebang.startsWith("#!") && idx > -1)
-        {
-            const auto pythonCmd = shebang.mid(idx);
-            if (QStandardPaths::findExecutable(pythonCmd).endsWith(pythonCmd))
-            {
-                args.prepend(program);
-                program = pythonCmd;
-            }
-#ifdef Q_OS_MACOS
-            else if (QFileInfo(QString("/usr/local/bin/" + pythonCmd)).isExecutable())
-            {
-                args.prepend(program);
-                program = "/usr/local/bin/" + pythonCmd;
-            }
-#endif
-        }
-        ytDlFile.close();
+        args.prepend(program);
+        program = pythonCmd;
     }
-#endif
 
     m_process.start(program, args);
 }
+
+bool YouTubeDL::execProcess(const QStringList &args, int &exitCode, QString &stdOut, QString &stdErr)
+{
+    if (QMPlay2Core.getSettings().getBool("YtDl/PersistentWorker") && !getPythonCommand(m_ytDlPath).isEmpty())
+    {
+        if (YouTubeDLWorker::instance()->exec(m_ytDlPath, args, m_aborted, exitCode, stdOut, stdErr))
+            return true;
+        if (m_aborted)
+            return false;
+    }
+
+    startProcess(args);
+    if (!m_process.waitForStarted() && !m_aborted)
+    {
+        if (!onProcessCantStart())
+            return false;
+        startProcess(args);
+    }
+
+    if (!m_process.waitForFinished(-1) || m_aborted)
+        return false;
+
+    exitCode = m_process.exitCode();
+    stdOut = QString::fromLocal8Bit(m_process.readAllStandardOutput());
+    stdErr = QString::fromUtf8(m_process.readAllStandardError());
+    return true;
+}
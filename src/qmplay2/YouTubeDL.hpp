@@ -59,6 +59,8 @@ private:
 
     void startProcess(QStringList args);
 
+    bool execProcess(const QStringList &args, int &exitCode, QString &stdOut, QString &stdErr);
+
 private:
     const QString m_ytDlPath;
     const QStringList m_commonArgs;
@@ -0,0 +1,281 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../../qmvk/Device.hpp"
+#include "../../qmvk/Queue.hpp"
+#include "../../qmvk/ComputePipeline.hpp"
+#include "../../qmvk/CommandBuffer.hpp"
+#include "../../qmvk/ShaderModule.hpp"
+#include "../../qmvk/Sampler.hpp"
+#include "../../qmvk/Image.hpp"
+
+#include "VulkanComputeFilter.hpp"
+#include "VulkanInstance.hpp"
+#include "VulkanImagePool.hpp"
+#include "VulkanHWInterop.hpp"
+
+namespace QmVk {
+
+ComputeFilter::ComputeFilter(const shared_ptr<HWInterop> &hwInterop, const char *shaderName, uint32_t pushConstantsSize, uint32_t specOption)
+    : VideoFilter(true)
+    , m_instance(m_vkImagePool->instance())
+    , m_shaderName(shaderName)
+    , m_pushConstantsSize(pushConstantsSize)
+    , m_specOption(specOption)
+{
+    m_supportedPixelFormats += {
+            AV_PIX_FMT_NV12,
+            AV_PIX_FMT_P010,
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(58, 2, 100)
+            AV_PIX_FMT_P012,
+#endif
+            AV_PIX_FMT_P016,
+            AV_PIX_FMT_NV16,
+            AV_PIX_FMT_NV20,
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(56, 31, 100)
+            AV_PIX_FMT_NV24,
+#endif
+    };
+    if (m_instance->hasStorage16bit() && m_instance->supportedPixelFormats().contains(AV_PIX_FMT_YUV420P10))
+    {
+        m_supportedPixelFormats += {
+            AV_PIX_FMT_YUV420P9,
+            AV_PIX_FMT_YUV420P10,
+            AV_PIX_FMT_YUV420P12,
+            AV_PIX_FMT_YUV420P14,
+            AV_PIX_FMT_YUV420P16,
+
+            AV_PIX_FMT_YUV422P9,
+            AV_PIX_FMT_YUV422P10,
+            AV_PIX_FMT_YUV422P12,
+            AV_PIX_FMT_YUV422P14,
+            AV_PIX_FMT_YUV422P16,
+
+            AV_PIX_FMT_YUV444P9,
+            AV_PIX_FMT_YUV444P10,
+            AV_PIX_FMT_YUV444P12,
+            AV_PIX_FMT_YUV444P14,
+            AV_PIX_FMT_YUV444P16,
+        };
+    }
+
+    m_vkHwInterop = hwInterop;
+}
+ComputeFilter::~ComputeFilter()
+{
+}
+
+bool ComputeFilter::process(
+    const vector<Frame *> &srcFrames,
+    const Frame &refFrame,
+    int nOutputs,
+    const PushConstantsFn &pushConstantsFn,
+    const OutputFn &outputFn)
+{
+    Q_ASSERT(srcFrames.size() >= 1 && srcFrames.size() <= 3);
+    Q_ASSERT(nOutputs >= 1);
+
+    if (m_error || !ensureResources(nOutputs))
+    {
+        clearBuffer();
+        return false;
+    }
+
+    try
+    {
+        const size_t nSrcFrames = srcFrames.size();
+
+        vector<CopyImageLinearToOptimalFn> copyFns(nSrcFrames);
+        vector<shared_ptr<Image>> srcImages(nSrcFrames);
+
+        for (size_t i = 0; i < nSrcFrames; ++i)
+        {
+            srcImages[i] = vulkanImageFromFrame(*srcFrames[i], m.device, &copyFns[i]);
+            if (!srcImages[i])
+            {
+                clearBuffer();
+                return false;
+            }
+        }
+
+        vector<Frame> syncFrames;
+        if (m_vkHwInterop)
+        {
+            for (auto &&srcFrame : srcFrames)
+                syncFrames.push_back(*srcFrame);
+        }
+
+        vk::SubmitInfo submitInfo;
+        HWInterop::SyncDataPtr syncData;
+
+        const uint32_t srcNumPlanes = srcImages[0]->numPlanes();
+
+        for (int o = 0; o < nOutputs; ++o)
+        {
+            auto destFrame = m_vkImagePool->takeOptimalToFrame(
+                refFrame,
+                Frame::convert2PlaneTo3Plane(refFrame.pixelFormat())
+            );
+            if (destFrame.isEmpty())
+            {
+                clearBuffer();
+                return false;
+            }
+
+            auto destImage = vulkanImageFromFrame(destFrame);
+
+            if (o == 0)
+            {
+                if (m_vkHwInterop)
+                    syncData = m_vkHwInterop->sync(syncFrames, &submitInfo);
+
+                m.commandBuffer->resetAndBegin();
+                for (auto &&copyFn : copyFns)
+                {
+                    if (copyFn)
+                        copyFn(m.commandBuffer);
+                }
+            }
+
+            for (uint32_t p = 0; p < 3; ++p)
+            {
+                auto &compute = m.computes[p][o];
+
+                if (pushConstantsFn)
+                    pushConstantsFn(*compute, p, o, destImage->size(p));
+
+                compute->setCustomSpecializationData({
+                    m_specOption,
+                    srcNumPlanes,
+                    (srcNumPlanes == 3) ? p  : ((p != 0) ? 1u : 0u),
+                    (srcNumPlanes == 3) ? 0u : ((p == 2) ? 1u : 0u),
+                    p
+                });
+                switch (nSrcFrames)
+                {
+                    case 1:
+                        compute->setMemoryObjects({
+                            {srcImages[0], m.sampler},
+                            {destImage, MemoryObjectDescr::Access::Write},
+                        });
+                        break;
+                    case 2:
+                        compute->setMemoryObjects({
+                            {srcImages[0], m.sampler},
+                            {srcImages[1], m.sampler},
+                            {destImage, MemoryObjectDescr::Access::Write},
+                        });
+                        break;
+                    default:
+                        compute->setMemoryObjects({
+                            {srcImages[0], m.sampler},
+                            {srcImages[1], m.sampler},
+                            {srcImages[2], m.sampler},
+                            {destImage, MemoryObjectDescr::Access::Write},
+                        });
+                        break;
+                }
+                compute->prepare();
+
+                compute->recordCommands(
+                    m.commandBuffer,
+                    compute->groupCount(destImage->size(p))
+                );
+            }
+
+            if (o == nOutputs - 1)
+            {
+                if (m_vkHwInterop)
+                    m_vkHwInterop->updateInfo(syncFrames);
+                m.commandBuffer->endSubmitAndWait(move(submitInfo));
+            }
+
+            outputFn(destFrame, o);
+        }
+    }
+    catch (const vk::SystemError &e)
+    {
+        handleError(e);
+        clearBuffer();
+        return false;
+    }
+
+    return true;
+}
+
+bool ComputeFilter::ensureResources(int nOutputs)
+{
+    auto device = m_instance->device();
+    if (device && m.device == device && m.computes[0].size() >= static_cast<size_t>(nOutputs))
+        return true;
+
+    if (m.device)
+        m = {};
+
+    m.device = move(device);
+    if (!m.device)
+        return false;
+
+    try
+    {
+        m.sampler = Sampler::create(m.device);
+
+        auto shaderModule = ShaderModule::create(
+            m.device,
+            vk::ShaderStageFlagBits::eCompute,
+            Instance::readShader(m_shaderName)
+        );
+
+        for (auto &&computesP : m.computes)
+        {
+            computesP.resize(nOutputs);
+            for (auto &&compute : computesP)
+            {
+                compute = ComputePipeline::create(
+                    m.device,
+                    shaderModule,
+                    m_pushConstantsSize
+                );
+
+                compute->setLocalWorkgroupSize(vk::Extent2D(64, 1));
+            }
+        }
+
+        m.commandBuffer = CommandBuffer::create(getVulkanComputeQueue(m.device));
+        if (m.commandBuffer->queue()->queueFamilyIndex() != m.device->queueFamilyIndex(0))
+            m.filtersOnOtherQueueFamiliy = m_instance->setFiltersOnOtherQueueFamiliy();
+    }
+    catch (const vk::SystemError &e)
+    {
+        handleError(e);
+        return false;
+    }
+
+    return true;
+}
+
+void ComputeFilter::handleError(const vk::SystemError &e)
+{
+    if (e.code() == vk::Result::eErrorDeviceLost)
+        m_instance->resetDevice(m.device);
+    else
+        m_error = true;
+    m = {};
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+    QMPlay2 is a video and audio player.
+    Copyright (C) 2010-2025  Błażej Szczygieł
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QMPlay2Lib.hpp>
+
+#include <VideoFilter.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+namespace QmVk {
+
+using namespace std;
+
+class Instance;
+class Sampler;
+class ComputePipeline;
+
+/* Base for video filters running a compute shader on every plane of the frame */
+
+class QMPLAY2SHAREDLIB_EXPORT ComputeFilter : public VideoFilter
+{
+protected:
+    using PushConstantsFn = function<void(ComputePipeline &compute, uint32_t plane, int output, const vk::Extent2D &size)>;
+    using OutputFn = function<void(Frame &destFrame, int output)>;
+
+    ComputeFilter(const shared_ptr<HWInterop> &hwInterop, const char *shaderName, uint32_t pushConstantsSize, uint32_t specOption = 0);
+    ~ComputeFilter();
+
+    // Runs the shader for each output frame, the output frame has the size and the format of "refFrame"
+    bool process(
+        const vector<Frame *> &srcFrames,
+        const Frame &refFrame,
+        int nOutputs,
+        const PushConstantsFn &pushConstantsFn,
+        const OutputFn &outputFn
+    );
+
+private:
+    bool ensureResources(int nOutputs);
+    void handleError(const vk::SystemError &e);
+
+protected:
+    const shared_ptr<Instance> m_instance;
+
+private:
+    const char *const m_shaderName;
+    const uint32_t m_pushConstantsSize;
+    const uint32_t m_specOption;
+
+    bool m_error = false;
+
+    struct
+    {
+        shared_ptr<Device> device;
+        shared_ptr<Sampler> sampler;
+        vector<shared_ptr<ComputePipeline>> computes[3];
+        shared_ptr<CommandBuffer> commandBuffer;
+        shared_ptr<function<void()>> filtersOnOtherQueueFamiliy;
+    } m;
+};
+
+}
@@ -18,19 +18,11 @@
 
 #pragma once
 
-#include <QMPlay2Lib.hpp>
-
-#include <VideoFilter.hpp>
+#include "VulkanComputeFilter.hpp"
 
 namespace QmVk {
 
-using namespace std;
-
-class Instance;
-class Sampler;
-class ComputePipeline;
-
-class QMPLAY2SHAREDLIB_EXPORT YadifDeint : public VideoFilter
+class QMPLAY2SHAREDLIB_EXPORT YadifDeint final : public ComputeFilter
 {
 public:
     YadifDeint(const shared_ptr<HWInterop> &hwInterop);
@@ -39,25 +31,6 @@ public:
     bool filter(QQueue<Frame> &framesQueue) override;
 
     bool processParams(bool *paramsCorrected) override;
-
-private:
-    bool ensureResources();
-
-private:
-    const bool m_spatialCheck;
-
-    bool m_error = false;
-
-    const shared_ptr<Instance> m_instance;
-
-    struct
-    {
-        shared_ptr<Device> device;
-        shared_ptr<Sampler> sampler;
-        shared_ptr<ComputePipeline> computes[3][2];
-        shared_ptr<CommandBuffer> commandBuffer;
-        shared_ptr<function<void()>> filtersOnOtherQueueFamiliy;
-    } m;
 };
 
 }